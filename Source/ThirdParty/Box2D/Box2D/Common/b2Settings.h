@@ -90,6 +90,13 @@ typedef double float64;
 /// Maximum number of contacts to be handled to solve a TOI impact.
 #define b2_maxTOIContacts			32
 
+/// Maximum number of tasks the islands of a step are distributed over when a task
+/// executor is set on the world.
+#define b2_maxIslandTasks			32
+
+/// Minimum number of bodies, contacts and joints solved by one island task.
+#define b2_minIslandTaskSize		128
+
 /// A velocity threshold for elastic collisions. Any collision with a relative linear
 /// velocity below this threshold will be treated as inelastic.
 #define b2_velocityThreshold		1.0f
@@ -36,7 +36,7 @@ class BOX2D_API b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactListener* listener, int32 staticCapacity = 0);
 	~b2Island();
 
 	void Clear()
@@ -58,6 +58,20 @@ public:
 		++m_bodyCount;
 	}
 
+	// Add a static body whose island index was assigned to one of the static slots
+	// in front of the position and velocity arrays. The body is not modified, so
+	// islands solved concurrently may share it.
+	void AddStatic(b2Body* body)
+	{
+		int32 index = body->m_islandIndex;
+		b2Assert(body->m_type == b2_staticBody);
+		b2Assert(-m_staticCapacity <= index && index < 0);
+		m_positions[index].c = body->m_sweep.c;
+		m_positions[index].a = body->m_sweep.a;
+		m_velocities[index].v.SetZero();
+		m_velocities[index].w = 0.0f;
+	}
+
 	void Add(b2Contact* contact)
 	{
 		b2Assert(m_contactCount < m_contactCapacity);
@@ -89,6 +103,7 @@ public:
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+	int32 m_staticCapacity;
 };
 
 #endif
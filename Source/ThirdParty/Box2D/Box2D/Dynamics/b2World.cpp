@@ -38,6 +38,8 @@ b2World::b2World(const b2Vec2& gravity)
 {
 	m_destructionListener = nullptr;
 	m_debugDraw = nullptr;
+	m_taskExecutor = nullptr;
+	memset(m_taskAllocators, 0, sizeof(m_taskAllocators));
 
 	m_bodyList = nullptr;
 	m_jointList = nullptr;
@@ -82,6 +84,15 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	for (int32 i = 0; i < b2_maxIslandTasks; ++i)
+	{
+		if (m_taskAllocators[i])
+		{
+			m_taskAllocators[i]->~b2StackAllocator();
+			b2Free(m_taskAllocators[i]);
+		}
+	}
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -104,6 +115,11 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	m_debugDraw = debugDraw;
 }
 
+void b2World::SetTaskExecutor(b2TaskExecutor* executor)
+{
+	m_taskExecutor = executor;
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -382,6 +398,202 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+// A range of an island recorded for parallel solving.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+};
+
+// Shared state of the island tasks of one step.
+struct b2IslandTaskContext
+{
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	b2ContactListener* listener;
+	int32 staticCount;
+
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	const b2IslandRange* islands;
+
+	// Task i solves islands taskStarts[i] to taskStarts[i + 1] - 1.
+	const int32* taskStarts;
+
+	b2StackAllocator** allocators;
+	b2Profile* profiles;
+};
+
+static void b2SolveIslandTask(void* context, int32 index)
+{
+	b2IslandTaskContext* ctx = (b2IslandTaskContext*)context;
+	b2Profile* total = ctx->profiles + index;
+	total->solveInit = 0.0f;
+	total->solveVelocity = 0.0f;
+	total->solvePosition = 0.0f;
+
+	// Size one island for the largest island of the task and reuse it, so that the static
+	// slots are allocated once per task instead of once per island.
+	int32 bodyCapacity = 0;
+	int32 contactCapacity = 0;
+	int32 jointCapacity = 0;
+	for (int32 i = ctx->taskStarts[index]; i < ctx->taskStarts[index + 1]; ++i)
+	{
+		bodyCapacity = b2Max(bodyCapacity, ctx->islands[i].bodyCount);
+		contactCapacity = b2Max(contactCapacity, ctx->islands[i].contactCount);
+		jointCapacity = b2Max(jointCapacity, ctx->islands[i].jointCount);
+	}
+
+	b2Island island(bodyCapacity, contactCapacity, jointCapacity, ctx->allocators[index], ctx->listener,
+		ctx->staticCount);
+
+	for (int32 i = ctx->taskStarts[index]; i < ctx->taskStarts[index + 1]; ++i)
+	{
+		const b2IslandRange& range = ctx->islands[i];
+		island.Clear();
+
+		for (int32 j = 0; j < range.bodyCount; ++j)
+		{
+			b2Body* b = ctx->bodies[range.bodyStart + j];
+			if (b->GetType() == b2_staticBody)
+			{
+				island.AddStatic(b);
+			}
+			else
+			{
+				island.Add(b);
+			}
+		}
+		for (int32 j = 0; j < range.contactCount; ++j)
+		{
+			island.Add(ctx->contacts[range.contactStart + j]);
+		}
+		for (int32 j = 0; j < range.jointCount; ++j)
+		{
+			island.Add(ctx->joints[range.jointStart + j]);
+		}
+
+		b2Profile profile;
+		island.Solve(&profile, *ctx->step, ctx->gravity, ctx->allowSleep);
+		total->solveInit += profile.solveInit;
+		total->solveVelocity += profile.solveVelocity;
+		total->solvePosition += profile.solvePosition;
+	}
+}
+
+// Solve the recorded islands with the task executor. Dynamic and kinematic bodies belong
+// to exactly one island, but a static body may be shared by many. Every static body gets
+// a unique negative island index up front, so islands can read it concurrently without
+// writing to it. The slots of all static bodies are allocated once per task, and each
+// island only fills the slots of the static bodies it touches.
+void b2World::SolveParallel(const b2TimeStep& step, b2Body** bodies, b2Contact** contacts, b2Joint** joints,
+	b2IslandRange* islands, int32 islandCount)
+{
+	if (islandCount == 0)
+	{
+		return;
+	}
+
+	const int32 bodyCount = islands[islandCount - 1].bodyStart + islands[islandCount - 1].bodyCount;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		if (bodies[i]->GetType() == b2_staticBody)
+		{
+			bodies[i]->m_islandIndex = 0;
+		}
+	}
+
+	int32 staticCount = 0;
+	int32 totalSize = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		if (b->GetType() == b2_staticBody && b->m_islandIndex == 0)
+		{
+			b->m_islandIndex = -(++staticCount);
+		}
+	}
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		totalSize += islands[i].bodyCount + islands[i].contactCount + islands[i].jointCount;
+	}
+
+	// Split the islands into tasks of roughly equal size.
+	int32 taskStarts[b2_maxIslandTasks + 1];
+	const int32 taskCount = b2Clamp(totalSize / b2_minIslandTaskSize, 1, b2_maxIslandTasks);
+	const int32 taskSize = (totalSize + taskCount - 1) / taskCount;
+
+	taskStarts[0] = 0;
+	int32 numTasks = 0;
+	int32 currentSize = 0;
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		if (currentSize >= taskSize && numTasks + 1 < taskCount)
+		{
+			taskStarts[++numTasks] = i;
+			currentSize = 0;
+		}
+		currentSize += islands[i].bodyCount + islands[i].contactCount + islands[i].jointCount;
+	}
+	taskStarts[++numTasks] = islandCount;
+
+	b2StackAllocator* allocators[b2_maxIslandTasks];
+	if (numTasks == 1)
+	{
+		allocators[0] = &m_stackAllocator;
+	}
+	else
+	{
+		for (int32 i = 0; i < numTasks; ++i)
+		{
+			if (m_taskAllocators[i] == nullptr)
+			{
+				void* mem = b2Alloc(sizeof(b2StackAllocator));
+				m_taskAllocators[i] = new (mem) b2StackAllocator;
+			}
+			allocators[i] = m_taskAllocators[i];
+		}
+	}
+
+	b2Profile profiles[b2_maxIslandTasks];
+
+	b2IslandTaskContext context;
+	context.step = &step;
+	context.gravity = m_gravity;
+	context.allowSleep = m_allowSleep;
+	context.listener = m_contactManager.m_contactListener;
+	context.staticCount = staticCount;
+	context.bodies = bodies;
+	context.contacts = contacts;
+	context.joints = joints;
+	context.islands = islands;
+	context.taskStarts = taskStarts;
+	context.allocators = allocators;
+	context.profiles = profiles;
+
+	if (numTasks == 1)
+	{
+		b2SolveIslandTask(&context, 0);
+	}
+	else
+	{
+		m_taskExecutor->ExecuteTasks(b2SolveIslandTask, &context, numTasks);
+	}
+
+	for (int32 i = 0; i < numTasks; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+	}
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -413,6 +625,27 @@ void b2World::Solve(const b2TimeStep& step)
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+
+	// When solving in parallel, gather the islands first. A static body is repeated in
+	// every island it touches, so the body storage is bounded by the constraint count.
+	const bool parallel = m_taskExecutor != nullptr;
+	b2Body** islandBodies = nullptr;
+	b2Contact** islandContacts = nullptr;
+	b2Joint** islandJoints = nullptr;
+	b2IslandRange* islands = nullptr;
+	int32 islandCount = 0;
+	int32 islandBodyCount = 0;
+	int32 islandContactCount = 0;
+	int32 islandJointCount = 0;
+	if (parallel)
+	{
+		const int32 contactCount = m_contactManager.m_contactCount;
+		islandBodies = (b2Body**)m_stackAllocator.Allocate((m_bodyCount + contactCount + m_jointCount) * sizeof(b2Body*));
+		islandContacts = (b2Contact**)m_stackAllocator.Allocate(contactCount * sizeof(b2Contact*));
+		islandJoints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+		islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	}
+
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
 		if (seed->m_flags & b2Body::e_islandFlag)
@@ -527,11 +760,31 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+		if (parallel)
+		{
+			// Record the island, all islands are solved at once after they have been found.
+			b2IslandRange* range = islands + islandCount++;
+			range->bodyStart = islandBodyCount;
+			range->bodyCount = island.m_bodyCount;
+			range->contactStart = islandContactCount;
+			range->contactCount = island.m_contactCount;
+			range->jointStart = islandJointCount;
+			range->jointCount = island.m_jointCount;
+			memcpy(islandBodies + islandBodyCount, island.m_bodies, island.m_bodyCount * sizeof(b2Body*));
+			memcpy(islandContacts + islandContactCount, island.m_contacts, island.m_contactCount * sizeof(b2Contact*));
+			memcpy(islandJoints + islandJointCount, island.m_joints, island.m_jointCount * sizeof(b2Joint*));
+			islandBodyCount += island.m_bodyCount;
+			islandContactCount += island.m_contactCount;
+			islandJointCount += island.m_jointCount;
+		}
+		else
+		{
+			b2Profile profile;
+			island.Solve(&profile, step, m_gravity, m_allowSleep);
+			m_profile.solveInit += profile.solveInit;
+			m_profile.solveVelocity += profile.solveVelocity;
+			m_profile.solvePosition += profile.solvePosition;
+		}
 
 		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -545,6 +798,16 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
+	if (parallel)
+	{
+		SolveParallel(step, islandBodies, islandContacts, islandJoints, islands, islandCount);
+
+		m_stackAllocator.Free(islands);
+		m_stackAllocator.Free(islandJoints);
+		m_stackAllocator.Free(islandContacts);
+		m_stackAllocator.Free(islandBodies);
+	}
+
 	m_stackAllocator.Free(stack);
 
 	{
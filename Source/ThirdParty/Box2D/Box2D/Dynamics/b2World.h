@@ -30,6 +30,7 @@
 struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
+struct b2IslandRange;
 struct b2JointDef;
 class b2Body;
 class b2Draw;
@@ -67,6 +68,13 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2Draw* debugDraw);
 
+	/// Register a task executor used to solve independent islands in parallel.
+	/// Collision detection and continuous collision stay on the calling thread.
+	/// Pass nullptr to solve all islands on the calling thread. The executor is
+	/// owned by you and must remain in scope.
+	/// @warning b2ContactListener::PostSolve may be called from several threads at once.
+	void SetTaskExecutor(b2TaskExecutor* executor);
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
@@ -226,6 +234,8 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveParallel(const b2TimeStep& step, b2Body** bodies, b2Contact** contacts, b2Joint** joints,
+		b2IslandRange* islands, int32 islandCount);
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawJoint(b2Joint* joint);
@@ -249,6 +259,10 @@ private:
 
 	b2DestructionListener* m_destructionListener;
 	b2Draw* m_debugDraw;
+	b2TaskExecutor* m_taskExecutor;
+
+	// Per task stack allocators used by parallel island solving, created on demand.
+	b2StackAllocator* m_taskAllocators[b2_maxIslandTasks];
 
 	// This is used to compute the time step ratio to
 	// support a variable time step.
@@ -153,4 +153,18 @@ public:
 									const b2Vec2& normal, float32 fraction) = 0;
 };
 
+/// Implement this class to solve independent islands in parallel.
+/// See b2World::SetTaskExecutor
+class BOX2D_API b2TaskExecutor
+{
+public:
+	typedef void (*TaskFunction)(void* context, int32 index);
+
+	virtual ~b2TaskExecutor() {}
+
+	/// Call task(context, index) for every index in [0, count) and return once all
+	/// calls have completed. The calls may run concurrently on any thread.
+	virtual void ExecuteTasks(TaskFunction task, void* context, int32 count) = 0;
+};
+
 #endif
@@ -204,10 +204,51 @@ struct dtCrowdAgentDebugInfo
 /// Type for the update callback.
 typedef void (*dtUpdateCallback)(bool positionUpdate, dtCrowdAgent* agent, float* pos, float dt);
 
+// Urho3D: Add parallel update support
+/// A task processing a range of agents during the crowd update.
+struct dtCrowdTask
+{
+	virtual ~dtCrowdTask() {}
+
+	/// Processes the agents in the range [begin, end) using the query objects of the specified thread.
+	virtual void run(const int begin, const int end, const int threadIndex) = 0;
+};
+
+/// Runs crowd update tasks in parallel.
+class dtCrowdTaskScheduler
+{
+public:
+	virtual ~dtCrowdTaskScheduler() {}
+
+	/// Returns the number of threads that may run tasks concurrently, including the calling thread.
+	/// Thread indices passed to the tasks are in the range [0, getNumThreads()).
+	virtual int getNumThreads() = 0;
+
+	/// Splits [0, count) into ranges, runs the task for each of them and returns once all are processed.
+	virtual void parallelFor(const int count, dtCrowdTask* task) = 0;
+};
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
 {
+	// Urho3D: Add parallel update support
+	friend struct dtCrowdPhaseTask;
+
+	/// Parts of the agent update that are independent between the agents.
+	enum UpdatePhase
+	{
+		DT_CROWD_PHASE_NEIGHBOURS,
+		DT_CROWD_PHASE_CORNERS,
+		DT_CROWD_PHASE_STEERING,
+		DT_CROWD_PHASE_SEPARATION,
+		DT_CROWD_PHASE_PLANNING,
+		DT_CROWD_PHASE_INTEGRATE,
+		DT_CROWD_PHASE_COLLISION,
+		DT_CROWD_PHASE_DISPLACE,
+		DT_CROWD_PHASE_MOVE
+	};
+
     dtUpdateCallback m_updateCallback; // Urho3D
 	int m_maxAgents;
 	dtCrowdAgent* m_agents;
@@ -234,6 +275,21 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
+	// Urho3D: Add parallel update support
+	dtCrowdTaskScheduler* m_taskScheduler;
+	int m_numThreads;
+	dtNavMeshQuery** m_threadNavQueries;
+	dtObstacleAvoidanceQuery** m_threadObstacleQueries;
+	int* m_threadVelocitySampleCounts;
+	int m_updateAgentCount;
+	float m_updateDt;
+	dtCrowdAgentDebugInfo* m_updateDebug;
+
+	bool allocThreadQueries(const int numThreads);
+	void freeThreadQueries();
+	void runUpdatePhase(const UpdatePhase phase);
+	void updateAgents(const UpdatePhase phase, const int begin, const int end, const int threadIndex);
+
 	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
 	void updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
@@ -282,6 +338,17 @@ public:
 	/// @return The maximum number of agents.
 	int getAgentCount() const;
 
+	// Urho3D: Add parallel update support
+	/// Sets the scheduler used to run the independent parts of the agent update in parallel.
+	/// Each thread uses a navigation mesh query and an obstacle avoidance query of its own.
+	/// The results do not depend on the number of threads.
+	///  @param[in]		scheduler	The task scheduler, or null to update the agents serially.
+	void setTaskScheduler(dtCrowdTaskScheduler* scheduler) { m_taskScheduler = scheduler; }
+
+	/// Gets the scheduler used to update the agents in parallel.
+	/// @return The task scheduler, or null if the agents are updated serially.
+	dtCrowdTaskScheduler* getTaskScheduler() const { return m_taskScheduler; }
+
 	// Urho3D: Add missing getter
 	/// The maximum radius of any agent that will be added to the crowd.
 	/// @return The maximum radius of any agent.
@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Audio/Audio.h>
+#include <Urho3D/Audio/Sound.h>
+#include <Urho3D/Audio/SoundListener.h>
+#include <Urho3D/Audio/SoundSource3D.h>
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <SDL/SDL_stdinc.h>
+
+using namespace Urho3D;
+
+/// Output mixing rate.
+static const int MIX_RATE = 44100;
+/// Length of the generated sounds, in samples.
+static const unsigned SOUND_LENGTH = 44100;
+/// Output mixed per simulated frame, in samples.
+static const unsigned FRAME_SAMPLES = MIX_RATE / 60;
+/// Radius of the area the sound sources are scattered in, in world units.
+static const float AREA_RADIUS = 100.0f;
+
+/// Headless audio mixing benchmark. Mixes a scene of looping 3D sound sources into memory, without and with a voice
+/// limit, and reports the mixing time per second of output. Uses the SDL disk audio driver writing to the null device
+/// unless another driver is chosen with SDL_AUDIODRIVER, so no sound hardware is needed.
+class AudioBenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(AudioBenchmarkApplication, Application);
+public:
+    explicit AudioBenchmarkApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_WORKER_THREADS] = false;
+        engineParameters_[EP_RESOURCE_PATHS] = "";
+        engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+
+        // The audio subsystem initializes SDL audio when the engine is initialized, so the driver must be chosen here
+        SDL_setenv("SDL_AUDIODRIVER", "disk", 0);
+#ifdef _WIN32
+        SDL_setenv("SDL_DISKAUDIOFILE", "NUL", 0);
+#else
+        SDL_setenv("SDL_DISKAUDIOFILE", "/dev/null", 0);
+#endif
+
+        auto& app = GetCommandLineParser();
+        app.add_option("--sources", numSources_, "Number of playing 3D sound sources.")->set_default_str("300");
+        app.add_option("--max-voices", maxVoices_, "Voice limit of the limited run.")->set_default_str("32");
+        app.add_option("--seconds", numSeconds_, "Length of mixed output in seconds.")->set_default_str("10");
+        app.add_flag("--no-interpolation", noInterpolation_, "Disable interpolation of resampled sounds.");
+    }
+
+    void Start() override
+    {
+        numSources_ = Max(numSources_, 1);
+        numSeconds_ = Max(numSeconds_, 1);
+
+        auto* audio = GetSubsystem<Audio>();
+        if (!audio->SetMode(100, MIX_RATE, true, !noInterpolation_))
+        {
+            PrintLine("Could not open an audio device, set SDL_AUDIODRIVER to an available driver", true);
+            SendEvent(E_EXITREQUESTED);
+            return;
+        }
+
+        CreateScene();
+
+        PrintLine(Format("{} sources, {} seconds of {} Hz {} output, interpolation {}", numSources_, numSeconds_,
+            audio->GetMixRate(), audio->IsStereo() ? "stereo" : "mono", noInterpolation_ ? "off" : "on"));
+        PrintLine("Voice limit     Mix ms/s  Realtime x   Voices  Virtual");
+
+        Mix(0);
+        Mix((unsigned)Max(maxVoices_, 1));
+
+        // Engine::Exit() does not end the main loop in headless mode
+        SendEvent(E_EXITREQUESTED);
+    }
+
+private:
+    /// Create a looping sine tone of the given frequency.
+    SharedPtr<Sound> CreateSound(float frequency, unsigned sampleRate)
+    {
+        ea::vector<short> data(SOUND_LENGTH);
+        for (unsigned i = 0; i < SOUND_LENGTH; ++i)
+            data[i] = (short)(sinf(i * frequency * M_PI * 2.0f / sampleRate) * 10000.0f);
+
+        auto sound = MakeShared<Sound>(context_);
+        sound->SetSize(SOUND_LENGTH * sizeof(short));
+        sound->SetData(data.data(), SOUND_LENGTH * sizeof(short));
+        sound->SetFormat(sampleRate, true, false);
+        sound->SetLooped(true);
+        return sound;
+    }
+
+    /// Create the scene: a listener in the middle and sound sources scattered around it. Half of the sounds are at a
+    /// lower rate than the output, so that they are resampled.
+    void CreateScene()
+    {
+        scene_ = MakeShared<Scene>(context_);
+
+        auto* listener = scene_->CreateComponent<SoundListener>();
+        GetSubsystem<Audio>()->SetListener(listener);
+
+        const SharedPtr<Sound> sounds[] = { CreateSound(440.0f, MIX_RATE), CreateSound(220.0f, MIX_RATE / 2) };
+
+        SetRandomSeed(1);
+        for (int i = 0; i < numSources_; ++i)
+        {
+            Node* sourceNode = scene_->CreateChild("Source");
+            sourceNode->SetPosition(Vector3(Random(-AREA_RADIUS, AREA_RADIUS), 0.0f, Random(-AREA_RADIUS, AREA_RADIUS)));
+            auto* source = sourceNode->CreateComponent<SoundSource3D>();
+            source->SetDistanceAttenuation(1.0f, AREA_RADIUS, 1.0f);
+            source->SetGain(Random(0.1f, 1.0f));
+            source->Play(sounds[i % 2]);
+        }
+    }
+
+    /// Mix the output in frame sized chunks with the given voice limit, updating 3D attenuation before each chunk.
+    /// Print the time spent mixing.
+    void Mix(unsigned maxVoices)
+    {
+        auto* audio = GetSubsystem<Audio>();
+        audio->SetMaxVoices(maxVoices);
+
+        ea::vector<int> output(FRAME_SAMPLES);
+        const unsigned numFrames = (unsigned)numSeconds_ * MIX_RATE / FRAME_SAMPLES;
+        long long mixTime = 0;
+        unsigned numVoices = 0;
+        unsigned numVirtualVoices = 0;
+
+        // Keep the audio device callback waiting, so that it does not mix concurrently
+        MutexLock lock(audio->GetMutex());
+
+        HiresTimer timer;
+        for (unsigned i = 0; i < numFrames; ++i)
+        {
+            audio->Update(1.0f / 60.0f);
+
+            timer.Reset();
+            audio->MixOutput(output.data(), FRAME_SAMPLES);
+            mixTime += timer.GetUSec(false);
+
+            numVoices += audio->GetNumVoices();
+            numVirtualVoices += audio->GetNumVirtualVoices();
+        }
+
+        const float msPerSecond = mixTime / 1000.0f / numSeconds_;
+        PrintLine(Format("{:<12}  {:10.2f}  {:10.1f}  {:7}  {:7}", maxVoices ? ea::to_string(maxVoices) : ea::string("none"),
+            msPerSecond, 1000.0f / Max(msPerSecond, M_EPSILON), numVoices / numFrames, numVirtualVoices / numFrames));
+    }
+
+    /// Number of sound sources.
+    int numSources_{300};
+    /// Voice limit of the limited run.
+    int maxVoices_{32};
+    /// Length of mixed output in seconds.
+    int numSeconds_{10};
+    /// Disable interpolation flag.
+    bool noInterpolation_{};
+
+    /// Scene with the sound sources.
+    SharedPtr<Scene> scene_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(AudioBenchmarkApplication);
@@ -50,6 +50,7 @@ const char* TextureImporter::compressorNames[] = {
     "CRNF",
     "RYG",
     "ATI",
+    "Builtin",
     nullptr
 };
 
@@ -141,6 +142,20 @@ bool TextureImporter::Execute(Urho3D::Asset* input, const ea::string& outputPath
     else
         context_->GetSubsystem<FileSystem>()->CreateDirsRecursive(outputDirectory);
 
+    if (GetAttribute("Compressor").GetInt() == (int)Compressor::Builtin)
+    {
+        CompressedFormat format = CF_NONE;
+        if (pixelFormatValue == (int)PixelFormat::DXT1)
+            format = CF_DXT1;
+        else if (pixelFormatValue == (int)PixelFormat::DXT3)
+            format = CF_DXT3;
+        else if (pixelFormatValue == (int)PixelFormat::DXT5)
+            format = CF_DXT5;
+
+        if (format != CF_NONE)
+            return ExecuteBuiltin(input, outputFile, format);
+    }
+
     ea::string output;
     StringVector arguments{
         "-fileformat", "dds", "-noprogress", "-nostats", "-quality", ea::to_string(GetAttribute("Quality").GetInt()),
@@ -183,8 +198,12 @@ bool TextureImporter::Execute(Urho3D::Asset* input, const ea::string& outputPath
     if (!GetAttribute("Adaptive Blocks").GetBool())
         arguments.push_back("-noAdaptiveBlocks");
 
+    // Formats the builtin encoder does not handle are compressed by crunch with its default compressor
+    int compressor = GetAttribute("Compressor").GetInt();
+    if (compressor == (int)Compressor::Builtin)
+        compressor = (int)Compressor::CRN;
     arguments.push_back("-compressor");
-    arguments.push_back(compressorNames[GetAttribute("Compressor").GetInt()]);
+    arguments.push_back(compressorNames[compressor]);
 
     arguments.push_back("-dxtQuality");
     arguments.push_back(ea::string(dxtQualityNames[GetAttribute("DXT Quality").GetInt()]).to_lower());
@@ -219,6 +238,70 @@ bool TextureImporter::Execute(Urho3D::Asset* input, const ea::string& outputPath
     return true;
 }
 
+bool TextureImporter::ExecuteBuiltin(Urho3D::Asset* input, const ea::string& outputFile, CompressedFormat format)
+{
+    auto image = MakeShared<Image>(context_);
+    if (!image->LoadFile(input->GetResourcePath()))
+    {
+        logger_.Error("Loading 'res://{}' failed.", input->GetName());
+        return false;
+    }
+
+    if (GetAttribute("Y-flip").GetBool())
+        image->FlipVertical();
+
+    CompressionQuality quality = COMPRESSION_NORMAL;
+    switch ((DxtQuality)GetAttribute("DXT Quality").GetInt())
+    {
+    case DxtQuality::Superfast:
+    case DxtQuality::Fast:
+        quality = COMPRESSION_FAST;
+        break;
+    case DxtQuality::Better:
+    case DxtQuality::Uber:
+        quality = COMPRESSION_HIGH;
+        break;
+    default:
+        break;
+    }
+
+    // Mips are box filtered either as is or in linear space through the sRGB curve, which approximates gamma 2.2
+    const float gamma = GetAttribute("Gamma").GetFloat();
+    if (!Equals(gamma, 1.0f) && !Equals(gamma, 2.2f))
+        logger_.Warning("Builtin compressor supports only gamma 1.0 and 2.2, 'res://{}' mips are filtered with gamma 2.2.", input->GetName());
+    if (!Equals(GetAttribute("Blur").GetFloat(), 0.9f))
+        logger_.Warning("Builtin compressor does not support blur, it is ignored for 'res://{}'.", input->GetName());
+    image->SetSRGB(!Equals(gamma, 1.0f));
+
+    unsigned numLevels = 1;
+    if (GetAttribute("Mip Mode").GetInt() != (int)MipMode::None)
+    {
+        const int maxMips = GetAttribute("Max Mips").GetInt();
+        const int minMipSize = GetAttribute("Min Mip Size").GetInt();
+        int width = image->GetWidth();
+        int height = image->GetHeight();
+        while ((int)numLevels < maxMips && (width > 1 || height > 1))
+        {
+            width = Max(width / 2, 1);
+            height = Max(height / 2, 1);
+            if (Max(width, height) < minMipSize)
+                break;
+            ++numLevels;
+        }
+    }
+
+    SharedPtr<Image> compressedImage = image->GetCompressedImage(format, quality, numLevels);
+    if (!compressedImage || !compressedImage->SaveDDS(outputFile))
+    {
+        logger_.Error("Error {}-compressing 'res://{}' to '{}' failed.", pixelFormatNames[(int)GetAttribute("Pixel Format").GetInt()],
+            input->GetName(), outputFile);
+        return false;
+    }
+
+    AddByproduct(outputFile);
+    return true;
+}
+
 void TextureImporter::ApplyBlurLimit()
 {
     if (blur_ < 0.01f)
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/Image.h>
 
 #include "Pipeline/Importers/AssetImporter.h"
 
@@ -59,6 +60,8 @@ public:
         CRNF,
         RYG,
         ATI,
+        /// In-process DXT1/DXT3/DXT5 encoder, other pixel formats fall back to crunch.
+        Builtin,
     };
 
     enum class DxtQuality
@@ -119,6 +122,8 @@ protected:
     void ApplyQualityLimits();
     ///
     void ApplyAlphaThresholdLimits();
+    /// Compress texture using the built-in encoder. Return false if it failed.
+    bool ExecuteBuiltin(Urho3D::Asset* input, const ea::string& outputFile, CompressedFormat format);
 
     /// Always flip texture on Y axis before processing.
     bool yFlip_ = false;
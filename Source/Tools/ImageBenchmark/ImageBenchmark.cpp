@@ -0,0 +1,267 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/Image.h>
+
+using namespace Urho3D;
+
+/// Headless benchmark of image processing on a generated RGBA image. Reports the average time and throughput of each
+/// operation, the error of each compression quality and the decoding throughput of each compressed format.
+class ImageBenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(ImageBenchmarkApplication, Application);
+public:
+    explicit ImageBenchmarkApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_WORKER_THREADS] = false;
+        engineParameters_[EP_RESOURCE_PATHS] = "";
+        engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+
+        auto& app = GetCommandLineParser();
+        app.add_option("--size", size_, "Width and height of the image.")->set_default_str("4096");
+        app.add_option("--iterations", numIterations_, "Number of times each operation is measured.")->set_default_str("3");
+        app.add_option("--threads", numThreads_, "Number of worker threads, or -1 for one less than the number of CPU cores.")->set_default_str("-1");
+        app.add_flag("--srgb", sRGB_, "Filter color in linear space.");
+    }
+
+    void Start() override
+    {
+        size_ = Max(size_, 4);
+        numIterations_ = Max(numIterations_, 1);
+        const unsigned numThreads = numThreads_ < 0 ? GetNumPhysicalCPUs() - 1 : (unsigned)numThreads_;
+        GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
+
+        CreateImage();
+
+        PrintLine(Format("{}x{} RGBA, sRGB {}, {} worker threads, {} iterations", size_, size_, sRGB_ ? "on" : "off",
+            numThreads, numIterations_));
+        PrintLine("Operation                    Avg ms    MPixels/s  Notes");
+
+        const float megapixels = (float)size_ * size_ / 1000000.0f;
+        PrintResult("Mip chain", megapixels, Measure([this](unsigned)
+        {
+            SharedPtr<Image> level = image_;
+            while (level && (level->GetWidth() > 1 || level->GetHeight() > 1))
+                level = level->GetNextLevel();
+        }));
+
+        CopyImages();
+        PrintResult("Resize to half", megapixels, Measure([this](unsigned index)
+        {
+            copies_[index]->Resize(size_ / 2, size_ / 2);
+        }));
+
+        CopyImages();
+        PrintResult("Resize to 3/4", megapixels, Measure([this](unsigned index)
+        {
+            copies_[index]->Resize(size_ * 3 / 4, size_ * 3 / 4);
+        }));
+
+        CopyImages();
+        PrintResult("Resize to double", megapixels, Measure([this](unsigned index)
+        {
+            copies_[index]->Resize(size_ * 2, size_ * 2);
+        }));
+
+        // Compress only the top level; mip levels are compressed the same way and would skew the throughput
+        static const char* formatNames[] = { "DXT1", "DXT3", "DXT5" };
+        static const char* qualityNames[] = { "fast", "normal", "high" };
+        const CompressedFormat formats[] = { CF_DXT1, CF_DXT3, CF_DXT5 };
+        const CompressionQuality qualities[] = { COMPRESSION_FAST, COMPRESSION_NORMAL, COMPRESSION_HIGH };
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                SharedPtr<Image> compressedImage = image_->GetCompressedImage(formats[i], qualities[j], 1);
+                // DXT1 is encoded without alpha
+                const float error = GetCompressionError(compressedImage, formats[i] != CF_DXT1);
+                const float milliseconds = Measure([&](unsigned)
+                {
+                    image_->GetCompressedImage(formats[i], qualities[j], 1);
+                });
+                PrintResult(Format("Compress {} {}", formatNames[i], qualityNames[j]), megapixels, milliseconds,
+                    Format("RMSE {:.2f}", error));
+            }
+        }
+
+        // Decode random blocks, which are valid in every format. Throughput is also reported in MB of decoded RGBA data
+        static const char* decodeFormatNames[] = { "DXT1", "DXT5", "ETC1", "ETC2 RGBA", "PVRTC RGBA 4bpp" };
+        const CompressedFormat decodeFormats[] = { CF_DXT1, CF_DXT5, CF_ETC1, CF_ETC2_RGBA, CF_PVRTC_RGBA_4BPP };
+        ea::vector<unsigned char> decompressed((size_t)size_ * size_ * 4);
+        for (unsigned i = 0; i < 5; ++i)
+        {
+            // PVRTC supports only square power of two sizes
+            if (decodeFormats[i] == CF_PVRTC_RGBA_4BPP && !IsPowerOfTwo(size_))
+                continue;
+
+            ea::vector<unsigned char> data;
+            const CompressedLevel level = CreateRandomLevel(decodeFormats[i], data);
+            const float milliseconds = Measure([&](unsigned) { level.Decompress(decompressed.data(), context_); });
+            PrintResult(Format("Decode {}", decodeFormatNames[i]), megapixels, milliseconds,
+                Format("{:.1f} MB/s", megapixels * 4.0f * 1000.0f / milliseconds));
+        }
+
+        // Engine::Exit() does not end the main loop in headless mode
+        SendEvent(E_EXITREQUESTED);
+    }
+
+private:
+    /// Generate the source image: smooth gradients with noise, so that it is neither flat nor random.
+    void CreateImage()
+    {
+        SetRandomSeed(1);
+        image_ = MakeShared<Image>(context_);
+        image_->SetSize(size_, size_, 4);
+        image_->SetSRGB(sRGB_);
+        unsigned char* data = image_->GetData();
+        for (int y = 0; y < size_; ++y)
+        {
+            for (int x = 0; x < size_; ++x)
+            {
+                unsigned char* pixel = data + (y * size_ + x) * 4;
+                pixel[0] = (unsigned char)(x * 255 / size_);
+                pixel[1] = (unsigned char)(y * 255 / size_);
+                pixel[2] = (unsigned char)Clamp(128 + (int)(Rand() % 64) - 32, 0, 255);
+                pixel[3] = (unsigned char)((x ^ y) & 0xff);
+            }
+        }
+    }
+
+    /// Create a copy of the source image for each iteration of an operation that modifies the image.
+    void CopyImages()
+    {
+        copies_.clear();
+        for (int i = 0; i < numIterations_; ++i)
+        {
+            auto copy = MakeShared<Image>(context_);
+            copy->SetSize(size_, size_, 4);
+            copy->SetData(image_->GetData());
+            copy->SetSRGB(sRGB_);
+            copies_.push_back(copy);
+        }
+    }
+
+    /// Fill a compressed level of the image size with random blocks.
+    CompressedLevel CreateRandomLevel(CompressedFormat format, ea::vector<unsigned char>& data) const
+    {
+        CompressedLevel level;
+        level.format_ = format;
+        level.width_ = size_;
+        level.height_ = size_;
+        level.depth_ = 1;
+        if (format == CF_PVRTC_RGBA_4BPP)
+        {
+            level.blockSize_ = 8;
+            level.rowSize_ = (unsigned)size_ / 2;
+            level.rows_ = (unsigned)size_;
+        }
+        else
+        {
+            level.blockSize_ = format == CF_DXT1 || format == CF_ETC1 ? 8 : 16;
+            level.rowSize_ = (unsigned)(size_ + 3) / 4 * level.blockSize_;
+            level.rows_ = (unsigned)(size_ + 3) / 4;
+        }
+        level.dataSize_ = level.rowSize_ * level.rows_;
+
+        SetRandomSeed(1);
+        data.resize(level.dataSize_);
+        for (unsigned char& value : data)
+            value = (unsigned char)(Rand() & 0xff);
+        level.data_ = data.data();
+        return level;
+    }
+
+    /// Run an operation for each iteration and return the average time in milliseconds.
+    template <class T> float Measure(T operation)
+    {
+        HiresTimer timer;
+        for (int i = 0; i < numIterations_; ++i)
+            operation((unsigned)i);
+        return timer.GetUSec(false) / 1000.0f / numIterations_;
+    }
+
+    /// Print the average time and throughput of an operation.
+    void PrintResult(const ea::string& name, float megapixels, float milliseconds, const ea::string& note = EMPTY_STRING)
+    {
+        ea::string line = Format("{:<24}  {:10.2f}  {:11.1f}", name, milliseconds, megapixels * 1000.0f / milliseconds);
+        if (!note.empty())
+            line += "  " + note;
+        PrintLine(line);
+    }
+
+    /// Return root mean square error of the decompressed image against the source image.
+    float GetCompressionError(Image* compressedImage, bool includeAlpha) const
+    {
+        SharedPtr<Image> decompressedImage = compressedImage ? compressedImage->GetDecompressedImage() : nullptr;
+        if (!decompressedImage)
+            return M_INFINITY;
+
+        const unsigned numComponents = includeAlpha ? 4 : 3;
+        const unsigned char* source = image_->GetData();
+        const unsigned char* decompressed = decompressedImage->GetData();
+        double sumSquares = 0.0;
+        for (int i = 0; i < size_ * size_; ++i)
+        {
+            for (unsigned j = 0; j < numComponents; ++j)
+            {
+                const int difference = (int)source[i * 4 + j] - (int)decompressed[i * 4 + j];
+                sumSquares += difference * difference;
+            }
+        }
+        return (float)sqrt(sumSquares / ((double)size_ * size_ * numComponents));
+    }
+
+    /// Image width and height.
+    int size_{4096};
+    /// Number of iterations of each operation.
+    int numIterations_{3};
+    /// Number of worker threads.
+    int numThreads_{-1};
+    /// Filter color in linear space flag.
+    bool sRGB_{};
+
+    /// Source image.
+    SharedPtr<Image> image_;
+    /// Copies of the source image for operations that modify it.
+    ea::vector<SharedPtr<Image> > copies_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(ImageBenchmarkApplication);
@@ -0,0 +1,306 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Navigation/CrowdAgent.h>
+#include <Urho3D/Navigation/CrowdManager.h>
+#include <Urho3D/Navigation/Navigable.h>
+#include <Urho3D/Navigation/NavigationMesh.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Scene/Scene.h>
+
+using namespace Urho3D;
+
+/// Half size of the square level, in world units.
+static const float LEVEL_EXTENT = 48.0f;
+/// Number of obstacle rows and columns in the level.
+static const int NUM_OBSTACLE_ROWS = 10;
+/// Scene update time step, in seconds.
+static const float TIME_STEP = 1.0f / 60.0f;
+/// Maximum number of scene updates to wait for asynchronous path requests.
+static const unsigned MAX_FRAMES = 100000;
+/// Smallest number of crowd agents measured.
+static const int MIN_AGENTS = 250;
+
+/// Headless pathfinding benchmark on a generated level with a grid of obstacles. Compares paths found one by one with
+/// batched and asynchronous path requests, and serial crowd updates with multithreaded ones for a growing number of agents.
+class NavigationBenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(NavigationBenchmarkApplication, Application);
+public:
+    explicit NavigationBenchmarkApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_WORKER_THREADS] = false;
+        engineParameters_[EP_RESOURCE_PATHS] = "";
+        engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+
+        auto& app = GetCommandLineParser();
+        app.add_option("--paths", numPaths_, "Number of paths between random points.")->set_default_str("2000");
+        app.add_option("--agents", maxAgents_, "Largest number of crowd agents. Crowds are measured from 250 agents up, doubling each time.")->set_default_str("2000");
+        app.add_option("--frames", numFrames_, "Number of crowd updates.")->set_default_str("300");
+        app.add_option("--threads", numThreads_, "Number of worker threads, or -1 for one less than the number of CPU cores.")->set_default_str("-1");
+    }
+
+    void Start() override
+    {
+        numPaths_ = Max(numPaths_, 1);
+        maxAgents_ = Max(maxAgents_, 1);
+        numFrames_ = Max(numFrames_, 1);
+        const unsigned numThreads = numThreads_ < 0 ? GetNumPhysicalCPUs() - 1 : (unsigned)numThreads_;
+        GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
+
+        PrintLine(Format("{} paths, up to {} crowd agents for {} frames, {} worker threads", numPaths_, maxAgents_, numFrames_,
+            numThreads));
+        scene_ = CreateScene();
+        MeasurePaths();
+        MeasureCrowds();
+
+        // Engine::Exit() does not end the main loop in headless mode
+        SendEvent(E_EXITREQUESTED);
+    }
+
+private:
+    /// Create the level: a floor with a grid of box obstacles, and build the navigation mesh.
+    SharedPtr<Scene> CreateScene()
+    {
+        auto scene = MakeShared<Scene>(context_);
+        scene->CreateComponent<PhysicsWorld>();
+
+        Node* floorNode = scene->CreateChild("Floor");
+        floorNode->SetScale(Vector3(LEVEL_EXTENT * 2.0f + 4.0f, 1.0f, LEVEL_EXTENT * 2.0f + 4.0f));
+        floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+        floorNode->CreateComponent<Navigable>();
+
+        const float spacing = LEVEL_EXTENT * 2.0f / NUM_OBSTACLE_ROWS;
+        for (int i = 0; i < NUM_OBSTACLE_ROWS * NUM_OBSTACLE_ROWS; ++i)
+        {
+            Node* obstacleNode = scene->CreateChild("Obstacle");
+            obstacleNode->SetPosition(Vector3((i % NUM_OBSTACLE_ROWS + 0.5f) * spacing - LEVEL_EXTENT, 1.0f,
+                (i / NUM_OBSTACLE_ROWS + 0.5f) * spacing - LEVEL_EXTENT));
+            obstacleNode->SetScale(Vector3(spacing * 0.45f, 2.0f, spacing * 0.45f));
+            obstacleNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+            obstacleNode->CreateComponent<Navigable>();
+        }
+
+        auto* navMesh = scene->CreateComponent<NavigationMesh>();
+        navMesh->SetTileSize(64);
+        navMesh->Build();
+        return scene;
+    }
+
+    /// Find the same paths one by one, as a batch and as asynchronous requests. Print the throughput of each and the
+    /// number of paths that differ from the ones found one by one.
+    void MeasurePaths()
+    {
+        auto* navMesh = scene_->GetComponent<NavigationMesh>();
+        SetRandomSeed(1);
+        ea::vector<NavigationPathQuery> queries(numPaths_);
+        for (NavigationPathQuery& query : queries)
+        {
+            query.start_ = Vector3(Random(-LEVEL_EXTENT, LEVEL_EXTENT), 0.5f, Random(-LEVEL_EXTENT, LEVEL_EXTENT));
+            query.end_ = Vector3(Random(-LEVEL_EXTENT, LEVEL_EXTENT), 0.5f, Random(-LEVEL_EXTENT, LEVEL_EXTENT));
+        }
+
+        PrintLine("Method                 Total ms     Paths/s  Mismatches");
+
+        ea::vector<ea::vector<NavigationPathPoint>> singlePaths(queries.size());
+        HiresTimer timer;
+        for (unsigned i = 0; i < queries.size(); ++i)
+            navMesh->FindPath(singlePaths[i], queries[i].start_, queries[i].end_, queries[i].extents_);
+        PrintResult("FindPath", timer.GetUSec(false), 0);
+
+        ea::vector<ea::vector<NavigationPathPoint>> batchPaths;
+        timer.Reset();
+        navMesh->FindPaths(batchPaths, queries);
+        PrintResult("FindPaths", timer.GetUSec(false), GetNumMismatches(singlePaths, batchPaths));
+
+        ea::vector<ea::vector<NavigationPathPoint>> asyncPaths(queries.size());
+        unsigned numFinished = 0;
+        for (unsigned i = 0; i < queries.size(); ++i)
+        {
+            navMesh->RequestPath(queries[i], [&asyncPaths, &numFinished, i](const ea::vector<NavigationPathPoint>& path)
+            {
+                asyncPaths[i] = path;
+                ++numFinished;
+            });
+        }
+
+        // Requests are processed by a limited number of iterations per scene update
+        unsigned numFrames = 0;
+        timer.Reset();
+        while (numFinished < queries.size() && numFrames < MAX_FRAMES)
+        {
+            scene_->Update(TIME_STEP);
+            ++numFrames;
+        }
+
+        // Sliced pathfinding in Detour does not distinguish tile crossing sides, so it may choose another corridor of
+        // similar length. Report the difference of total path length along with the mismatches
+        const float lengthDifference = GetTotalLength(asyncPaths) / GetTotalLength(singlePaths) - 1.0f;
+        PrintResult("RequestPath", timer.GetUSec(false), GetNumMismatches(singlePaths, asyncPaths),
+            Format("{} scene updates, total length {:+.2f}%", numFrames, lengthDifference * 100.0f));
+    }
+
+    /// Move crowds of a growing number of agents to random targets with serial and multithreaded updates. Print the
+    /// time per frame of each and the number of agents whose final positions differ.
+    void MeasureCrowds()
+    {
+        PrintLine("Agents         Serial ms  Multithreaded ms    Speedup  Mismatches");
+
+        for (int numAgents = Min(MIN_AGENTS, maxAgents_);; numAgents = Min(numAgents * 2, maxAgents_))
+        {
+            ea::vector<Vector3> serialPositions;
+            ea::vector<Vector3> multithreadedPositions;
+            const float serialTime = SimulateCrowd(numAgents, false, serialPositions);
+            const float multithreadedTime = SimulateCrowd(numAgents, true, multithreadedPositions);
+
+            unsigned numMismatches = 0;
+            for (unsigned i = 0; i < serialPositions.size(); ++i)
+            {
+                if (serialPositions[i] != multithreadedPositions[i])
+                    ++numMismatches;
+            }
+
+            PrintLine(Format("{:<10}  {:12.2f}  {:16.2f}  {:8.2f}x  {:10}", numAgents, serialTime, multithreadedTime,
+                serialTime / multithreadedTime, numMismatches));
+
+            if (numAgents == maxAgents_)
+                break;
+        }
+    }
+
+    /// Move a crowd of agents to random targets. Return average scene update time in milliseconds and the final agent
+    /// positions.
+    float SimulateCrowd(int numAgents, bool multithreaded, ea::vector<Vector3>& positions)
+    {
+        SharedPtr<Scene> scene = CreateScene();
+        auto* crowdManager = scene->CreateComponent<CrowdManager>();
+        crowdManager->SetMaxAgents(numAgents);
+        crowdManager->SetMultithreaded(multithreaded);
+
+        // Same seed for both crowds, so that they simulate the same agents
+        SetRandomSeed(2);
+        ea::vector<Node*> agentNodes;
+        for (int i = 0; i < numAgents; ++i)
+        {
+            Node* agentNode = scene->CreateChild("Agent");
+            agentNode->SetPosition(Vector3(Random(-LEVEL_EXTENT, LEVEL_EXTENT), 0.5f, Random(-LEVEL_EXTENT, LEVEL_EXTENT)));
+            agentNode->CreateComponent<CrowdAgent>();
+            agentNodes.push_back(agentNode);
+        }
+        for (Node* agentNode : agentNodes)
+        {
+            const Vector3 target(Random(-LEVEL_EXTENT, LEVEL_EXTENT), 0.5f, Random(-LEVEL_EXTENT, LEVEL_EXTENT));
+            agentNode->GetComponent<CrowdAgent>()->SetTargetPosition(target);
+        }
+
+        HiresTimer timer;
+        for (int i = 0; i < numFrames_; ++i)
+            scene->Update(TIME_STEP);
+        const float milliseconds = timer.GetUSec(false) / 1000.0f / numFrames_;
+
+        positions.clear();
+        for (Node* agentNode : agentNodes)
+            positions.push_back(agentNode->GetPosition());
+        return milliseconds;
+    }
+
+    /// Return number of paths that differ from the reference paths.
+    static unsigned GetNumMismatches(const ea::vector<ea::vector<NavigationPathPoint>>& referencePaths,
+        const ea::vector<ea::vector<NavigationPathPoint>>& paths)
+    {
+        unsigned numMismatches = 0;
+        for (unsigned i = 0; i < referencePaths.size(); ++i)
+        {
+            if (i >= paths.size() || referencePaths[i].size() != paths[i].size())
+            {
+                ++numMismatches;
+                continue;
+            }
+
+            for (unsigned j = 0; j < paths[i].size(); ++j)
+            {
+                if (!referencePaths[i][j].position_.Equals(paths[i][j].position_))
+                {
+                    ++numMismatches;
+                    break;
+                }
+            }
+        }
+        return numMismatches;
+    }
+
+    /// Return total length of paths.
+    static float GetTotalLength(const ea::vector<ea::vector<NavigationPathPoint>>& paths)
+    {
+        float length = 0.0f;
+        for (const ea::vector<NavigationPathPoint>& path : paths)
+        {
+            for (unsigned i = 1; i < path.size(); ++i)
+                length += (path[i].position_ - path[i - 1].position_).Length();
+        }
+        return Max(length, M_EPSILON);
+    }
+
+    /// Print the total time and throughput of a path finding method.
+    void PrintResult(const char* name, long long microseconds, unsigned numMismatches, const ea::string& note = EMPTY_STRING)
+    {
+        ea::string line = Format("{:<20}  {:10.2f}  {:10.0f}  {:10}", name, microseconds / 1000.0f,
+            numPaths_ * 1000000.0f / Max(microseconds, 1LL), numMismatches);
+        if (!note.empty())
+            line += "  " + note;
+        PrintLine(line);
+    }
+
+    /// Number of paths.
+    int numPaths_{2000};
+    /// Largest number of crowd agents.
+    int maxAgents_{2000};
+    /// Number of crowd updates.
+    int numFrames_{300};
+    /// Number of worker threads.
+    int numThreads_{-1};
+
+    /// Scene for the path queries.
+    SharedPtr<Scene> scene_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(NavigationBenchmarkApplication);
@@ -0,0 +1,456 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Input/Controls.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SmoothedTransform.h>
+
+#include <EASTL/sort.h>
+#include <EASTL/unique_ptr.h>
+
+using namespace Urho3D;
+
+/// Remote event sent periodically by the simulated clients.
+URHO3D_EVENT(E_LOADTESTPING, LoadTestPing)
+{
+    URHO3D_PARAM(P_PAYLOAD, Payload);     // int
+}
+
+/// Interval between remote events sent by each client, in seconds.
+static const float PING_INTERVAL = 0.25f;
+/// Time to wait for new clients to join the scene before measuring, in seconds.
+static const float JOIN_TIMEOUT = 10.0f;
+/// Wrap-around period of the replication latency clock, in seconds. Keeps the clock value precise as a float.
+static const float CLOCK_PERIOD = 1000.0f;
+
+/// Client running in its own context, with only the subsystems needed for replication.
+struct SimulatedClient
+{
+    /// Context of the client.
+    SharedPtr<Context> context_;
+    /// Network subsystem of the client.
+    Network* network_{};
+    /// Replicated scene.
+    SharedPtr<Scene> scene_;
+    /// Replicated clock node used to measure latency.
+    WeakPtr<Node> clock_;
+    /// Last received clock value.
+    float lastClock_{};
+    /// Angle of the observer on its circular path.
+    float angle_{};
+    /// Center of the observer path.
+    Vector3 center_;
+    /// Time until the next remote event.
+    float pingTimer_{};
+};
+
+/// Return the value below which the given fraction of the sorted samples fall.
+static float GetPercentile(const ea::vector<float>& sortedSamples, float fraction)
+{
+    if (sortedSamples.empty())
+        return 0.0f;
+    const unsigned index = Min((unsigned)(fraction * sortedSamples.size()), sortedSamples.size() - 1);
+    return sortedSamples[index];
+}
+
+/// Headless server with an increasing number of simulated clients over loopback. Reports server replication cost,
+/// bandwidth and replication latency at each client count.
+class NetworkLoadTestApplication : public Application
+{
+    URHO3D_OBJECT(NetworkLoadTestApplication, Application);
+public:
+    explicit NetworkLoadTestApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_RESOURCE_PATHS] = "";
+        engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+
+        auto& app = GetCommandLineParser();
+        app.add_option("--clients", maxClients_, "Maximum number of simulated clients.")->set_default_str("32");
+        app.add_option("--step", clientStep_, "Number of clients added at each step.")->set_default_str("4");
+        app.add_option("--duration", stepDuration_, "Measurement time at each step in seconds.")->set_default_str("5");
+        app.add_option("--nodes", numNodes_, "Number of replicated world nodes.")->set_default_str("1000");
+        app.add_option("--moving", movingFraction_, "Fraction of world nodes moving every frame.")->set_default_str("0.25");
+        app.add_option("--area", areaSize_, "Size of the square world area.")->set_default_str("500");
+        app.add_option("--port", port_, "Server port.")->set_default_str("2345");
+        app.add_option("--fps", updateFps_, "Network update rate.")->set_default_str("30");
+        app.add_option("--interest-radius", interestRadius_, "Interest management radius, or 0 to replicate all nodes.")->set_default_str("0");
+        app.add_flag("--snapshots", snapshots_, "Send latest data as snapshots.");
+        app.add_flag("--no-compression", noCompression_, "Do not compress large packets.");
+        app.add_option("--latency", latency_, "Simulated latency in milliseconds. Only effective in debug builds.")->set_default_str("0");
+        app.add_option("--loss", packetLoss_, "Simulated packet loss probability. Only effective in debug builds.")->set_default_str("0");
+    }
+
+    void Start() override
+    {
+        maxClients_ = Max(maxClients_, 1u);
+        clientStep_ = Clamp(clientStep_, 1u, maxClients_);
+
+        scene_ = MakeShared<Scene>(context_);
+        for (unsigned i = 0; i < numNodes_; ++i)
+        {
+            Node* node = scene_->CreateChild("WorldNode");
+            node->SetPosition(Vector3(Random(areaSize_), 0.0f, Random(areaSize_)));
+            if (Random(1.0f) < movingFraction_)
+                movingNodes_.push_back(node);
+        }
+
+        auto* network = GetSubsystem<Network>();
+        network->SetUpdateFps(updateFps_);
+        network->SetSnapshotReplication(snapshots_);
+        network->SetPacketCompression(!noCompression_);
+        network->SetSimulatedLatency(latency_);
+        network->SetSimulatedPacketLoss(packetLoss_);
+        network->RegisterRemoteEvent(E_LOADTESTPING);
+        if (!network->StartServer(port_, maxClients_))
+        {
+            ErrorExit("Failed to start server.");
+            return;
+        }
+
+        SubscribeToEvent(E_CLIENTCONNECTED, URHO3D_HANDLER(NetworkLoadTestApplication, HandleClientConnected));
+        SubscribeToEvent(E_CLIENTDISCONNECTED, URHO3D_HANDLER(NetworkLoadTestApplication, HandleClientDisconnected));
+        SubscribeToEvent(E_LOADTESTPING, [this](StringHash, VariantMap&) { ++numPings_; });
+        SubscribeToEvent(E_NETWORKUPDATE, [this](StringHash, VariantMap&) { tickTimer_.Reset(); });
+        SubscribeToEvent(E_NETWORKUPDATESENT, [this](StringHash, VariantMap&)
+        {
+            if (measuring_)
+                tickSamples_.push_back(tickTimer_.GetUSec(false) / 1000.0f);
+        });
+        SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(NetworkLoadTestApplication, HandleUpdate));
+
+        PrintLine(Format("{} world nodes ({} moving), interest radius {}, snapshots {}, compression {}, latency {} ms, loss {}",
+            numNodes_, movingNodes_.size(), interestRadius_, snapshots_ ? "on" : "off", noCompression_ ? "off" : "on",
+            latency_, packetLoss_));
+        PrintLine("Clients  Tick avg ms  Tick p95 ms  Out B/s/client  In B/s/client  Latency p50/p95/p99 ms  Events/s");
+
+        AddClients();
+    }
+
+    void Stop() override
+    {
+        clients_.clear();
+    }
+
+private:
+    void HandleClientConnected(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace ClientConnected;
+
+        auto* connection = static_cast<Connection*>(eventData[P_CONNECTION].GetPtr());
+        connection->SetInterestRadius(interestRadius_);
+        connection->SetScene(scene_);
+
+        // Avatar controlled by the client, with a clock child updated every frame to measure replication latency
+        Node* avatar = scene_->CreateChild("Avatar");
+        avatar->SetOwner(connection);
+        avatar->CreateChild("Clock");
+        avatars_[connection] = avatar;
+    }
+
+    void HandleClientDisconnected(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace ClientDisconnected;
+
+        auto* connection = static_cast<Connection*>(eventData[P_CONNECTION].GetPtr());
+        auto i = avatars_.find(connection);
+        if (i != avatars_.end())
+        {
+            if (i->second)
+                i->second->Remove();
+            avatars_.erase(i);
+        }
+    }
+
+    void HandleUpdate(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace Update;
+
+        const float timeStep = eventData[P_TIMESTEP].GetFloat();
+        time_ += timeStep;
+
+        UpdateServerScene();
+        UpdateClients(timeStep);
+
+        if (!measuring_)
+        {
+            // Start measuring once all clients have joined the scene
+            stepTime_ += timeStep;
+            bool allJoined = true;
+            for (const auto& client : clients_)
+            {
+                Connection* connection = client->network_->GetServerConnection();
+                allJoined &= connection && connection->IsSceneLoaded();
+            }
+
+            if (allJoined || stepTime_ >= JOIN_TIMEOUT)
+            {
+                if (!allJoined)
+                    PrintLine("Not all clients joined the scene in time.", true);
+                BeginMeasurement();
+            }
+        }
+        else
+        {
+            stepTime_ += timeStep;
+            if (stepTime_ >= stepDuration_)
+            {
+                Report();
+                if (clients_.size() < maxClients_)
+                    AddClients();
+                else
+                {
+                    // Engine::Exit() does not end the main loop in headless mode
+                    UnsubscribeFromEvent(E_UPDATE);
+                    SendEvent(E_EXITREQUESTED);
+                }
+            }
+        }
+    }
+
+    void UpdateServerScene()
+    {
+        for (unsigned i = 0; i < movingNodes_.size(); ++i)
+        {
+            const float angle = time_ * 90.0f + i;
+            movingNodes_[i]->Translate(Vector3(Cos(angle), 0.0f, Sin(angle)) * 0.05f);
+        }
+
+        const float clock = fmodf(clock_.GetUSec(false) / 1000000.0f, CLOCK_PERIOD);
+        for (auto& avatar : avatars_)
+        {
+            if (!avatar.second)
+                continue;
+
+            // Follow the observer position sent by the client, jump while the first button is held
+            const Controls& controls = avatar.first->GetControls();
+            avatar.second->SetPosition(avatar.first->GetPosition() + Vector3::UP * (controls.IsDown(1) ? 1.0f : 0.0f));
+            avatar.second->SetRotation(Quaternion(controls.yaw_, Vector3::UP));
+            avatar.second->GetChild(0u)->SetPosition(Vector3(clock, 0.0f, 0.0f));
+        }
+    }
+
+    void UpdateClients(float timeStep)
+    {
+        const float now = fmodf(clock_.GetUSec(false) / 1000000.0f, CLOCK_PERIOD);
+
+        // Not from GetEventDataMap(), as the remote event data below would reuse the same map
+        VariantMap frameData;
+        frameData[BeginFrame::P_FRAMENUMBER] = GetSubsystem<Time>()->GetFrameNumber();
+        frameData[BeginFrame::P_TIMESTEP] = timeStep;
+
+        for (const auto& client : clients_)
+        {
+            Connection* connection = client->network_->GetServerConnection();
+            if (connection && connection->IsSceneLoaded())
+            {
+                // Walk in a circle with random button presses
+                client->angle_ += timeStep * 20.0f;
+                Controls controls;
+                controls.buttons_ = Random(2) ? 1u : 0u;
+                controls.yaw_ = client->angle_;
+                connection->SetControls(controls);
+                connection->SetPosition(client->center_ + Vector3(Cos(client->angle_), 0.0f, Sin(client->angle_)) * 10.0f);
+
+                client->pingTimer_ -= timeStep;
+                if (client->pingTimer_ <= 0.0f)
+                {
+                    client->pingTimer_ += PING_INTERVAL;
+                    VariantMap& pingData = GetEventDataMap();
+                    pingData[LoadTestPing::P_PAYLOAD] = Random(1000);
+                    connection->SendRemoteEvent(E_LOADTESTPING, true, pingData);
+                }
+            }
+
+            // Run the client network and scene update as its engine would. The scene update applies the smoothing
+            // of replicated transforms
+            client->network_->SendEvent(E_BEGINFRAME, frameData);
+            client->network_->SendEvent(E_RENDERUPDATE, frameData);
+            client->scene_->Update(timeStep);
+
+            if (!client->clock_)
+            {
+                client->clock_ = client->scene_->GetChild("Clock", true);
+                if (client->clock_)
+                    client->lastClock_ = client->clock_->GetPosition().x_;
+            }
+            else
+            {
+                // Use the smoothing target, which is the latest value received, so smoothing does not add latency
+                auto* transform = client->clock_->GetComponent<SmoothedTransform>();
+                const float clock = transform ? transform->GetTargetPosition().x_ : client->clock_->GetPosition().x_;
+                if (clock != client->lastClock_)
+                {
+                    client->lastClock_ = clock;
+                    if (measuring_)
+                    {
+                        float latency = now - clock;
+                        if (latency < 0.0f)
+                            latency += CLOCK_PERIOD;
+                        latencySamples_.push_back(latency * 1000.0f);
+                    }
+                }
+            }
+        }
+    }
+
+    void AddClients()
+    {
+        const unsigned numClients = Min(clients_.size() + clientStep_, maxClients_);
+        while (clients_.size() < numClients)
+        {
+            auto client = ea::make_unique<SimulatedClient>();
+            client->context_ = MakeShared<Context>();
+            client->context_->RegisterSubsystem(new Time(client->context_));
+            client->context_->RegisterSubsystem(new FileSystem(client->context_));
+            client->context_->RegisterSubsystem(new ResourceCache(client->context_));
+            client->network_ = new Network(client->context_);
+            client->context_->RegisterSubsystem(client->network_);
+            RegisterSceneLibrary(client->context_);
+
+            client->network_->SetUpdateFps(updateFps_);
+            client->network_->SetPacketCompression(!noCompression_);
+            client->network_->SetSimulatedLatency(latency_);
+            client->network_->SetSimulatedPacketLoss(packetLoss_);
+            client->scene_ = MakeShared<Scene>(client->context_);
+            client->center_ = Vector3(Random(areaSize_), 0.0f, Random(areaSize_));
+            client->pingTimer_ = Random(PING_INTERVAL);
+            if (!client->network_->Connect("127.0.0.1", port_, client->scene_))
+                PrintLine("Failed to connect a client.", true);
+
+            clients_.push_back(ea::move(client));
+        }
+
+        measuring_ = false;
+        stepTime_ = 0.0f;
+    }
+
+    void BeginMeasurement()
+    {
+        measuring_ = true;
+        stepTime_ = 0.0f;
+        numPings_ = 0;
+        tickSamples_.clear();
+        latencySamples_.clear();
+    }
+
+    void Report()
+    {
+        float bytesOut = 0.0f;
+        float bytesIn = 0.0f;
+        const ea::vector<SharedPtr<Connection> > connections = GetSubsystem<Network>()->GetClientConnections();
+        for (Connection* connection : connections)
+        {
+            bytesOut += connection->GetBytesOutPerSec();
+            bytesIn += connection->GetBytesInPerSec();
+        }
+        const float numConnections = Max((float)connections.size(), 1.0f);
+
+        float tickTotal = 0.0f;
+        for (float sample : tickSamples_)
+            tickTotal += sample;
+        ea::sort(tickSamples_.begin(), tickSamples_.end());
+        ea::sort(latencySamples_.begin(), latencySamples_.end());
+
+        PrintLine(Format("{:7}  {:11.3f}  {:11.3f}  {:14.0f}  {:13.0f}  {:8.1f}/{:.1f}/{:.1f}  {:16.1f}",
+            clients_.size(), tickSamples_.empty() ? 0.0f : tickTotal / tickSamples_.size(),
+            GetPercentile(tickSamples_, 0.95f), bytesOut / numConnections, bytesIn / numConnections,
+            GetPercentile(latencySamples_, 0.5f), GetPercentile(latencySamples_, 0.95f),
+            GetPercentile(latencySamples_, 0.99f), numPings_ / stepDuration_));
+    }
+
+    /// Maximum number of clients.
+    unsigned maxClients_{32};
+    /// Clients added at each step.
+    unsigned clientStep_{4};
+    /// Measurement time at each step.
+    float stepDuration_{5.0f};
+    /// Number of world nodes.
+    unsigned numNodes_{1000};
+    /// Fraction of moving world nodes.
+    float movingFraction_{0.25f};
+    /// World area size.
+    float areaSize_{500.0f};
+    /// Server port.
+    unsigned short port_{2345};
+    /// Network update rate.
+    int updateFps_{30};
+    /// Interest management radius.
+    float interestRadius_{};
+    /// Snapshot replication flag.
+    bool snapshots_{};
+    /// Disable packet compression flag.
+    bool noCompression_{};
+    /// Simulated latency.
+    int latency_{};
+    /// Simulated packet loss.
+    float packetLoss_{};
+
+    /// Server scene.
+    SharedPtr<Scene> scene_;
+    /// Moving world nodes.
+    ea::vector<Node*> movingNodes_;
+    /// Avatar nodes by client connection.
+    ea::unordered_map<Connection*, WeakPtr<Node> > avatars_;
+    /// Simulated clients.
+    ea::vector<ea::unique_ptr<SimulatedClient> > clients_;
+    /// Clock shared by the server and the clients.
+    HiresTimer clock_;
+    /// Timer of the current server network update.
+    HiresTimer tickTimer_;
+    /// Server network update times of the current step in milliseconds.
+    ea::vector<float> tickSamples_;
+    /// Replication latencies of the current step in milliseconds.
+    ea::vector<float> latencySamples_;
+    /// Remote events received during the current step.
+    unsigned numPings_{};
+    /// Scene time.
+    float time_{};
+    /// Time spent in the current step.
+    float stepTime_{};
+    /// Whether the current step is being measured.
+    bool measuring_{};
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(NetworkLoadTestApplication);
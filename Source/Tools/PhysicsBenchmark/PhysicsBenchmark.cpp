@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+using namespace Urho3D;
+
+/// Number of boxes stacked in each column of the stress scene.
+static const int COLUMN_HEIGHT = 10;
+/// Physics time step, in seconds.
+static const float TIME_STEP = 1.0f / 60.0f;
+
+/// Headless physics stress test in the spirit of the PhysicsStressTest sample. Simulates the same scene with the
+/// single-threaded and the multithreaded world and reports the time per step of each, then measures batched queries
+/// against the settled scene.
+class PhysicsBenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(PhysicsBenchmarkApplication, Application);
+public:
+    explicit PhysicsBenchmarkApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_WORKER_THREADS] = false;
+        engineParameters_[EP_RESOURCE_PATHS] = "";
+        engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+
+        auto& app = GetCommandLineParser();
+        app.add_option("--bodies", numBodies_, "Number of dynamic boxes.")->set_default_str("5000");
+        app.add_option("--steps", numSteps_, "Number of simulated steps.")->set_default_str("300");
+        app.add_option("--queries", numQueries_, "Number of raycasts and sphere casts; a tenth as many convex casts.")->set_default_str("20000");
+        app.add_option("--threads", numThreads_, "Number of worker threads, or -1 for one less than the number of CPU cores.")->set_default_str("-1");
+    }
+
+    void Start() override
+    {
+        numBodies_ = Max(numBodies_, 1);
+        numSteps_ = Max(numSteps_, 1);
+        numQueries_ = Max(numQueries_, 1);
+        const unsigned numThreads = numThreads_ < 0 ? GetNumPhysicalCPUs() - 1 : (unsigned)numThreads_;
+        GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
+
+        PrintLine(Format("{} boxes, {} steps, {} queries, {} worker threads", numBodies_, numSteps_, numQueries_, numThreads));
+        PrintLine("World               Avg ms     Max ms    Total s");
+
+        const float serialTime = Simulate("Single-threaded", false);
+        const float multithreadedTime = Simulate("Multithreaded", true);
+        PrintLine(Format("Speedup {:.2f}x", serialTime / multithreadedTime));
+
+        MeasureQueries();
+
+        // Engine::Exit() does not end the main loop in headless mode
+        SendEvent(E_EXITREQUESTED);
+    }
+
+private:
+    /// Create the stress scene: columns of boxes on a static floor.
+    SharedPtr<Scene> CreateScene(bool multithreaded)
+    {
+        PhysicsWorld::config.multithreaded_ = multithreaded;
+        auto scene = MakeShared<Scene>(context_);
+        auto* physicsWorld = scene->CreateComponent<PhysicsWorld>();
+        PhysicsWorld::config.multithreaded_ = false;
+
+        if (multithreaded && !physicsWorld->IsMultithreaded())
+            PrintLine("Multithreaded world is not supported, measuring the single-threaded world twice", true);
+
+        Node* floorNode = scene->CreateChild("Floor");
+        floorNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+        floorNode->CreateComponent<RigidBody>();
+        floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3(1000.0f, 1.0f, 1000.0f));
+
+        // Same seed for both worlds, so that they simulate the same scene
+        SetRandomSeed(1);
+        const int numColumns = (numBodies_ + COLUMN_HEIGHT - 1) / COLUMN_HEIGHT;
+        const int rowLength = CeilToInt(sqrtf((float)numColumns));
+        for (int i = 0; i < numBodies_; ++i)
+        {
+            const int column = i / COLUMN_HEIGHT;
+            const float x = (column % rowLength - rowLength * 0.5f) * 3.0f + Random(-0.5f, 0.5f);
+            const float z = (column / rowLength - rowLength * 0.5f) * 3.0f + Random(-0.5f, 0.5f);
+            const float y = 0.5f + (i % COLUMN_HEIGHT) * 1.1f;
+
+            Node* boxNode = scene->CreateChild("Box");
+            boxNode->SetPosition(Vector3(x, y, z));
+            boxNode->SetRotation(Quaternion(Random(-10.0f, 10.0f), Random(-180.0f, 180.0f), Random(-10.0f, 10.0f)));
+            auto* body = boxNode->CreateComponent<RigidBody>();
+            body->SetMass(1.0f);
+            body->SetFriction(0.75f);
+            boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+        }
+        return scene;
+    }
+
+    /// Simulate the stress scene and print the step times. The scene is kept for the queries. Return the total time in seconds.
+    float Simulate(const char* name, bool multithreaded)
+    {
+        scene_ = CreateScene(multithreaded);
+        auto* physicsWorld = scene_->GetComponent<PhysicsWorld>();
+
+        HiresTimer timer;
+        long long totalTime = 0;
+        long long maxTime = 0;
+        for (int i = 0; i < numSteps_; ++i)
+        {
+            timer.Reset();
+            physicsWorld->Update(TIME_STEP);
+            const long long stepTime = timer.GetUSec(false);
+            totalTime += stepTime;
+            maxTime = Max(maxTime, stepTime);
+        }
+
+        const float totalSeconds = totalTime / 1000000.0f;
+        PrintLine(Format("{:<15}  {:9.2f}  {:9.2f}  {:9.2f}", name, totalTime / 1000.0f / numSteps_, maxTime / 1000.0f,
+            totalSeconds));
+        return totalSeconds;
+    }
+
+    /// Run the same queries one by one and as a batch against the simulated scene. Print the throughput of each and the
+    /// number of batched results that differ from the single queries.
+    void MeasureQueries()
+    {
+        auto* physicsWorld = scene_->GetComponent<PhysicsWorld>();
+        auto* shape = scene_->GetChild("Box")->GetComponent<CollisionShape>();
+        const float extent = CeilToInt(sqrtf((float)numBodies_ / COLUMN_HEIGHT)) * 1.5f + 1.0f;
+
+        // Slanted rays from above, so that most of them hit the boxes
+        SetRandomSeed(2);
+        ea::vector<PhysicsRaycastQuery> raycasts(numQueries_);
+        for (PhysicsRaycastQuery& query : raycasts)
+        {
+            const Vector3 origin(Random(-extent, extent), 50.0f, Random(-extent, extent));
+            const Vector3 direction(Random(-0.2f, 0.2f), -1.0f, Random(-0.2f, 0.2f));
+            query.ray_ = Ray(origin, direction.Normalized());
+            query.maxDistance_ = 100.0f;
+        }
+        ea::vector<PhysicsRaycastQuery> sphereCasts = raycasts;
+        for (PhysicsRaycastQuery& query : sphereCasts)
+            query.radius_ = 0.5f;
+
+        ea::vector<PhysicsConvexCastQuery> convexCasts(Max(numQueries_ / 10, 1));
+        for (PhysicsConvexCastQuery& query : convexCasts)
+        {
+            query.startPos_ = Vector3(Random(-extent, extent), 50.0f, Random(-extent, extent));
+            query.startRot_ = Quaternion(Random(-180.0f, 180.0f), Vector3::UP);
+            query.endPos_ = query.startPos_ - Vector3(0.0f, 100.0f, 0.0f);
+            query.endRot_ = query.startRot_;
+        }
+
+        PrintLine("Query                 Single ms   Batch ms    Speedup  Mismatches");
+
+        ea::vector<PhysicsRaycastResult> singleResults;
+        ea::vector<PhysicsRaycastResult> batchResults;
+        MeasureQuery("Raycast", raycasts.size(), singleResults, batchResults,
+            [&](unsigned i) { physicsWorld->RaycastSingle(singleResults[i], raycasts[i].ray_, raycasts[i].maxDistance_); },
+            [&] { physicsWorld->RaycastSingleBatch(batchResults, raycasts); });
+
+        MeasureQuery("Sphere cast", sphereCasts.size(), singleResults, batchResults,
+            [&](unsigned i)
+            {
+                const PhysicsRaycastQuery& query = sphereCasts[i];
+                physicsWorld->SphereCast(singleResults[i], query.ray_, query.radius_, query.maxDistance_);
+            },
+            [&] { physicsWorld->RaycastSingleBatch(batchResults, sphereCasts); });
+
+        MeasureQuery("Convex cast", convexCasts.size(), singleResults, batchResults,
+            [&](unsigned i)
+            {
+                const PhysicsConvexCastQuery& query = convexCasts[i];
+                physicsWorld->ConvexCast(singleResults[i], shape, query.startPos_, query.startRot_, query.endPos_, query.endRot_);
+            },
+            [&] { physicsWorld->ConvexCastBatch(batchResults, shape, convexCasts); });
+    }
+
+    /// Measure one kind of query executed one by one and as a batch, and print the results.
+    template <class T, class U> void MeasureQuery(const char* name, unsigned numQueries,
+        ea::vector<PhysicsRaycastResult>& singleResults, ea::vector<PhysicsRaycastResult>& batchResults,
+        T singleQuery, U batchQuery)
+    {
+        singleResults.clear();
+        singleResults.resize(numQueries);
+
+        HiresTimer timer;
+        for (unsigned i = 0; i < numQueries; ++i)
+            singleQuery(i);
+        const float singleTime = timer.GetUSec(true) / 1000.0f;
+        batchQuery();
+        const float batchTime = timer.GetUSec(false) / 1000.0f;
+
+        unsigned numMismatches = 0;
+        for (unsigned i = 0; i < numQueries; ++i)
+        {
+            if (i >= batchResults.size() || singleResults[i] != batchResults[i])
+                ++numMismatches;
+        }
+
+        PrintLine(Format("{:<20}  {:9.2f}  {:9.2f}  {:8.2f}x  {:10}", name, singleTime, batchTime, singleTime / batchTime,
+            numMismatches));
+    }
+
+    /// Number of dynamic bodies.
+    int numBodies_{5000};
+    /// Number of simulated steps.
+    int numSteps_{300};
+    /// Number of raycasts and sphere casts.
+    int numQueries_{20000};
+    /// Number of worker threads.
+    int numThreads_{-1};
+
+    /// Last simulated scene.
+    SharedPtr<Scene> scene_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(PhysicsBenchmarkApplication);
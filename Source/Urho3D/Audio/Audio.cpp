@@ -30,10 +30,18 @@
 #include "../Core/CoreEvents.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
 #include "../IO/Log.h"
 
+#include <EASTL/sort.h>
+
 #include <SDL/SDL.h>
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -48,12 +56,41 @@ const char* AUDIO_CATEGORY = "Audio";
 static const int MIN_BUFFERLENGTH = 20;
 static const int MIN_MIXRATE = 11025;
 static const int MAX_MIXRATE = 48000;
+static const int DEFAULT_MIXAHEAD = 0;
+static const int MAX_MIXAHEAD = 500;
 static const StringHash SOUND_MASTER_HASH("Master");
 
 static void SDLAudioCallback(void* userdata, Uint8* stream, int len);
 
+/// Thread that mixes audio output ahead of the audio device callback.
+class AudioMixerThread : public Thread
+{
+public:
+    /// Construct.
+    explicit AudioMixerThread(Audio* audio) :
+        Thread("AudioMixer"),
+        audio_(audio)
+    {
+    }
+
+    /// Mix until stopped, sleeping while enough output is mixed ahead.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (!audio_->MixAhead())
+                Time::Sleep(1);
+        }
+    }
+
+private:
+    /// Audio subsystem.
+    Audio* audio_;
+};
+
 Audio::Audio(Context* context) :
-    Object(context)
+    Object(context),
+    mixAheadMSec_(DEFAULT_MIXAHEAD)
 {
     context_->RequireSDL(SDL_INIT_AUDIO);
 
@@ -132,10 +169,15 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
     fragmentSize_ = Min(NextPowerOfTwo((unsigned)mixRate >> 6u), (unsigned)obtained.samples);
     mixRate_ = obtained.freq;
     interpolation_ = interpolation;
-    clipBuffer_.reset(new int[stereo ? fragmentSize_ << 1u : fragmentSize_]);
+    mixBuffer_.reset(new float[stereo_ ? fragmentSize_ << 1u : fragmentSize_]);
+    workBuffer_.reset(new float[fragmentSize_ << 1u]);
+    deviceSamples_ = obtained.samples;
 
     URHO3D_LOGINFO("Set audio mode " + ea::to_string(mixRate_) + " Hz " + (stereo_ ? "stereo" : "mono") + " " + (interpolation_ ? " interpolated" : ""));
 
+    if (mixAheadMSec_ > 0)
+        StartMixAhead();
+
     return Play();
 }
 
@@ -216,6 +258,42 @@ void Audio::StopSound(Sound* sound)
     }
 }
 
+void Audio::SetMixAhead(int mixAheadMSec)
+{
+#ifdef URHO3D_THREADING
+    mixAheadMSec = Clamp(mixAheadMSec, 0, MAX_MIXAHEAD);
+#else
+    // Mixing ahead needs the audio mixer thread
+    mixAheadMSec = 0;
+#endif
+    if (mixAheadMSec == mixAheadMSec_)
+        return;
+
+    mixAheadMSec_ = mixAheadMSec;
+    if (!deviceID_)
+        return;
+
+    if (mixAheadMSec_ > 0 && !mixingAhead_)
+        StartMixAhead();
+    else if (mixAheadMSec_ == 0 && mixingAhead_)
+        StopMixAhead();
+    else
+        mixAheadSamples_ = (deviceSamples_ + (unsigned)(mixRate_ * mixAheadMSec_ / 1000)) * (stereo_ ? 2 : 1);
+}
+
+float Audio::GetLatency() const
+{
+    if (!mixRate_)
+        return 0.0f;
+    return (float)mixAheadBuffer_.GetNumReadable() / (float)(stereo_ ? 2 : 1) / (float)mixRate_;
+}
+
+void Audio::SetMaxVoices(unsigned maxVoices)
+{
+    MutexLock lock(audioMutex_);
+    maxVoices_ = maxVoices;
+}
+
 float Audio::GetMasterGain(const ea::string& type) const
 {
     // By definition previously unknown types return full volume
@@ -270,55 +348,177 @@ float Audio::GetSoundSourceMasterGain(StringHash typeHash) const
 void SDLAudioCallback(void* userdata, Uint8* stream, int len)
 {
     auto* audio = static_cast<Audio*>(userdata);
+    audio->ReadOutput(stream, len / audio->GetSampleSize());
+}
+
+/// Convert floating point samples to clamped 16-bit output.
+static void ConvertSamples(short dest[], const float source[], unsigned count)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
     {
-        MutexLock Lock(audio->GetMutex());
-        audio->MixOutput(stream, len / audio->GetSampleSize());
+        const __m128 first = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&source[i]), minValue), maxValue);
+        const __m128 second = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&source[i + 4]), minValue), maxValue);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[i]), _mm_packs_epi32(_mm_cvttps_epi32(first), _mm_cvttps_epi32(second)));
     }
+#endif
+    for (; i < count; ++i)
+        dest[i] = (short)Clamp(source[i], -32768.0f, 32767.0f);
+}
+
+void Audio::SelectVoices()
+{
+    voices_.clear();
+    virtualVoices_.clear();
+
+    for (SoundSource* source : soundSources_)
+    {
+        // Check for pause if necessary
+        if (!pausedSoundTypes_.empty())
+        {
+            if (pausedSoundTypes_.contains(source->GetSoundType()))
+                continue;
+        }
+
+        // Disabled sound sources keep their position
+        if (source->IsPlaying() && (source->IsEnabledEffective() || !source->GetNode()))
+            voices_.push_back(source);
+    }
+
+    if (maxVoices_ && voices_.size() > maxVoices_)
+    {
+        // Keep the highest priority and loudest voices, advance the rest virtually
+        const auto compare = [](const SoundSource* lhs, const SoundSource* rhs)
+        {
+            if (lhs->GetPriority() != rhs->GetPriority())
+                return lhs->GetPriority() > rhs->GetPriority();
+            return lhs->GetAudibility() > rhs->GetAudibility();
+        };
+        ea::nth_element(voices_.begin(), voices_.begin() + maxVoices_, voices_.end(), compare);
+        virtualVoices_.assign(voices_.begin() + maxVoices_, voices_.end());
+        voices_.resize(maxVoices_);
+    }
+
+    numVoices_ = voices_.size();
+    numVirtualVoices_ = virtualVoices_.size();
 }
 
 void Audio::MixOutput(void* dest, unsigned samples)
 {
-    if (!playing_ || !clipBuffer_)
+    if (!playing_ || !mixBuffer_)
     {
         memset(dest, 0, samples * (size_t)sampleSize_);
         return;
     }
 
+    SelectVoices();
+
     while (samples)
     {
-        // If sample count exceeds the fragment (clip buffer) size, split the work
+        // If sample count exceeds the fragment (mixing buffer) size, split the work
         unsigned workSamples = Min(samples, fragmentSize_);
-        unsigned clipSamples = workSamples;
+        unsigned mixSamples = workSamples;
         if (stereo_)
-            clipSamples <<= 1;
-
-        // Clear clip buffer
-        int* clipPtr = clipBuffer_.get();
-        memset(clipPtr, 0, clipSamples * sizeof(int));
+            mixSamples <<= 1;
 
-        // Mix samples to clip buffer
-        for (auto i = soundSources_.begin(); i != soundSources_.end(); ++i)
-        {
-            SoundSource* source = *i;
+        // Clear mixing buffer
+        float* mixPtr = mixBuffer_.get();
+        memset(mixPtr, 0, mixSamples * sizeof(float));
 
-            // Check for pause if necessary
-            if (!pausedSoundTypes_.empty())
-            {
-                if (pausedSoundTypes_.contains(source->GetSoundType()))
-                    continue;
-            }
+        // Mix samples to mixing buffer
+        for (SoundSource* source : voices_)
+            source->Mix(mixPtr, workBuffer_.get(), workSamples, mixRate_, stereo_, interpolation_);
+        for (SoundSource* source : virtualVoices_)
+            source->MixVirtual(workSamples, mixRate_);
 
-            source->Mix(clipPtr, workSamples, mixRate_, stereo_, interpolation_);
-        }
-        // Copy output from clip buffer to destination
-        auto* destPtr = (short*)dest;
-        while (clipSamples--)
-            *destPtr++ = (short)Clamp(*clipPtr++, -32768, 32767);
+        // Copy output from mixing buffer to destination
+        ConvertSamples(static_cast<short*>(dest), mixPtr, mixSamples);
         samples -= workSamples;
         ((unsigned char*&)dest) += sampleSize_ * workSamples;
     }
 }
 
+void Audio::ReadOutput(void* dest, unsigned samples)
+{
+    // Output mixed ahead is played first, also after mixing ahead was stopped, so that it is not dropped
+    const unsigned count = stereo_ ? samples << 1u : samples;
+    const unsigned numRead = mixAheadBuffer_.GetCapacity() ? mixAheadBuffer_.Read(static_cast<short*>(dest), count) : 0;
+    if (numRead == count)
+        return;
+
+    short* remaining = static_cast<short*>(dest) + numRead;
+    if (mixingAhead_)
+    {
+        memset(remaining, 0, (count - numRead) * sizeof(short));
+        ++numUnderruns_;
+    }
+    else
+    {
+        MutexLock lock(audioMutex_);
+        MixOutput(remaining, stereo_ ? (count - numRead) >> 1u : count - numRead);
+    }
+}
+
+bool Audio::MixAhead()
+{
+    const unsigned fragmentSamples = stereo_ ? fragmentSize_ << 1u : fragmentSize_;
+    if (mixAheadBuffer_.GetNumReadable() >= mixAheadSamples_ || mixAheadBuffer_.GetNumWritable() < fragmentSamples)
+        return false;
+
+    {
+        MutexLock lock(audioMutex_);
+        MixOutput(mixAheadFragment_.get(), fragmentSize_);
+    }
+    mixAheadBuffer_.Write(mixAheadFragment_.get(), fragmentSamples);
+    return true;
+}
+
+void Audio::StartMixAhead()
+{
+#ifdef URHO3D_THREADING
+    const unsigned channels = stereo_ ? 2 : 1;
+    const unsigned fragmentSamples = fragmentSize_ * channels;
+    const auto maxMixAheadSamples = (unsigned)(mixRate_ * MAX_MIXAHEAD / 1000);
+
+    const unsigned capacity = (deviceSamples_ + maxMixAheadSamples) * channels + fragmentSamples;
+
+    SDL_LockAudioDevice(deviceID_);
+    mixAheadSamples_ = (deviceSamples_ + (unsigned)(mixRate_ * mixAheadMSec_ / 1000)) * channels;
+    // Keep output still buffered from mixing ahead before, it is played first
+    if (mixAheadBuffer_.GetCapacity() < capacity)
+        mixAheadBuffer_.Reset(capacity);
+    mixAheadFragment_.reset(new short[fragmentSamples]);
+
+    // Fill the buffer before the device starts reading from it
+    while (MixAhead())
+    {
+    }
+    mixingAhead_ = true;
+    SDL_UnlockAudioDevice(deviceID_);
+
+    mixerThread_ = ea::make_unique<AudioMixerThread>(this);
+    mixerThread_->Run();
+#endif
+}
+
+void Audio::StopMixAhead()
+{
+    if (mixerThread_)
+    {
+        mixerThread_->Stop();
+        mixerThread_.reset();
+    }
+
+    if (deviceID_)
+        SDL_LockAudioDevice(deviceID_);
+    mixingAhead_ = false;
+    if (deviceID_)
+        SDL_UnlockAudioDevice(deviceID_);
+}
+
 void Audio::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace RenderUpdate;
@@ -332,9 +532,12 @@ void Audio::Release()
 
     if (deviceID_)
     {
+        StopMixAhead();
         SDL_CloseAudioDevice(deviceID_);
         deviceID_ = 0;
-        clipBuffer_.reset();
+        mixBuffer_.reset();
+        workBuffer_.reset();
+        mixAheadBuffer_.Reset(0);
     }
 }
 
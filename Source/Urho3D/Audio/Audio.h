@@ -26,6 +26,7 @@
 #include <EASTL/hash_set.h>
 
 #include "../Audio/AudioDefs.h"
+#include "../Audio/SampleRingBuffer.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
@@ -36,6 +37,7 @@ class AudioImpl;
 class Sound;
 class SoundListener;
 class SoundSource;
+class Thread;
 
 /// %Audio subsystem.
 class URHO3D_API Audio : public Object
@@ -70,6 +72,12 @@ public:
     void SetListener(SoundListener* listener);
     /// Stop any sound source playing a certain sound clip.
     void StopSound(Sound* sound);
+    /// Set how many milliseconds of output to mix ahead on the audio mixer thread. Longer mix-ahead tolerates longer mixing stalls at the cost of latency. 0 (default) mixes inside the audio device callback. Always 0 without threading support.
+    /// @property
+    void SetMixAhead(int mixAheadMSec);
+    /// Set maximum number of mixed voices. Playing sound sources beyond the limit with the lowest priority and gain become virtual voices, which advance playback without being mixed. 0 is unlimited.
+    /// @property
+    void SetMaxVoices(unsigned maxVoices);
 
     /// Return byte size of one sample.
     /// @property
@@ -87,6 +95,29 @@ public:
     /// @property
     bool IsStereo() const { return stereo_; }
 
+    /// Return maximum number of mixed voices. 0 is unlimited.
+    /// @property
+    unsigned GetMaxVoices() const { return maxVoices_; }
+
+    /// Return mix-ahead length in milliseconds.
+    /// @property
+    int GetMixAhead() const { return mixAheadMSec_; }
+
+    /// Return whether output is mixed ahead on the audio mixer thread.
+    bool IsMixingAhead() const { return mixingAhead_; }
+
+    /// Return duration of mixed output waiting for the audio device in seconds.
+    float GetLatency() const;
+
+    /// Return number of times the audio device requested more output than was mixed ahead.
+    unsigned GetNumUnderruns() const { return numUnderruns_; }
+
+    /// Return number of voices mixed during the last output.
+    unsigned GetNumVoices() const { return numVoices_; }
+
+    /// Return number of virtual voices advanced without mixing during the last output.
+    unsigned GetNumVirtualVoices() const { return numVirtualVoices_; }
+
     /// Return whether audio is being output.
     /// @property
     bool IsPlaying() const { return playing_; }
@@ -125,6 +156,10 @@ public:
 
     /// Mix sound sources into the buffer.
     void MixOutput(void* dest, unsigned samples);
+    /// Copy output mixed ahead into the buffer. The rest is filled with silence on underrun while mixing ahead, or mixed directly otherwise. Called from the audio device callback.
+    void ReadOutput(void* dest, unsigned samples);
+    /// Mix one fragment of output ahead. Return false if enough output is already mixed. Called from the audio mixer thread.
+    bool MixAhead();
 
 private:
     /// Handle render update event.
@@ -133,9 +168,33 @@ private:
     void Release();
     /// Actually update sound sources with the specific timestep. Called internally.
     void UpdateInternal(float timeStep);
-
-    /// Clipping buffer for mixing.
-    ea::unique_ptr<int[]> clipBuffer_;
+    /// Sort playing sound sources into mixed and virtual voices. Called internally.
+    void SelectVoices();
+    /// Start mixing ahead on the audio mixer thread. Called internally.
+    void StartMixAhead();
+    /// Stop mixing ahead and return to mixing in the audio device callback once the output mixed ahead is played. Called internally.
+    void StopMixAhead();
+
+    /// Floating point mixing buffer.
+    ea::unique_ptr<float[]> mixBuffer_;
+    /// Resampling work buffer.
+    ea::unique_ptr<float[]> workBuffer_;
+    /// Output mixed ahead for the audio device callback.
+    SampleRingBuffer mixAheadBuffer_;
+    /// Fragment buffer for mixing ahead.
+    ea::unique_ptr<short[]> mixAheadFragment_;
+    /// Audio mixer thread.
+    ea::unique_ptr<Thread> mixerThread_;
+    /// Mix-ahead length in milliseconds.
+    int mixAheadMSec_;
+    /// Number of samples to keep mixed ahead, including the audio device buffer.
+    std::atomic<unsigned> mixAheadSamples_{};
+    /// Whether the audio device callback reads output mixed ahead.
+    std::atomic<bool> mixingAhead_{};
+    /// Number of underruns.
+    std::atomic<unsigned> numUnderruns_{};
+    /// Audio device buffer size in samples.
+    unsigned deviceSamples_{};
     /// Audio thread mutex.
     Mutex audioMutex_;
     /// SDL audio device ID.
@@ -158,6 +217,16 @@ private:
     ea::hash_set<StringHash> pausedSoundTypes_;
     /// Sound sources.
     ea::vector<SoundSource*> soundSources_;
+    /// Sound sources to mix during the current output.
+    ea::vector<SoundSource*> voices_;
+    /// Sound sources to advance as virtual voices during the current output.
+    ea::vector<SoundSource*> virtualVoices_;
+    /// Maximum number of mixed voices.
+    unsigned maxVoices_{};
+    /// Number of voices mixed during the last output.
+    unsigned numVoices_{};
+    /// Number of virtual voices during the last output.
+    unsigned numVirtualVoices_{};
     /// Sound listener.
     WeakPtr<SoundListener> listener_;
 };
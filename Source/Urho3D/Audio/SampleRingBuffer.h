@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "../Math/MathDefs.h"
+
+#include <EASTL/unique_ptr.h>
+
+#include <atomic>
+#include <cstring>
+
+namespace Urho3D
+{
+
+/// Lock-free ring buffer of 16-bit samples for a single producer thread and a single consumer thread.
+class SampleRingBuffer
+{
+public:
+    /// Allocate storage for at least the specified number of samples and clear the buffer. Not thread-safe.
+    void Reset(unsigned capacity)
+    {
+        capacity_ = capacity ? NextPowerOfTwo(capacity) : 0;
+        buffer_.reset(capacity_ ? new short[capacity_] : nullptr);
+        readPosition_ = 0;
+        writePosition_ = 0;
+    }
+
+    /// Write samples. Return number of samples written. Called by the producer.
+    unsigned Write(const short* data, unsigned count)
+    {
+        const unsigned writePosition = writePosition_.load(std::memory_order_relaxed);
+        const unsigned readPosition = readPosition_.load(std::memory_order_acquire);
+        count = Min(count, capacity_ - (writePosition - readPosition));
+
+        const unsigned offset = writePosition & (capacity_ - 1);
+        const unsigned firstPart = Min(count, capacity_ - offset);
+        memcpy(&buffer_[offset], data, firstPart * sizeof(short));
+        memcpy(&buffer_[0], data + firstPart, (count - firstPart) * sizeof(short));
+
+        writePosition_.store(writePosition + count, std::memory_order_release);
+        return count;
+    }
+
+    /// Read samples. Return number of samples read. Called by the consumer.
+    unsigned Read(short* data, unsigned count)
+    {
+        const unsigned readPosition = readPosition_.load(std::memory_order_relaxed);
+        const unsigned writePosition = writePosition_.load(std::memory_order_acquire);
+        count = Min(count, writePosition - readPosition);
+
+        const unsigned offset = readPosition & (capacity_ - 1);
+        const unsigned firstPart = Min(count, capacity_ - offset);
+        memcpy(data, &buffer_[offset], firstPart * sizeof(short));
+        memcpy(data + firstPart, &buffer_[0], (count - firstPart) * sizeof(short));
+
+        readPosition_.store(readPosition + count, std::memory_order_release);
+        return count;
+    }
+
+    /// Return number of samples available for reading.
+    unsigned GetNumReadable() const { return writePosition_.load(std::memory_order_acquire) - readPosition_.load(std::memory_order_acquire); }
+    /// Return number of samples that can be written.
+    unsigned GetNumWritable() const { return capacity_ - GetNumReadable(); }
+    /// Return capacity in samples.
+    unsigned GetCapacity() const { return capacity_; }
+
+private:
+    /// Sample storage.
+    ea::unique_ptr<short[]> buffer_;
+    /// Capacity in samples, power of two.
+    unsigned capacity_{};
+    /// Total number of samples read.
+    std::atomic<unsigned> readPosition_{};
+    /// Total number of samples written.
+    std::atomic<unsigned> writePosition_{};
+};
+
+}
@@ -76,6 +76,9 @@ public:
     /// Set stereo panning. -1.0 is full left and 1.0 is full right.
     /// @property
     void SetPanning(float panning);
+    /// Set voice priority. When the audio subsystem limits the number of mixed voices, higher priority sources are mixed first and the rest play as virtual voices. Runtime only, not serialized, so that the attribute layout of SoundSource and SoundSource3D stays compatible with existing scenes.
+    /// @property
+    void SetPriority(int priority);
     /// Set to remove either the sound source component or its owner node from the scene automatically on sound playback completion. Disabled by default.
     /// @property
     void SetAutoRemoveMode(AutoRemoveMode mode);
@@ -113,6 +116,13 @@ public:
     /// @property
     float GetPanning() const { return panning_; }
 
+    /// Return voice priority.
+    /// @property
+    int GetPriority() const { return priority_; }
+
+    /// Return effective gain used to rank the voice against the other sound sources. Zero if not playing.
+    float GetAudibility() const;
+
     /// Return automatic removal mode on sound playback completion.
     /// @property
     AutoRemoveMode GetAutoRemoveMode() const { return autoRemove_; }
@@ -123,8 +133,10 @@ public:
 
     /// Update the sound source. Perform subclass specific operations. Called by Audio.
     virtual void Update(float timeStep);
-    /// Mix sound source output to a 32-bit clipping buffer. Called by Audio.
-    void Mix(int dest[], unsigned samples, int mixRate, bool stereo, bool interpolation);
+    /// Mix sound source output to a floating point mixing buffer, using a work buffer of at least 2 floats per sample for resampling. Called by Audio.
+    void Mix(float dest[], float work[], unsigned samples, int mixRate, bool stereo, bool interpolation);
+    /// Advance playback as a virtual voice without producing output. Called by Audio.
+    void MixVirtual(unsigned samples, int mixRate);
     /// Update the effective master gain. Called internally and by Audio when the master gain changes.
     void UpdateMasterGain();
 
@@ -156,6 +168,8 @@ protected:
     float panning_;
     /// Effective master gain.
     float masterGain_{};
+    /// Voice priority.
+    int priority_{};
     /// Whether finished event should be sent on playback stop.
     bool sendFinishedEvent_;
     /// Automatic removal mode.
@@ -170,22 +184,8 @@ private:
     void StopLockless();
     /// Set new playback position without locking the audio mutex. Called internally.
     void SetPlayPositionLockless(signed char* pos);
-    /// Mix mono sample to mono buffer.
-    void MixMonoToMono(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer.
-    void MixMonoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix mono sample to mono buffer interpolated.
-    void MixMonoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer interpolated.
-    void MixMonoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer.
-    void MixStereoToMono(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer.
-    void MixStereoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer interpolated.
-    void MixStereoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer interpolated.
-    void MixStereoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
+    /// Mix to the buffer, or only advance playback if the buffer is null.
+    void MixInternal(float dest[], float work[], unsigned samples, int mixRate, bool stereo, bool interpolation);
     /// Advance playback pointer without producing audible output.
     void MixZeroVolume(Sound* sound, unsigned samples, int mixRate);
     /// Advance playback pointer to simulate audio playback in headless mode.
@@ -112,6 +112,7 @@ struct AttributeInfo
         accessor_ = other.accessor_;
         defaultValue_ = other.defaultValue_;
         mode_ = other.mode_;
+        networkPrecision_ = other.networkPrecision_;
         metadata_ = other.metadata_;
         ptr_ = other.ptr_;
         enumNamesStorage_ = other.enumNamesStorage_;
@@ -165,6 +166,8 @@ struct AttributeInfo
     Variant defaultValue_;
     /// Attribute mode: whether to use for serialization, network replication, or both.
     AttributeModeFlags mode_ = AM_DEFAULT;
+    /// Quantization step for network replication of float and vector attributes. Zero sends full precision values.
+    float networkPrecision_ = 0.0f;
     /// Attribute metadata.
     VariantMap metadata_;
     /// Attribute data pointer if elsewhere than in the Serializable.
@@ -214,6 +217,15 @@ public:
             networkAttributeInfo_->metadata_[key] = value;
         return *this;
     }
+    /// Set quantization step for network replication. Float and vector values are sent as variable-length integer multiples of the step, quaternions are sent packed.
+    AttributeHandle& SetNetworkPrecision(float precision)
+    {
+        if (attributeInfo_)
+            attributeInfo_->networkPrecision_ = precision;
+        if (networkAttributeInfo_)
+            networkAttributeInfo_->networkPrecision_ = precision;
+        return *this;
+    }
 };
 
 }
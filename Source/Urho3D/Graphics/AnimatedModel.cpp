@@ -159,6 +159,15 @@ bool AnimatedModel::Load(Deserializer& source)
     return success;
 }
 
+bool AnimatedModel::LoadAttributeValues(const VariantVector& values)
+{
+    loading_ = true;
+    bool success = Component::LoadAttributeValues(values);
+    loading_ = false;
+
+    return success;
+}
+
 bool AnimatedModel::LoadXML(const XMLElement& source)
 {
     loading_ = true;
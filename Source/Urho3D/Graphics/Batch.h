@@ -291,7 +291,7 @@ public:
     /// Maximum sorted instances.
     unsigned maxSortedInstances_;
     /// Whether the pass command contains extra shader defines.
-    bool hasExtraDefines_;
+    bool hasExtraDefines_{};
     /// Vertex shader extra defines.
     ea::string vsExtraDefines_;
     /// Pixel shader extra defines.
@@ -904,9 +904,9 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
     if (useClipPlane_)
     {
         if (vs)
-            vs = vs->GetOwner()->GetVariation(VS, vs->GetDefinesClipPlane());
+            vs = vs->GetOwner()->GetVariation(VS, vs->GetDefinesClipPlaneHash(), vs->GetDefinesClipPlane().c_str());
         if (ps)
-            ps = ps->GetOwner()->GetVariation(PS, ps->GetDefinesClipPlane());
+            ps = ps->GetOwner()->GetVariation(PS, ps->GetDefinesClipPlaneHash(), ps->GetDefinesClipPlane().c_str());
     }
 
     if (vs == vertexShader_ && ps == pixelShader_)
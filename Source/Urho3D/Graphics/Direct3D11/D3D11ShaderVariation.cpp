@@ -162,6 +162,7 @@ void ShaderVariation::SetDefines(const ea::string& defines)
     definesClipPlane_ = defines;
     if (!definesClipPlane_.ends_with(" CLIPPLANE"))
         definesClipPlane_ += " CLIPPLANE";
+    definesClipPlaneHash_ = StringHash(definesClipPlane_);
 }
 
 bool ShaderVariation::LoadByteCode(const ea::string& binaryShaderName)
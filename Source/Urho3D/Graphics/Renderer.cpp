@@ -1382,15 +1382,27 @@ void Renderer::SetLightVolumeBatchShaders(Batch& batch, Camera* camera, const ea
         psi += DLPS_ORTHO;
     }
 
-    if (vsDefines.length())
-        batch.vertexShader_ = graphics_->GetShader(VS, vsName, deferredLightVSVariations[vsi] + vsDefines);
-    else
-        batch.vertexShader_ = graphics_->GetShader(VS, vsName, deferredLightVSVariations[vsi]);
+    batch.vertexShader_ = GetLightVolumeShader(VS, vsi, vsName, vsDefines);
+    batch.pixelShader_ = GetLightVolumeShader(PS, psi, psName, psDefines);
+}
 
-    if (psDefines.length())
-        batch.pixelShader_ = graphics_->GetShader(PS, psName, deferredLightPSVariations_[psi] + psDefines);
-    else
-        batch.pixelShader_ = graphics_->GetShader(PS, psName, deferredLightPSVariations_[psi]);
+ShaderVariation* Renderer::GetLightVolumeShader(ShaderType type, unsigned variation, const ea::string& name,
+    const ea::string& defines)
+{
+    // Usually only a few renderpath commands use each variation, so compare their name and defines directly. The
+    // shader define string only needs to be built on cache miss
+    ea::vector<LightVolumeShader>& shaders = type == VS ? lightVolumeVSShaders_[variation] : lightVolumePSShaders_[variation];
+    for (const LightVolumeShader& cached : shaders)
+    {
+        if (cached.name_ == name && cached.defines_ == defines)
+            return cached.shader_;
+    }
+
+    const ea::string variationDefines = type == VS ? ea::string(deferredLightVSVariations[variation]) :
+        deferredLightPSVariations_[variation];
+    ShaderVariation* shader = graphics_->GetShader(type, name, defines.length() ? variationDefines + defines : variationDefines);
+    shaders.push_back(LightVolumeShader{name, defines, SharedPtr<ShaderVariation>(shader)});
+    return shader;
 }
 
 void Renderer::SetCullMode(CullMode mode, Camera* camera)
@@ -1688,6 +1700,10 @@ void Renderer::LoadShaders()
 
     // Release old material shaders, mark them for reload
     ReleaseMaterialShaders();
+    for (ea::vector<LightVolumeShader>& shaders : lightVolumeVSShaders_)
+        shaders.clear();
+    for (ea::vector<LightVolumeShader>& shaders : lightVolumePSShaders_)
+        shaders.clear();
     shadersChangedFrameNumber_ = GetSubsystem<Time>()->GetFrameNumber();
 
     // Construct new names for deferred light volume pixel shaders based on rendering options
@@ -512,6 +512,8 @@ public:
     /// Choose shaders for a deferred light volume batch.
     void SetLightVolumeBatchShaders
         (Batch& batch, Camera* camera, const ea::string& vsName, const ea::string& psName, const ea::string& vsDefines, const ea::string& psDefines);
+    /// Return a deferred light volume shader for a light variation index and renderpath command defines. Cached per variation to avoid per-light string operations.
+    ShaderVariation* GetLightVolumeShader(ShaderType type, unsigned variation, const ea::string& name, const ea::string& defines);
     /// Set cull mode while taking possible projection flipping into account.
     void SetCullMode(CullMode mode, Camera* camera);
     /// Ensure sufficient size of the instancing vertex buffer. Return true if successful.
@@ -628,6 +630,21 @@ private:
     Mutex rendererMutex_;
     /// Current variation names for deferred light volume shaders.
     ea::vector<ea::string> deferredLightPSVariations_;
+    /// Deferred light volume shader cached for a light variation.
+    struct LightVolumeShader
+    {
+        /// Shader name.
+        ea::string name_;
+        /// Renderpath command defines.
+        ea::string defines_;
+        /// Shader variation.
+        SharedPtr<ShaderVariation> shader_;
+    };
+
+    /// Deferred light volume vertex shaders by light variation. Cleared when shaders are reloaded.
+    ea::vector<LightVolumeShader> lightVolumeVSShaders_[MAX_DEFERRED_LIGHT_VS_VARIATIONS];
+    /// Deferred light volume pixel shaders by light variation. Cleared when shaders are reloaded.
+    ea::vector<LightVolumeShader> lightVolumePSShaders_[MAX_DEFERRED_LIGHT_PS_VARIATIONS];
     /// Global shader defines, sorted to reduce amount of variations.
     ea::set<ea::string> globalShaderDefines_;
     /// Global shader defines as string.
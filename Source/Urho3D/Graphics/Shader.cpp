@@ -131,26 +131,31 @@ ShaderVariation* Shader::GetVariation(ShaderType type, const ea::string& defines
 
 ShaderVariation* Shader::GetVariation(ShaderType type, const char* defines)
 {
-    const unsigned definesHash = GetShaderDefinesHash(defines);
+    return GetVariation(type, StringHash(defines), defines);
+}
+
+ShaderVariation* Shader::GetVariation(ShaderType type, StringHash definesHash, const char* defines)
+{
+    const unsigned variationKey = GetShaderDefinesHash(definesHash);
 
     ea::unordered_map<unsigned, SharedPtr<ShaderVariation> >& variations(type == VS ? vsVariations_ : psVariations_);
-    auto i = variations.find(definesHash);
+    auto i = variations.find(variationKey);
     if (i == variations.end())
     {
         // If shader not found, normalize the defines (to prevent duplicates) and check again. In that case make an alias
         // so that further queries are faster
         const ea::string normalizedDefines = NormalizeDefines(defines);
-        const unsigned normalizedHash = GetShaderDefinesHash(normalizedDefines.c_str());
+        const unsigned normalizedHash = GetShaderDefinesHash(StringHash(normalizedDefines));
 
         i = variations.find(normalizedHash);
         if (i != variations.end())
-            variations.insert(ea::make_pair(definesHash, i->second));
+            variations.insert(ea::make_pair(variationKey, i->second));
         else
         {
             // No shader variation found. Create new
             i = variations.insert(ea::make_pair(normalizedHash, SharedPtr<ShaderVariation>(new ShaderVariation(this, type)))).first;
-            if (definesHash != normalizedHash)
-                variations.insert(ea::make_pair(definesHash, i->second));
+            if (variationKey != normalizedHash)
+                variations.insert(ea::make_pair(variationKey, i->second));
 
             Graphics* graphics = context_->GetSubsystem<Graphics>();
             i->second->SetName(GetFileName(GetName()));
@@ -163,12 +168,12 @@ ShaderVariation* Shader::GetVariation(ShaderType type, const char* defines)
     return i->second;
 }
 
-unsigned Shader::GetShaderDefinesHash(const char* defines) const
+unsigned Shader::GetShaderDefinesHash(StringHash definesHash) const
 {
     Graphics* graphics = context_->GetSubsystem<Graphics>();
-    unsigned definesHash = StringHash(defines).Value();
-    CombineHash(definesHash, graphics->GetGlobalShaderDefinesHash().Value());
-    return definesHash;
+    unsigned result = definesHash.Value();
+    CombineHash(result, graphics->GetGlobalShaderDefinesHash().Value());
+    return result;
 }
 
 bool Shader::ProcessSource(ea::string& code, Deserializer& source)
@@ -52,6 +52,8 @@ public:
     ShaderVariation* GetVariation(ShaderType type, const ea::string& defines);
     /// Return a variation with defines. Separate multiple defines with spaces.
     ShaderVariation* GetVariation(ShaderType type, const char* defines);
+    /// Return a variation by precomputed hash of the defines string, which avoids hashing the string on every query. The defines string is only used when the variation is not found.
+    ShaderVariation* GetVariation(ShaderType type, StringHash definesHash, const char* defines);
 
     /// Return either vertex or pixel shader source code.
     const ea::string& GetSourceCode(ShaderType type) const { return type == VS ? vsSourceCode_ : psSourceCode_; }
@@ -60,8 +62,8 @@ public:
     unsigned GetTimeStamp() const { return timeStamp_; }
 
 private:
-    /// Return hash for given shader defines and current global shader defines.
-    unsigned GetShaderDefinesHash(const char* defines) const;
+    /// Return hash for given shader defines hash and current global shader defines.
+    unsigned GetShaderDefinesHash(StringHash definesHash) const;
     /// Process source code and include files. Return true if successful.
     bool ProcessSource(ea::string& code, Deserializer& source);
     /// Sort the defines and strip extra spaces to prevent creation of unnecessary duplicate shader variations.
@@ -35,6 +35,14 @@
 namespace Urho3D
 {
 
+/// Return key of a shader name and defines combination.
+static unsigned GetShaderKey(const ea::string& name, const ea::string& defines)
+{
+    unsigned key = StringHash(name).Value();
+    CombineHash(key, StringHash(defines).Value());
+    return key;
+}
+
 ShaderPrecache::ShaderPrecache(Context* context, const ea::string& fileName) :
     Object(context),
     fileName_(fileName),
@@ -49,9 +57,8 @@ ShaderPrecache::ShaderPrecache(Context* context, const ea::string& fileName) :
         XMLElement shader = xmlFile_.GetRoot().GetChild("shader");
         while (shader)
         {
-            ea::string oldCombination = shader.GetAttribute("vs") + " " + shader.GetAttribute("vsdefines") + " " +
-                                    shader.GetAttribute("ps") + " " + shader.GetAttribute("psdefines");
-            usedCombinations_.insert(oldCombination);
+            usedCombinations_.insert(ea::make_pair(GetShaderKey(shader.GetAttribute("vs"), shader.GetAttribute("vsdefines")),
+                GetShaderKey(shader.GetAttribute("ps"), shader.GetAttribute("psdefines"))));
 
             shader = shader.GetNext("shader");
         }
@@ -91,11 +98,10 @@ void ShaderPrecache::StoreShaders(ShaderVariation* vs, ShaderVariation* ps)
     const ea::string& vsDefines = vs->GetDefines();
     const ea::string& psDefines = ps->GetDefines();
 
-    // Check for duplicate using strings (needed for combinations loaded from existing file)
-    ea::string newCombination = vsName + " " + vsDefines + " " + psName + " " + psDefines;
-    if (usedCombinations_.contains(newCombination))
+    // Check for duplicate using name and defines hashes (needed for combinations loaded from existing file)
+    const ea::pair<unsigned, unsigned> newCombination = ea::make_pair(GetShaderKey(vsName, vsDefines), GetShaderKey(psName, psDefines));
+    if (!usedCombinations_.insert(newCombination).second)
         return;
-    usedCombinations_.insert(newCombination);
 
     XMLElement shaderElem = xmlFile_.GetRoot().CreateChild("shader");
     shaderElem.SetAttribute("vs", vsName);
@@ -57,8 +57,8 @@ private:
     XMLFile xmlFile_;
     /// Already encountered shader combinations, pointer version for fast queries.
     ea::hash_set<ea::pair<ShaderVariation*, ShaderVariation*> > usedPtrCombinations_;
-    /// Already encountered shader combinations.
-    ea::hash_set<ea::string> usedCombinations_;
+    /// Already encountered shader combinations, as hashes of vertex and pixel shader names and defines.
+    ea::hash_set<ea::pair<unsigned, unsigned> > usedCombinations_;
 };
 
 }
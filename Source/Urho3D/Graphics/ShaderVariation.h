@@ -137,6 +137,9 @@ public:
     /// Return defines with the CLIPPLANE define appended. Used internally on Direct3D11 only, will be empty on other APIs.
     const ea::string& GetDefinesClipPlane() { return definesClipPlane_; }
 
+    /// Return hash of defines with the CLIPPLANE define appended. Used internally on Direct3D11 only.
+    StringHash GetDefinesClipPlaneHash() const { return definesClipPlaneHash_; }
+
     /// D3D11 vertex semantic names. Used internally.
     static const char* elementSemanticNames[];
 
@@ -172,6 +175,8 @@ private:
     ea::string defines_;
     /// Defines to use in compiling + CLIPPLANE define appended. Used only on Direct3D11.
     ea::string definesClipPlane_;
+    /// Hash of defines with CLIPPLANE define appended. Used only on Direct3D11.
+    StringHash definesClipPlaneHash_;
     /// Shader compile error string.
     ea::string compilerOutput_;
 };
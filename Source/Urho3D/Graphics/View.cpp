@@ -2918,15 +2918,21 @@ void View::CheckMaterialForAuxView(Material* material)
 
 void View::SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command)
 {
-    ea::string vsDefines = command.vertexShaderDefines_.trimmed();
-    ea::string psDefines = command.pixelShaderDefines_.trimmed();
+    const ea::string& vsDefines = command.vertexShaderDefines_;
+    const ea::string& psDefines = command.pixelShaderDefines_;
     if (vsDefines.length() || psDefines.length())
     {
+        // Queues persist between frames, so the define strings only need to be copied when the command changes
+        const StringHash vsDefinesHash(vsDefines);
+        const StringHash psDefinesHash(psDefines);
+        if (!queue.hasExtraDefines_ || vsDefinesHash != queue.vsExtraDefinesHash_ || psDefinesHash != queue.psExtraDefinesHash_)
+        {
+            queue.vsExtraDefines_ = vsDefines.trimmed();
+            queue.psExtraDefines_ = psDefines.trimmed();
+            queue.vsExtraDefinesHash_ = vsDefinesHash;
+            queue.psExtraDefinesHash_ = psDefinesHash;
+        }
         queue.hasExtraDefines_ = true;
-        queue.vsExtraDefines_ = vsDefines;
-        queue.psExtraDefines_ = psDefines;
-        queue.vsExtraDefinesHash_ = StringHash(vsDefines);
-        queue.psExtraDefinesHash_ = StringHash(psDefines);
     }
     else
         queue.hasExtraDefines_ = false;
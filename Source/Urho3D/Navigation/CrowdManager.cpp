@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../Navigation/CrowdAgent.h"
@@ -45,6 +47,7 @@ extern const char* NAVIGATION_CATEGORY;
 
 static const unsigned DEFAULT_MAX_AGENTS = 512;
 static const float DEFAULT_MAX_AGENT_RADIUS = 0.f;
+static const int MIN_AGENTS_PER_TASK = 32;
 
 static const StringVector filterTypesStructureElementNames =
 {
@@ -78,6 +81,71 @@ void CrowdAgentUpdateCallback(bool positionUpdate, dtCrowdAgent* ag, float* pos,
         crowdAgent->OnCrowdVelocityUpdate(ag, pos, dt);
 }
 
+/// Crowd task scheduler that runs the agent update phases on the engine work queue.
+class WorkQueueCrowdTaskScheduler : public dtCrowdTaskScheduler
+{
+public:
+    /// Construct.
+    explicit WorkQueueCrowdTaskScheduler(WorkQueue* workQueue) :
+        workQueue_(workQueue)
+    {
+    }
+
+    /// Return number of threads including the main thread.
+    int getNumThreads() override { return workQueue_ ? (int)workQueue_->GetNumThreads() + 1 : 1; }
+
+    /// Run the task for all agents and wait for completion.
+    void parallelFor(const int count, dtCrowdTask* task) override
+    {
+        const int numTasks = GetNumTasks(count);
+        if (numTasks <= 1)
+        {
+            task->run(0, count, 0);
+            return;
+        }
+
+        const int taskSize = (count + numTasks - 1) / numTasks;
+        ranges_.clear();
+        for (int begin = 0; begin < count; begin += taskSize)
+            ranges_.push_back(IntVector2(begin, Min(begin + taskSize, count)));
+
+        for (IntVector2& range : ranges_)
+        {
+            SharedPtr<WorkItem> item = workQueue_->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = RunTaskWork;
+            item->aux_ = task;
+            item->start_ = &range;
+            workQueue_->AddWorkItem(item);
+        }
+        workQueue_->Complete(M_MAX_UNSIGNED);
+    }
+
+private:
+    /// Run the task for a range of agents.
+    static void RunTaskWork(const WorkItem* item, unsigned threadIndex)
+    {
+        auto* task = reinterpret_cast<dtCrowdTask*>(item->aux_);
+        const IntVector2& range = *reinterpret_cast<const IntVector2*>(item->start_);
+        task->run(range.x_, range.y_, (int)threadIndex);
+    }
+
+    /// Return number of tasks to split the agents into. Runs serially outside the main thread or when the work queue is busy.
+    int GetNumTasks(int count) const
+    {
+        if (!workQueue_ || !workQueue_->GetNumThreads() || workQueue_->IsCompleting() || !Thread::IsMainThread())
+            return 1;
+
+        const int maxTasks = (int)workQueue_->GetNumThreads() + 1;
+        return Min((count + MIN_AGENTS_PER_TASK - 1) / MIN_AGENTS_PER_TASK, maxTasks);
+    }
+
+    /// Work queue.
+    WeakPtr<WorkQueue> workQueue_;
+    /// Agent ranges of the tasks being processed.
+    ea::vector<IntVector2> ranges_;
+};
+
 CrowdManager::CrowdManager(Context* context) :
     Component(context),
     maxAgents_(DEFAULT_MAX_AGENTS),
@@ -108,6 +176,7 @@ void CrowdManager::RegisterObject(Context* context)
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Obstacle Avoidance Types", GetObstacleAvoidanceTypesAttr, SetObstacleAvoidanceTypesAttr,
         VariantVector, Variant::emptyVariantVector, AM_DEFAULT)
         .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, obstacleAvoidanceTypesStructureElementNames);
+    URHO3D_ACCESSOR_ATTRIBUTE("Multithreaded", IsMultithreaded, SetMultithreaded, bool, false, AM_DEFAULT);
 }
 
 void CrowdManager::ApplyAttributes()
@@ -391,6 +460,19 @@ void CrowdManager::SetObstacleAvoidanceParams(unsigned obstacleAvoidanceType, co
     }
 }
 
+void CrowdManager::SetMultithreaded(bool enable)
+{
+    if (enable == multithreaded_)
+        return;
+
+    multithreaded_ = enable;
+    if (multithreaded_ && !taskScheduler_)
+        taskScheduler_ = ea::make_unique<WorkQueueCrowdTaskScheduler>(GetSubsystem<WorkQueue>());
+    if (crowd_)
+        crowd_->setTaskScheduler(multithreaded_ ? taskScheduler_.get() : nullptr);
+    MarkNetworkUpdate();
+}
+
 Vector3 CrowdManager::FindNearestPoint(const Vector3& point, int queryFilterType, dtPolyRef* nearestRef)
 {
     if (nearestRef)
@@ -593,6 +675,7 @@ bool CrowdManager::CreateCrowd()
         URHO3D_LOGERROR("Could not initialize DetourCrowd");
         return false;
     }
+    crowd_->setTaskScheduler(multithreaded_ ? taskScheduler_.get() : nullptr);
 
     // Reconfigure the newly initialized crowd
     SetQueryFilterTypesAttr(queryFilterTypeConfiguration);
@@ -31,6 +31,7 @@ using dtPolyRef = unsigned int;
 #endif
 
 class dtCrowd;
+class dtCrowdTaskScheduler;
 class dtQueryFilter;
 struct dtCrowdAgent;
 
@@ -113,6 +114,9 @@ public:
     void SetObstacleAvoidanceTypesAttr(const VariantVector& value);
     /// Set the params for the specified obstacle avoidance type.
     void SetObstacleAvoidanceParams(unsigned obstacleAvoidanceType, const CrowdObstacleAvoidanceParams& params);
+    /// Set whether to update the agents in parallel on the work queue. Agent callbacks are still invoked on the main thread and the results do not depend on the number of threads.
+    /// @property
+    void SetMultithreaded(bool enable);
 
     /// Get all the crowd agent components in the specified node hierarchy. If the node is not specified then use scene node. When inCrowdFilter is set to true then only get agents that are in the crowd.
     ea::vector<CrowdAgent*> GetAgents(Node* node = nullptr, bool inCrowdFilter = true) const;
@@ -168,6 +172,10 @@ public:
     /// Get the params for the specified obstacle avoidance type.
     const CrowdObstacleAvoidanceParams& GetObstacleAvoidanceParams(unsigned obstacleAvoidanceType) const;
 
+    /// Return whether the agents are updated in parallel.
+    /// @property
+    bool IsMultithreaded() const { return multithreaded_; }
+
 protected:
     /// Create and initialized internal Detour crowd object. When it is a recreate, it preserves the configuration and attempts to re-add existing agents in the previous crowd back to the newly created crowd.
     bool CreateCrowd();
@@ -199,6 +207,10 @@ private:
 
     /// Internal Detour crowd object.
     dtCrowd* crowd_{};
+    /// Task scheduler for the parallel crowd update.
+    ea::unique_ptr<dtCrowdTaskScheduler> taskScheduler_;
+    /// Whether to update the agents in parallel.
+    bool multithreaded_{};
     /// Velocity shader.
     CrowdAgentVelocityShader velocityShader_;
     /// NavigationMesh for which the crowd was created.
@@ -429,28 +429,7 @@ bool DynamicNavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                TileCacheData tiles[TILECACHE_MAXLAYERS];
-                int layerCt = BuildTile(geometryList, x, z, tiles);
-                for (int i = 0; i < layerCt; ++i)
-                {
-                    dtCompressedTileRef tileRef;
-                    int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                    if (dtStatusFailed((dtStatus)status))
-                    {
-                        dtFree(tiles[i].data);
-                        tiles[i].data = nullptr;
-                    }
-                }
-                tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-                ++numTiles;
-            }
-        }
+        unsigned numTiles = BuildTiles(geometryList, IntVector2::ZERO, GetNumTiles() - IntVector2::ONE);
 
         // For a full build it's necessary to update the nav mesh
         // not doing so will cause dependent components to crash, like CrowdManager
@@ -819,15 +798,17 @@ bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
     return true;
 }
 
-int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+int DynamicNavigationMesh::BuildTileLayers(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
 
-    tileCache_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
-
     const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
 
-    DynamicNavBuildData build(allocator_.get());
+    // Layers of different tiles are built in worker threads at the same time, so the linear allocator and the
+    // compressor of the tile cache must not be used here
+    dtTileCacheAlloc allocator;
+    TileCompressor compressor;
+    DynamicNavBuildData build(&allocator);
 
     rcConfig cfg;   // NOLINT(hicpp-member-init)
     memset(&cfg, 0, sizeof cfg);
@@ -974,65 +955,83 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         header.hmax = (unsigned short)layer->hmax;
 
         if (dtStatusFailed(
-            dtBuildTileCacheLayer(compressor_.get()/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
+            dtBuildTileCacheLayer(&compressor, &header, layer->heights, layer->areas/*areas*/, layer->cons,
                 &(tiles[retCt].data), &tiles[retCt].dataSize)))
         {
             URHO3D_LOGERROR("Failed to build tile cache layers");
+            for (int j = 0; j < retCt; ++j)
+                dtFree(tiles[j].data);
             return 0;
         }
         else
             ++retCt;
     }
 
-    // Send a notification of the rebuild of this tile to anyone interested
-    {
-        using namespace NavigationAreaRebuilt;
-        VariantMap& eventData = GetContext()->GetEventDataMap();
-        eventData[P_NODE] = GetNode();
-        eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
-        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
-    }
-
     return retCt;
 }
 
-unsigned DynamicNavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
+unsigned DynamicNavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const ea::vector<IntVector2>& tiles)
 {
-    unsigned numTiles = 0;
+    URHO3D_PROFILE("BuildNavigationMeshTiles");
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    // Build the compressed layers in parallel, then add them to the tile cache in the main thread
+    ea::vector<ea::vector<TileCacheData>> tileLayers(tiles.size());
+    ea::vector<unsigned> geometryHashes(tiles.size());
+    ProcessTiles(tiles.size(), [&](unsigned index)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        const IntVector2& tile = tiles[index];
+        TileCacheData layers[TILECACHE_MAXLAYERS];
+        const int layerCt = BuildTileLayers(geometryList, tile.x_, tile.y_, layers);
+        tileLayers[index].assign(layers, layers + layerCt);
+        geometryHashes[index] = GetTileGeometryHash(geometryList, tile);
+    });
+
+    unsigned numTiles = 0;
+    for (unsigned index = 0; index < tiles.size(); ++index)
+    {
+        const int x = tiles[index].x_;
+        const int z = tiles[index].y_;
+
+        dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
+        const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
+        for (int i = 0; i < existingCt; ++i)
         {
-            dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
-            const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
-            for (int i = 0; i < existingCt; ++i)
+            unsigned char* data = nullptr;
+            if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
+                dtFree(data);
+        }
+
+        for (TileCacheData& layer : tileLayers[index])
+        {
+            dtCompressedTileRef tileRef;
+            int status = tileCache_->addTile(layer.data, layer.dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
+            if (dtStatusFailed((dtStatus)status))
             {
-                unsigned char* data = nullptr;
-                if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
-                    dtFree(data);
+                dtFree(layer.data);
+                layer.data = nullptr;
             }
-
-            TileCacheData tiles[TILECACHE_MAXLAYERS];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
+            else
             {
-                dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                if (dtStatusFailed((dtStatus)status))
-                {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = nullptr;
-                }
-                else
-                {
-                    tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
+                tileCache_->buildNavMeshTile(tileRef, navMesh_);
+                ++numTiles;
             }
         }
+
+        SetTileGeometryHash(tiles[index], geometryHashes[index]);
+
+        // Send a notification of the rebuild of this tile to anyone interested
+        if (!tileLayers[index].empty())
+        {
+            const BoundingBox tileBoundingBox = GetTileBoundingBox(tiles[index]);
+
+            using namespace NavigationAreaRebuilt;
+            VariantMap& eventData = GetContext()->GetEventDataMap();
+            eventData[P_NODE] = GetNode();
+            eventData[P_MESH] = this;
+            eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
+            eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+            SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
+        }
     }
 
     return numTiles;
@@ -1070,6 +1069,8 @@ void DynamicNavigationMesh::ReleaseTileCache()
 
 void DynamicNavigationMesh::OnSceneSet(Scene* scene)
 {
+    NavigationMesh::OnSceneSet(scene);
+
     // Subscribe to the scene subsystem update, which will trigger the tile cache to update the nav mesh
     if (scene)
         SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(DynamicNavigationMesh, HandleSceneSubsystemUpdate));
@@ -121,10 +121,11 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle* obstacle, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
-    /// Build tiles in the rectangular area. Return number of built tiles.
-    unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Build tile cache layers of one tile without adding them to the tile cache. Safe to call from worker threads. Return number of built layers.
+    int BuildTileLayers(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
+    /// Build tiles in the list. Tile layers are built in worker threads if possible. Return number of built tiles.
+    unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const ea::vector<IntVector2>& tiles) override;
+    using NavigationMesh::BuildTiles;
     /// Off-mesh connections to be rebuilt in the mesh processor.
     ea::vector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -46,6 +48,7 @@
 #include "../Physics/CollisionShape.h"
 #endif
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
 #include <cfloat>
 #include <Detour/DetourNavMesh.h>
@@ -80,13 +83,24 @@ static const float DEFAULT_EDGE_MAX_LENGTH = 12.0f;
 static const float DEFAULT_EDGE_MAX_ERROR = 1.3f;
 static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
+static const unsigned DEFAULT_MAX_PATH_ITERATIONS = 1024;
 
 static const int MAX_POLYS = 2048;
 
 
+static const unsigned MIN_PATH_QUERIES_PER_TASK = 8;
+
 /// Temporary data for finding a path.
 struct FindPathData
 {
+    /// Destruct.
+    ~FindPathData()
+    {
+        dtFreeNavMeshQuery(query_);
+    }
+
+    // Navigation mesh query owned by this data, if any.
+    dtNavMeshQuery* query_{};
     // Polygons.
     dtPolyRef polys_[MAX_POLYS]{};
     // Polygons on the path.
@@ -97,6 +111,137 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// World space navigation area used to assign area IDs to path points.
+struct PathAreaInfo
+{
+    /// World space bounding box.
+    BoundingBox boundingBox_;
+    /// World space center.
+    Vector3 center_;
+    /// Area ID.
+    unsigned char areaID_;
+};
+
+/// Shared data of a batched path query.
+struct FindPathBatch
+{
+    /// Queries.
+    const NavigationPathQuery* queries_;
+    /// Results.
+    ea::vector<NavigationPathPoint>* results_;
+    /// Per-thread pathfinding data.
+    FindPathData* const* threadPathData_;
+    /// Default query filter.
+    const dtQueryFilter* defaultFilter_;
+    /// Navigation mesh world transform.
+    Matrix3x4 transform_;
+    /// Navigation areas.
+    const ea::vector<PathAreaInfo>* areas_;
+};
+
+static void CollectPathAreas(const ea::vector<WeakPtr<NavArea> >& areas, ea::vector<PathAreaInfo>& dest)
+{
+    dest.clear();
+    for (NavArea* area : areas)
+    {
+        if (area && area->IsEnabledEffective())
+            dest.push_back(PathAreaInfo{area->GetWorldBoundingBox(), area->GetNode()->GetWorldPosition(), (unsigned char)area->GetAreaID()});
+    }
+}
+
+/// Convert polygon corridor to world space path points.
+static void BuildStraightPath(ea::vector<NavigationPathPoint>& dest, dtNavMeshQuery* query, FindPathData& data, int numPolys,
+    dtPolyRef endRef, const Vector3& localStart, const Vector3& localEnd, const Matrix3x4& transform,
+    const ea::vector<PathAreaInfo>& areas)
+{
+    int numPathPoints = 0;
+    Vector3 actualLocalEnd = localEnd;
+
+    // If full path was not found, clamp end point to the end polygon
+    if (data.polys_[numPolys - 1] != endRef)
+        query->closestPointOnPoly(data.polys_[numPolys - 1], &localEnd.x_, &actualLocalEnd.x_, nullptr);
+
+    query->findStraightPath(&localStart.x_, &actualLocalEnd.x_, data.polys_, numPolys,
+        &data.pathPoints_[0].x_, data.pathFlags_, data.pathPolys_, &numPathPoints, MAX_POLYS);
+
+    // Transform path result back to world space
+    for (int i = 0; i < numPathPoints; ++i)
+    {
+        NavigationPathPoint pt;
+        pt.position_ = transform * data.pathPoints_[i];
+        pt.flag_ = (NavigationPathPointFlag)data.pathFlags_[i];
+
+        // Walk through all NavAreas and find nearest
+        unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
+        float nearestDistance = M_LARGE_VALUE;
+        for (const PathAreaInfo& area : areas)
+        {
+            if (area.boundingBox_.IsInside(pt.position_) == INSIDE)
+            {
+                float distance = (area.center_ - pt.position_).LengthSquared();
+                if (distance < nearestDistance)
+                {
+                    nearestDistance = distance;
+                    nearestNavAreaID = area.areaID_;
+                }
+            }
+        }
+        pt.areaID_ = (unsigned char)nearestNavAreaID;
+
+        dest.push_back(pt);
+    }
+}
+
+/// Find a path between world space points. Does not access the navigation mesh component, so can be called from worker threads.
+static void FindPathImpl(ea::vector<NavigationPathPoint>& dest, dtNavMeshQuery* query, FindPathData& data, const Vector3& start,
+    const Vector3& end, const Vector3& extents, const dtQueryFilter* queryFilter, const Matrix3x4& transform,
+    const ea::vector<PathAreaInfo>& areas)
+{
+    dest.clear();
+
+    // Navigation data is in local space. Transform path points from world to local
+    Matrix3x4 inverse = transform.Inverse();
+
+    Vector3 localStart = inverse * start;
+    Vector3 localEnd = inverse * end;
+
+    dtPolyRef startRef;
+    dtPolyRef endRef;
+    query->findNearestPoly(&localStart.x_, &extents.x_, queryFilter, &startRef, nullptr);
+    query->findNearestPoly(&localEnd.x_, &extents.x_, queryFilter, &endRef, nullptr);
+
+    if (!startRef || !endRef)
+        return;
+
+    int numPolys = 0;
+    query->findPath(startRef, endRef, &localStart.x_, &localEnd.x_, queryFilter, data.polys_, &numPolys, MAX_POLYS);
+    if (!numPolys)
+        return;
+
+    BuildStraightPath(dest, query, data, numPolys, endRef, localStart, localEnd, transform, areas);
+}
+
+static void FindPathRange(const FindPathBatch& batch, unsigned threadIndex, const NavigationPathQuery* start,
+    const NavigationPathQuery* end)
+{
+    FindPathData& data = *batch.threadPathData_[threadIndex];
+
+    for (const NavigationPathQuery* query = start; query != end; ++query)
+    {
+        const dtQueryFilter* queryFilter = query->filter_ ? query->filter_ : batch.defaultFilter_;
+        FindPathImpl(batch.results_[query - batch.queries_], data.query_, data, query->start_, query->end_, query->extents_,
+            queryFilter, batch.transform_, *batch.areas_);
+    }
+}
+
+static void FindPathsWork(const WorkItem* item, unsigned threadIndex)
+{
+    URHO3D_PROFILE("FindPathsWork");
+    const FindPathBatch& batch = *reinterpret_cast<FindPathBatch*>(item->aux_);
+    FindPathRange(batch, threadIndex, reinterpret_cast<const NavigationPathQuery*>(item->start_),
+        reinterpret_cast<const NavigationPathQuery*>(item->end_));
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(nullptr),
@@ -122,7 +267,8 @@ NavigationMesh::NavigationMesh(Context* context) :
     partitionType_(NAVMESH_PARTITION_WATERSHED),
     keepInterResults_(false),
     drawOffMeshConnections_(false),
-    drawNavAreas_(false)
+    drawNavAreas_(false),
+    maxPathIterations_(DEFAULT_MAX_PATH_ITERATIONS)
 {
 }
 
@@ -521,6 +667,65 @@ bool NavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     return true;
 }
 
+bool NavigationMesh::BuildChangedTiles()
+{
+    URHO3D_PROFILE("BuildChangedNavigationMeshTiles");
+
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    ea::vector<NavigationGeometryInfo> geometryList;
+    CollectGeometries(geometryList);
+
+    ea::vector<unsigned> hashes;
+    GetTileGeometryHashes(geometryList, hashes);
+
+    const unsigned numKnownTiles = tileGeometryHashes_.size();
+    ea::vector<IntVector2> changedTiles;
+    BoundingBox changedBox;
+    for (int z = 0; z < numTilesZ_; ++z)
+    {
+        for (int x = 0; x < numTilesX_; ++x)
+        {
+            const IntVector2 tile(x, z);
+            const unsigned index = (unsigned)(z * numTilesX_ + x);
+            const unsigned previousHash = index < numKnownTiles ? tileGeometryHashes_[index] : 0;
+            if (hashes[index] != previousHash)
+            {
+                changedTiles.push_back(tile);
+                changedBox.Merge(GetTileBoundingBox(tile));
+            }
+        }
+    }
+
+    unsigned numTiles = 0;
+    if (!changedTiles.empty())
+    {
+        // Only the geometry around the changed tiles is needed to build them
+        const float borderSize = (float)(CeilToInt(agentRadius_ / cellSize_) + 3) * cellSize_;
+        changedBox.min_ -= Vector3(borderSize, 0.0f, borderSize);
+        changedBox.max_ += Vector3(borderSize, 0.0f, borderSize);
+
+        ea::vector<NavigationGeometryInfo> changedGeometryList;
+        for (const NavigationGeometryInfo& info : geometryList)
+        {
+            if (changedBox.IsInsideFast(info.boundingBox_) != OUTSIDE)
+                changedGeometryList.push_back(info);
+        }
+
+        numTiles = BuildTiles(changedGeometryList, changedTiles);
+    }
+
+    URHO3D_LOGDEBUG("Rebuilt " + ea::to_string(numTiles) + " changed tiles of the navigation mesh");
+    return true;
+}
+
 ea::vector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -575,6 +780,8 @@ void NavigationMesh::RemoveTile(const IntVector2& tile)
         return;
 
     navMesh_->removeTile(tileRef, nullptr, nullptr);
+    // Forget the geometry of the tile, so that BuildChangedTiles() builds it again
+    SetTileGeometryHash(tile, 0);
 
     // Send event
     using namespace NavigationTileRemoved;
@@ -595,6 +802,7 @@ void NavigationMesh::RemoveAllTiles()
         if (tile->header)
             navMesh_->removeTile(navMesh_->getTileRef(tile), nullptr, nullptr);
     }
+    tileGeometryHashes_.clear();
 
     // Send event
     using namespace NavigationAllTilesRemoved;
@@ -670,73 +878,168 @@ void NavigationMesh::FindPath(ea::vector<NavigationPathPoint>& dest, const Vecto
     if (!InitializeQuery())
         return;
 
-    // Navigation data is in local space. Transform path points from world to local
-    const Matrix3x4& transform = node_->GetWorldTransform();
-    Matrix3x4 inverse = transform.Inverse();
+    ea::vector<PathAreaInfo> areas;
+    CollectPathAreas(areas_, areas);
 
-    Vector3 localStart = inverse * start;
-    Vector3 localEnd = inverse * end;
+    FindPathImpl(dest, navMeshQuery_, *pathData_, start, end, extents, filter ? filter : queryFilter_.get(),
+        node_->GetWorldTransform(), areas);
+}
 
-    const dtQueryFilter* queryFilter = filter ? filter : queryFilter_.get();
-    dtPolyRef startRef;
-    dtPolyRef endRef;
-    navMeshQuery_->findNearestPoly(&localStart.x_, &extents.x_, queryFilter, &startRef, nullptr);
-    navMeshQuery_->findNearestPoly(&localEnd.x_, &extents.x_, queryFilter, &endRef, nullptr);
+void NavigationMesh::FindPaths(ea::vector<ea::vector<NavigationPathPoint>>& results, ea::span<const NavigationPathQuery> queries)
+{
+    URHO3D_PROFILE("FindPaths");
 
-    if (!startRef || !endRef)
+    const unsigned count = queries.size();
+    results.resize(count);
+    for (ea::vector<NavigationPathPoint>& path : results)
+        path.clear();
+
+    if (!count || !InitializeQuery())
         return;
 
-    int numPolys = 0;
-    int numPathPoints = 0;
+    auto* queue = GetSubsystem<WorkQueue>();
+    const bool threaded = count > MIN_PATH_QUERIES_PER_TASK && queue && queue->GetNumThreads() && !queue->IsCompleting()
+        && Thread::IsMainThread();
+    const unsigned numThreads = threaded ? queue->GetNumThreads() + 1 : 1;
 
-    navMeshQuery_->findPath(startRef, endRef, &localStart.x_, &localEnd.x_, queryFilter, pathData_->polys_, &numPolys,
-        MAX_POLYS);
-    if (!numPolys)
+    // Each thread needs a navigation mesh query of its own
+    if (threadPathData_.size() < numThreads)
+        threadPathData_.resize(numThreads);
+    ea::vector<FindPathData*> threadPathData(numThreads);
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        threadPathData[i] = GetOwnedPathData(threadPathData_[i]);
+        if (!threadPathData[i])
+            return;
+    }
+
+    // Resolve world transforms in the main thread, so that the worker threads only read immutable data
+    ea::vector<PathAreaInfo> areas;
+    CollectPathAreas(areas_, areas);
+
+    FindPathBatch batch;
+    batch.queries_ = queries.data();
+    batch.results_ = results.data();
+    batch.threadPathData_ = threadPathData.data();
+    batch.defaultFilter_ = queryFilter_.get();
+    batch.transform_ = node_->GetWorldTransform();
+    batch.areas_ = &areas;
+
+    if (!threaded)
+    {
+        FindPathRange(batch, 0, queries.data(), queries.data() + count);
         return;
+    }
 
-    Vector3 actualLocalEnd = localEnd;
+    // Path lengths vary a lot, so use several small tasks per thread to balance the load
+    const unsigned maxTasks = numThreads * 4;
+    const unsigned numTasks = Min((count + MIN_PATH_QUERIES_PER_TASK - 1) / MIN_PATH_QUERIES_PER_TASK, maxTasks);
+    const unsigned taskSize = (count + numTasks - 1) / numTasks;
+    for (unsigned begin = 0; begin < count; begin += taskSize)
+    {
+        const unsigned taskEnd = Min(begin + taskSize, count);
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = FindPathsWork;
+        item->aux_ = &batch;
+        item->start_ = const_cast<NavigationPathQuery*>(queries.data() + begin);
+        item->end_ = const_cast<NavigationPathQuery*>(queries.data() + taskEnd);
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
 
-    // If full path was not found, clamp end point to the end polygon
-    if (pathData_->polys_[numPolys - 1] != endRef)
-        navMeshQuery_->closestPointOnPoly(pathData_->polys_[numPolys - 1], &localEnd.x_, &actualLocalEnd.x_, nullptr);
+unsigned NavigationMesh::RequestPath(const NavigationPathQuery& query, const NavigationPathCallback& callback)
+{
+    PathRequest request;
+    request.id_ = nextPathRequestId_++;
+    request.query_ = query;
+    request.callback_ = callback;
+    // Zero is never a valid request ID
+    if (!nextPathRequestId_)
+        nextPathRequestId_ = 1;
+
+    // Process the requests on scene update while there are any pending
+    if (pathRequests_.empty())
+    {
+        if (Scene* scene = GetScene())
+            SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(NavigationMesh, HandleSceneUpdate));
+    }
 
-    navMeshQuery_->findStraightPath(&localStart.x_, &actualLocalEnd.x_, pathData_->polys_, numPolys,
-        &pathData_->pathPoints_[0].x_, pathData_->pathFlags_, pathData_->pathPolys_, &numPathPoints, MAX_POLYS);
+    pathRequests_.push_back(ea::move(request));
+    return pathRequests_.back().id_;
+}
 
-    // Transform path result back to world space
-    for (int i = 0; i < numPathPoints; ++i)
+void NavigationMesh::CancelPathRequest(unsigned requestId)
+{
+    for (auto i = pathRequests_.begin(); i != pathRequests_.end(); ++i)
     {
-        NavigationPathPoint pt;
-        pt.position_ = transform * pathData_->pathPoints_[i];
-        pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
+        if (i->id_ == requestId)
+        {
+            pathRequests_.erase(i);
+            return;
+        }
+    }
+}
 
-        // Walk through all NavAreas and find nearest
-        unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
-        float nearestDistance = M_LARGE_VALUE;
-        for (unsigned j = 0; j < areas_.size(); j++)
+void NavigationMesh::UpdatePathRequests(unsigned maxIterations)
+{
+    URHO3D_PROFILE("UpdatePathRequests");
+
+    int remainingIterations = (int)Min(maxIterations, (unsigned)M_MAX_INT);
+    ea::vector<NavigationPathPoint> path;
+
+    while (remainingIterations > 0 && !pathRequests_.empty())
+    {
+        // Query may be released by a callback rebuilding the navigation mesh, so check it on each iteration
+        if (!InitializeQuery())
+            return;
+        FindPathData* data = GetOwnedPathData(asyncPathData_);
+        if (!data)
+            return;
+
+        PathRequest& request = pathRequests_.front();
+        bool finished = !request.started_ && !StartPathRequest(request, *data);
+        dtStatus status = DT_FAILURE;
+
+        if (!finished)
         {
-            NavArea* area = areas_[j];
-            if (area && area->IsEnabledEffective())
+            int numIterations = 0;
+            status = data->query_->updateSlicedFindPath(remainingIterations, &numIterations);
+            remainingIterations -= Max(numIterations, 1);
+            finished = !dtStatusInProgress(status);
+        }
+
+        if (!finished)
+            break;
+
+        path.clear();
+        if (dtStatusSucceed(status))
+        {
+            int numPolys = 0;
+            data->query_->finalizeSlicedFindPath(data->polys_, &numPolys, MAX_POLYS);
+            if (numPolys)
             {
-                BoundingBox bb = area->GetWorldBoundingBox();
-                if (bb.IsInside(pt.position_) == INSIDE)
-                {
-                    Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
-                    float distance = (areaWorldCenter - pt.position_).LengthSquared();
-                    if (distance < nearestDistance)
-                    {
-                        nearestDistance = distance;
-                        nearestNavAreaID = area->GetAreaID();
-                    }
-                }
+                ea::vector<PathAreaInfo> areas;
+                CollectPathAreas(areas_, areas);
+                BuildStraightPath(path, data->query_, *data, numPolys, request.endRef_, request.localStart_, request.localEnd_,
+                    node_->GetWorldTransform(), areas);
             }
         }
-        pt.areaID_ = (unsigned char)nearestNavAreaID;
 
-        dest.push_back(pt);
+        // Remove the request before invoking the callback, as it may add or cancel requests
+        NavigationPathCallback callback = ea::move(request.callback_);
+        pathRequests_.pop_front();
+        if (callback)
+            callback(path);
     }
 }
 
+void NavigationMesh::SetMaxPathIterations(unsigned iterations)
+{
+    maxPathIterations_ = Max(iterations, 1U);
+}
+
 Vector3 NavigationMesh::GetRandomPoint(const dtQueryFilter* filter, dtPolyRef* randomRef)
 {
     if (!InitializeQuery())
@@ -977,6 +1280,8 @@ void NavigationMesh::CollectGeometries(ea::vector<NavigationGeometryInfo>& geome
         if (connection->IsEnabledEffective() && connection->GetEndPoint())
         {
             const Matrix3x4& transform = connection->GetNode()->GetWorldTransform();
+            // Update the end point transform now, as tile geometry may be gathered in worker threads
+            connection->GetEndPoint()->GetWorldTransform();
 
             NavigationGeometryInfo info;
             info.component_ = connection;
@@ -1300,11 +1605,20 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
 }
 
 bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z)
+{
+    unsigned char* navData = nullptr;
+    int navDataSize = 0;
+    const bool success = BuildTileData(geometryList, x, z, navData, navDataSize);
+    return CommitTileData(x, z, navData, navDataSize) && success;
+}
+
+bool NavigationMesh::BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData,
+    int& navDataSize)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
 
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    navData = nullptr;
+    navDataSize = 0;
 
     const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
 
@@ -1462,9 +1776,6 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;       // NOLINT(hicpp-member-init)
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1504,9 +1815,22 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
     {
         URHO3D_LOGERROR("Could not build navigation mesh tile data");
+        navData = nullptr;
+        navDataSize = 0;
         return false;
     }
 
+    return true;
+}
+
+bool NavigationMesh::CommitTileData(int x, int z, unsigned char* navData, int navDataSize)
+{
+    // Remove previous tile (if any)
+    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+
+    if (!navData)
+        return true; // Nothing to do
+
     if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
@@ -1516,6 +1840,8 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
 
     // Send a notification of the rebuild of this tile to anyone interested
     {
+        const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -1529,17 +1855,141 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
 
 unsigned NavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
-
+    ea::vector<IntVector2> tiles;
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
+            tiles.emplace_back(x, z);
+    }
+    return BuildTiles(geometryList, tiles);
+}
+
+unsigned NavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const ea::vector<IntVector2>& tiles)
+{
+    URHO3D_PROFILE("BuildNavigationMeshTiles");
+
+    struct TileBuildResult
+    {
+        unsigned char* navData_{};
+        int navDataSize_{};
+        bool success_{};
+        unsigned geometryHash_{};
+    };
+
+    // Recast processing of the tiles is independent, so build the tile data in parallel and then add it to the
+    // navigation mesh in the main thread
+    ea::vector<TileBuildResult> results(tiles.size());
+    ProcessTiles(tiles.size(), [&](unsigned index)
+    {
+        const IntVector2& tile = tiles[index];
+        TileBuildResult& result = results[index];
+        result.success_ = BuildTileData(geometryList, tile.x_, tile.y_, result.navData_, result.navDataSize_);
+        result.geometryHash_ = GetTileGeometryHash(geometryList, tile);
+    });
+
+    unsigned numTiles = 0;
+    for (unsigned i = 0; i < tiles.size(); ++i)
+    {
+        const TileBuildResult& result = results[i];
+        if (CommitTileData(tiles[i].x_, tiles[i].y_, result.navData_, result.navDataSize_) && result.success_)
+            ++numTiles;
+        SetTileGeometryHash(tiles[i], result.geometryHash_);
+    }
+    return numTiles;
+}
+
+void NavigationMesh::ProcessTiles(unsigned numTiles, const ea::function<void(unsigned index)>& processTile) const
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    const bool threaded = numTiles > 1 && queue && queue->GetNumThreads() && !queue->IsCompleting() && Thread::IsMainThread();
+    if (!threaded)
+    {
+        for (unsigned i = 0; i < numTiles; ++i)
+            processTile(i);
+        return;
+    }
+
+    // Build times vary a lot between tiles, so queue each tile separately to balance the load
+    for (unsigned i = 0; i < numTiles; ++i)
+        queue->AddWorkItem([&processTile, i]() { processTile(i); }, M_MAX_UNSIGNED);
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+unsigned NavigationMesh::GetTileGeometryHash(const ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile) const
+{
+    // Same border as used when gathering the tile geometry
+    const float borderSize = (float)(CeilToInt(agentRadius_ / cellSize_) + 3) * cellSize_;
+    BoundingBox box = GetTileBoundingBox(tile);
+    box.min_ -= Vector3(borderSize, 0.0f, borderSize);
+    box.max_ += Vector3(borderSize, 0.0f, borderSize);
+
+    // Zero is reserved for unknown geometry
+    unsigned hash = 1;
+    for (const NavigationGeometryInfo& info : geometryList)
+    {
+        if (box.IsInsideFast(info.boundingBox_) == OUTSIDE)
+            continue;
+
+        CombineHash(hash, info.component_->GetID());
+        CombineHash(hash, info.lodLevel_);
+        for (unsigned i = 0; i < 12; ++i)
+            CombineHash(hash, MakeHash(info.transform_.Data()[i]));
+        CombineHash(hash, MakeHash(info.boundingBox_.min_));
+        CombineHash(hash, MakeHash(info.boundingBox_.max_));
+    }
+    return hash;
+}
+
+void NavigationMesh::GetTileGeometryHashes(const ea::vector<NavigationGeometryInfo>& geometryList, ea::vector<unsigned>& hashes) const
+{
+    const float borderSize = (float)(CeilToInt(agentRadius_ / cellSize_) + 3) * cellSize_;
+    const float tileEdgeLength = (float)tileSize_ * cellSize_;
+
+    // Zero is reserved for unknown geometry
+    hashes.clear();
+    hashes.resize((unsigned)(numTilesX_ * numTilesZ_), 1);
+
+    // Visit only the tiles near each geometry instead of testing all geometry against every tile.
+    // The exact test and the combine order are the same as in GetTileGeometryHash
+    for (const NavigationGeometryInfo& info : geometryList)
+    {
+        const Vector3 min = info.boundingBox_.min_ - boundingBox_.min_;
+        const Vector3 max = info.boundingBox_.max_ - boundingBox_.min_;
+        const int sx = Clamp(FloorToInt((min.x_ - borderSize) / tileEdgeLength) - 1, 0, numTilesX_);
+        const int sz = Clamp(FloorToInt((min.z_ - borderSize) / tileEdgeLength) - 1, 0, numTilesZ_);
+        const int ex = Clamp(FloorToInt((max.x_ + borderSize) / tileEdgeLength) + 1, -1, numTilesX_ - 1);
+        const int ez = Clamp(FloorToInt((max.z_ + borderSize) / tileEdgeLength) + 1, -1, numTilesZ_ - 1);
+
+        for (int z = sz; z <= ez; ++z)
         {
-            if (BuildTile(geometryList, x, z))
-                ++numTiles;
+            for (int x = sx; x <= ex; ++x)
+            {
+                BoundingBox box = GetTileBoundingBox(IntVector2(x, z));
+                box.min_ -= Vector3(borderSize, 0.0f, borderSize);
+                box.max_ += Vector3(borderSize, 0.0f, borderSize);
+                if (box.IsInsideFast(info.boundingBox_) == OUTSIDE)
+                    continue;
+
+                unsigned& hash = hashes[z * numTilesX_ + x];
+                CombineHash(hash, info.component_->GetID());
+                CombineHash(hash, info.lodLevel_);
+                for (unsigned i = 0; i < 12; ++i)
+                    CombineHash(hash, MakeHash(info.transform_.Data()[i]));
+                CombineHash(hash, MakeHash(info.boundingBox_.min_));
+                CombineHash(hash, MakeHash(info.boundingBox_.max_));
+            }
         }
     }
-    return numTiles;
+}
+
+void NavigationMesh::SetTileGeometryHash(const IntVector2& tile, unsigned hash)
+{
+    const unsigned numTiles = (unsigned)(numTilesX_ * numTilesZ_);
+    if (tileGeometryHashes_.size() != numTiles)
+        tileGeometryHashes_.resize(numTiles, 0);
+
+    if (tile.x_ >= 0 && tile.y_ >= 0 && tile.x_ < numTilesX_ && tile.y_ < numTilesZ_)
+        tileGeometryHashes_[tile.y_ * numTilesX_ + tile.x_] = hash;
 }
 
 bool NavigationMesh::InitializeQuery()
@@ -1577,6 +2027,71 @@ void NavigationMesh::ReleaseNavigationMesh()
     numTilesX_ = 0;
     numTilesZ_ = 0;
     boundingBox_.Clear();
+    tileGeometryHashes_.clear();
+
+    // Queries are bound to the released navigation mesh, restart the pending path requests on the next one
+    threadPathData_.clear();
+    asyncPathData_.reset();
+    for (PathRequest& request : pathRequests_)
+        request.started_ = false;
+}
+
+FindPathData* NavigationMesh::GetOwnedPathData(ea::unique_ptr<FindPathData>& pathData)
+{
+    if (pathData)
+        return pathData.get();
+
+    auto newPathData = ea::make_unique<FindPathData>();
+    newPathData->query_ = dtAllocNavMeshQuery();
+    if (!newPathData->query_ || dtStatusFailed(newPathData->query_->init(navMesh_, MAX_POLYS)))
+    {
+        URHO3D_LOGERROR("Could not init navigation mesh query");
+        return nullptr;
+    }
+
+    pathData = ea::move(newPathData);
+    return pathData.get();
+}
+
+bool NavigationMesh::StartPathRequest(PathRequest& request, FindPathData& pathData)
+{
+    const NavigationPathQuery& query = request.query_;
+    const dtQueryFilter* queryFilter = query.filter_ ? query.filter_ : queryFilter_.get();
+
+    // Navigation data is in local space. Transform path points from world to local
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+    request.localStart_ = inverse * query.start_;
+    request.localEnd_ = inverse * query.end_;
+
+    dtPolyRef startRef;
+    pathData.query_->findNearestPoly(&request.localStart_.x_, &query.extents_.x_, queryFilter, &startRef, nullptr);
+    pathData.query_->findNearestPoly(&request.localEnd_.x_, &query.extents_.x_, queryFilter, &request.endRef_, nullptr);
+
+    if (!startRef || !request.endRef_)
+        return false;
+
+    if (dtStatusFailed(pathData.query_->initSlicedFindPath(startRef, request.endRef_, &request.localStart_.x_,
+        &request.localEnd_.x_, queryFilter)))
+        return false;
+
+    request.started_ = true;
+    return true;
+}
+
+void NavigationMesh::OnSceneSet(Scene* scene)
+{
+    // Path requests may have been made before the scene was assigned, or the component may have moved to another scene
+    UnsubscribeFromEvent(E_SCENEUPDATE);
+    if (scene && !pathRequests_.empty())
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(NavigationMesh, HandleSceneUpdate));
+}
+
+void NavigationMesh::HandleSceneUpdate(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    UpdatePathRequests(maxPathIterations_);
+
+    if (pathRequests_.empty())
+        UnsubscribeFromEvent(E_SCENEUPDATE);
 }
 
 void NavigationMesh::SetPartitionType(NavmeshPartitionType partitionType)
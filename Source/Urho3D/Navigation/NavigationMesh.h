@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include <EASTL/functional.h>
+#include <EASTL/list.h>
+#include <EASTL/span.h>
 #include <EASTL/unique_ptr.h>
 
 #include "../Math/BoundingBox.h"
@@ -61,7 +64,7 @@ struct NavigationGeometryInfo
     /// Component.
     Component* component_;
     /// Geometry LOD level if applicable.
-    unsigned lodLevel_;
+    unsigned lodLevel_{};
     /// Transform relative to the navigation mesh root node.
     Matrix3x4 transform_;
     /// Bounding box relative to the navigation mesh root node.
@@ -88,6 +91,22 @@ struct URHO3D_API NavigationPathPoint
     unsigned char areaID_;
 };
 
+/// Path query for batched and asynchronous pathfinding.
+struct URHO3D_API NavigationPathQuery
+{
+    /// World-space start point.
+    Vector3 start_;
+    /// World-space end point.
+    Vector3 end_;
+    /// How far off the navigation mesh the points can be.
+    Vector3 extents_{Vector3::ONE};
+    /// Query filter. Default filter of the navigation mesh is used if null.
+    const dtQueryFilter* filter_{};
+};
+
+/// Callback invoked when an asynchronous path request is finished. Path is empty if no path was found.
+using NavigationPathCallback = ea::function<void(const ea::vector<NavigationPathPoint>& path)>;
+
 /// Navigation mesh component. Collects the navigation geometry from child nodes with the Navigable component and responds to path queries.
 class URHO3D_API NavigationMesh : public Component
 {
@@ -158,6 +177,8 @@ public:
     virtual bool Build(const BoundingBox& boundingBox);
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     virtual bool Build(const IntVector2& from, const IntVector2& to);
+    /// Rebuild only the tiles whose navigable geometry changed since they were last built. Geometry is compared by component, transform and bounds. Return true if successful.
+    bool BuildChangedTiles();
     /// Return tile data.
     virtual ea::vector<unsigned char> GetTileData(const IntVector2& tile) const;
     /// Add tile to navigation mesh.
@@ -185,6 +206,14 @@ public:
     void FindPath
         (ea::vector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
             const dtQueryFilter* filter = nullptr);
+    /// Find paths for a batch of queries. Queries are processed in worker threads if possible. Each result is a non-empty list of navigation path points if successful.
+    void FindPaths(ea::vector<ea::vector<NavigationPathPoint>>& results, ea::span<const NavigationPathQuery> queries);
+    /// Request a path to be found asynchronously. Pending requests are processed with sliced pathfinding during scene update and the callback is invoked from the main thread. Query filter must stay alive until the request is finished. Return request ID.
+    unsigned RequestPath(const NavigationPathQuery& query, const NavigationPathCallback& callback);
+    /// Cancel a pending asynchronous path request. The callback will not be invoked.
+    void CancelPathRequest(unsigned requestId);
+    /// Process pending asynchronous path requests for at most the given number of pathfinding iterations. Called automatically on scene update.
+    void UpdatePathRequests(unsigned maxIterations);
     /// Return a random point on the navigation mesh.
     Vector3 GetRandomPoint(const dtQueryFilter* filter = nullptr, dtPolyRef* randomRef = nullptr);
     /// Return a random point on the navigation mesh within a circle. The circle radius is only a guideline and in practice the returned point may be further away.
@@ -283,6 +312,19 @@ public:
     /// @property
     IntVector2 GetNumTiles() const { return IntVector2(numTilesX_, numTilesZ_); }
 
+    /// Set maximum number of sliced pathfinding iterations per scene update spent on asynchronous path requests. Runtime
+    /// only, not serialized, because DynamicNavigationMesh appends its own attributes after the copied base attributes.
+    /// @property
+    void SetMaxPathIterations(unsigned iterations);
+
+    /// Return maximum number of sliced pathfinding iterations per scene update.
+    /// @property
+    unsigned GetMaxPathIterations() const { return maxPathIterations_; }
+
+    /// Return number of pending asynchronous path requests.
+    /// @property
+    unsigned GetNumPathRequests() const { return pathRequests_.size(); }
+
     /// Set the partition type used for polygon generation.
     /// @property
     void SetPartitionType(NavmeshPartitionType partitionType);
@@ -313,12 +355,39 @@ public:
     bool GetDrawNavAreas() const { return drawNavAreas_; }
 
 private:
+    /// Pending asynchronous path request.
+    struct PathRequest
+    {
+        /// Request ID.
+        unsigned id_{};
+        /// Path query.
+        NavigationPathQuery query_;
+        /// Completion callback.
+        NavigationPathCallback callback_;
+        /// Whether sliced pathfinding has been initialized.
+        bool started_{};
+        /// Local space start point.
+        Vector3 localStart_;
+        /// Local space end point.
+        Vector3 localEnd_;
+        /// End polygon.
+        dtPolyRef endRef_{};
+    };
+
     /// Write tile data.
     void WriteTile(Serializer& dest, int x, int z) const;
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Return pathfinding data with a navigation mesh query of its own, creating it if necessary. Return null on failure.
+    FindPathData* GetOwnedPathData(ea::unique_ptr<FindPathData>& pathData);
+    /// Initialize sliced pathfinding for a request. Return true if successful.
+    bool StartPathRequest(PathRequest& request, FindPathData& pathData);
+    /// Handle scene update to process asynchronous path requests.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
 
 protected:
+    /// Handle scene being assigned. Resubscribe to scene update if path requests are pending.
+    void OnSceneSet(Scene* scene) override;
     /// Collect geometry from under Navigable components.
     void CollectGeometries(ea::vector<NavigationGeometryInfo>& geometryList);
     /// Visit nodes and collect navigable geometry.
@@ -329,8 +398,22 @@ protected:
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
     /// Build one tile of the navigation mesh. Return true if successful.
     virtual bool BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Build navigation data of one tile without modifying the navigation mesh. Safe to call from worker threads. Empty tiles produce no data. Return true if successful.
+    bool BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData, int& navDataSize);
+    /// Replace tile in the navigation mesh with built data and send notification. Takes ownership of the data. Return true if successful.
+    bool CommitTileData(int x, int z, unsigned char* navData, int navDataSize);
     /// Build tiles in the rectangular area. Return number of built tiles.
     unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Build tiles in the list. Tile data is built in worker threads if possible. Return number of built tiles.
+    virtual unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const ea::vector<IntVector2>& tiles);
+    /// Call function for each tile index, in worker threads if called from the main thread and worker threads are available.
+    void ProcessTiles(unsigned numTiles, const ea::function<void(unsigned index)>& processTile) const;
+    /// Return hash of the geometry that affects the tile.
+    unsigned GetTileGeometryHash(const ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile) const;
+    /// Return hashes of the geometry that affects each tile, indexed by z * numTilesX + x. Equal to GetTileGeometryHash for every tile.
+    void GetTileGeometryHashes(const ea::vector<NavigationGeometryInfo>& geometryList, ea::vector<unsigned>& hashes) const;
+    /// Remember hash of the geometry the tile was built from.
+    void SetTileGeometryHash(const IntVector2& tile, unsigned hash);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
@@ -390,6 +473,18 @@ protected:
     bool drawNavAreas_;
     /// NavAreas for this NavMesh.
     ea::vector<WeakPtr<NavArea> > areas_;
+    /// Hashes of the geometry each tile was built from. Zero if unknown.
+    ea::vector<unsigned> tileGeometryHashes_;
+    /// Per-thread pathfinding data for batched path queries.
+    ea::vector<ea::unique_ptr<FindPathData>> threadPathData_;
+    /// Pathfinding data for asynchronous path requests.
+    ea::unique_ptr<FindPathData> asyncPathData_;
+    /// Pending asynchronous path requests.
+    ea::list<PathRequest> pathRequests_;
+    /// Next asynchronous path request ID.
+    unsigned nextPathRequestId_{1};
+    /// Maximum number of sliced pathfinding iterations per scene update.
+    unsigned maxPathIterations_;
 };
 
 /// Register Navigation library objects.
@@ -39,6 +39,7 @@
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SmoothedTransform.h"
 
+#include <LZ4/lz4.h>
 #include <slikenet/MessageIdentifiers.h>
 #include <slikenet/peerinterface.h>
 #include <slikenet/statistics.h>
@@ -57,6 +58,16 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+/// Interest scope leave radius relative to the enter radius, to avoid nodes at the scope border repeatedly entering and leaving.
+static const float INTEREST_LEAVE_FACTOR = 1.1f;
+
+/// Return the top-level ancestor of a node, i.e. the ancestor that is a direct child of the scene.
+static Node* GetTopLevelNode(Node* node, Scene* scene)
+{
+    while (node && node->GetParent() != scene)
+        node = node->GetParent();
+    return node;
+}
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
@@ -76,12 +87,20 @@ Connection::Connection(Context* context) :
     timeStamp_(0),
     peer_(nullptr),
     sendMode_(OPSM_NONE),
+    interestRadius_(0.0f),
     isClient_(false),
     connectPending_(false),
     sceneLoaded_(false),
     logStatistics_(false),
     address_(nullptr),
-    packedMessageLimit_(1024)
+    packedMessageLimit_(1024),
+    packetCompression_(true),
+    snapshotReplication_(false),
+    snapshotHistory_(SNAPSHOT_HISTORY_SIZE),
+    snapshotReceived_(0),
+    snapshotPartsReceived_(0),
+    snapshotNumParts_(0),
+    snapshotAck_(0)
 {
 }
 
@@ -149,8 +168,8 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         buffer.WriteUInt((unsigned int)MSG_PACKED_MESSAGE);
     }
 
-    buffer.WriteUInt((unsigned int) msgID);
-    buffer.WriteUInt(numBytes);
+    buffer.WriteVLE((unsigned)msgID);
+    buffer.WriteVLE(numBytes);
     buffer.Write(data, numBytes);
 }
 
@@ -200,6 +219,8 @@ void Connection::SetScene(Scene* newScene)
 
     scene_ = newScene;
     sceneLoaded_ = false;
+    scopeNodes_.clear();
+    snapshotHistory_.Clear();
     UnsubscribeFromEvent(E_ASYNCLOADFINISHED);
 
     if (!scene_)
@@ -249,6 +270,39 @@ void Connection::SetPosition(const Vector3& position)
         sendMode_ = OPSM_POSITION;
 }
 
+void Connection::SetInterestRadius(float radius)
+{
+    radius = Max(radius, 0.0f);
+    if (radius == interestRadius_)
+        return;
+
+    const bool wasEnabled = interestRadius_ > 0.0f;
+    interestRadius_ = radius;
+    if (!scene_ || wasEnabled == (radius > 0.0f))
+        return;
+
+    if (radius > 0.0f)
+    {
+        // Nodes already sent to the client start in scope, and leave it on the next update if they are too far
+        for (Node* node : scene_->GetChildren())
+        {
+            if (sceneState_.nodeStates_.contains(node->GetID()))
+                scopeNodes_.insert(node->GetID());
+        }
+    }
+    else
+    {
+        // Send all replicated nodes that were left out of the scope
+        scopeNodes_.clear();
+        scene_->GetChildren(interestNodes_, true);
+        for (Node* node : interestNodes_)
+        {
+            if (node->IsReplicated())
+                sceneState_.dirtyNodes_.insert(node->GetID());
+        }
+    }
+}
+
 void Connection::SetRotation(const Quaternion& rotation)
 {
     rotation_ = rotation;
@@ -283,7 +337,52 @@ void Connection::SendServerUpdate()
     ProcessNode(sceneID);
 
     // Then go through all dirtied nodes
-    nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
+    if (interestRadius_ > 0.0f)
+    {
+        URHO3D_PROFILE("FilterInterestScope");
+
+        if (InterestGrid* grid = GetSubsystem<Network>()->GetInterestGrid(scene_))
+            UpdateInterestScope(grid);
+
+        // Nodes known to the client are always processed to send their updates or removal. Other dirty nodes are sent
+        // only if their top-level node is in scope, and are otherwise forgotten until it enters the scope. Nodes owned
+        // by this connection are always in scope
+        interestQuery_.clear();
+        for (auto i = sceneState_.dirtyNodes_.begin(); i != sceneState_.dirtyNodes_.end();)
+        {
+            const unsigned nodeID = *i;
+            if (sceneState_.nodeStates_.contains(nodeID))
+            {
+                nodesToProcess_.insert(nodeID);
+                ++i;
+                continue;
+            }
+
+            Node* topLevelNode = GetTopLevelNode(scene_->GetNode(nodeID), scene_);
+            if (topLevelNode && scopeNodes_.contains(topLevelNode->GetID()))
+            {
+                nodesToProcess_.insert(nodeID);
+                ++i;
+            }
+            else
+            {
+                if (topLevelNode && topLevelNode->GetOwner() == this)
+                    interestQuery_.push_back(topLevelNode->GetID());
+                i = sceneState_.dirtyNodes_.erase(i);
+            }
+        }
+
+        for (unsigned nodeID : interestQuery_)
+        {
+            if (!scopeNodes_.contains(nodeID))
+            {
+                EnterInterestScope(scene_->GetNode(nodeID));
+                nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
+            }
+        }
+    }
+    else
+        nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
     nodesToProcess_.erase(sceneID); // Do not process the root node twice
 
     while (nodesToProcess_.size())
@@ -291,6 +390,9 @@ void Connection::SendServerUpdate()
         unsigned nodeID = *nodesToProcess_.begin();
         ProcessNode(nodeID);
     }
+
+    if (snapshotReplication_)
+        SendSnapshot();
 }
 
 void Connection::SendClientUpdate()
@@ -310,6 +412,14 @@ void Connection::SendClientUpdate()
         msg_.WritePackedQuaternion(rotation_);
     SendMessage(MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
 
+    // Acknowledge the newest snapshot every update, as the acknowledgement itself may be lost
+    if (snapshotAck_)
+    {
+        msg_.Clear();
+        msg_.WriteVLE(snapshotAck_);
+        SendMessage(MSG_SNAPSHOTACK, false, false, msg_);
+    }
+
     ++timeStamp_;
 }
 
@@ -406,8 +516,31 @@ void Connection::SendBuffer(PacketType type)
     if (type == PT_RELIABLE_UNORDERED)
         reliability = PacketReliability::RELIABLE;
 
+    // Packet header: RakNet user packet ID followed by the packed message ID
+    static const unsigned headerSize = sizeof(unsigned char) + sizeof(unsigned);
+    const VectorBuffer* packet = &buffer;
+    if (packetCompression_ && buffer.GetSize() >= headerSize + PACKET_COMPRESSION_THRESHOLD)
+    {
+        const unsigned payloadSize = buffer.GetSize() - headerSize;
+        // Use fast LZ4 rather than the HC mode of CompressData(), as this runs for every packet
+        compressBuffer_.resize((unsigned)LZ4_compressBound(payloadSize));
+        const int compressedSize = LZ4_compress_default((const char*)buffer.GetData() + headerSize, (char*)compressBuffer_.data(),
+            payloadSize, compressBuffer_.size());
+
+        // Send compressed only if it actually saves bandwidth, including the size prefix
+        if (compressedSize > 0 && compressedSize + sizeof(unsigned) < payloadSize)
+        {
+            compressedPacket_.Clear();
+            compressedPacket_.WriteUByte((unsigned char)DefaultMessageIDTypes::ID_USER_PACKET_ENUM);
+            compressedPacket_.WriteUInt((unsigned)MSG_PACKED_MESSAGE_COMPRESSED);
+            compressedPacket_.WriteVLE(payloadSize);
+            compressedPacket_.Write(compressBuffer_.data(), compressedSize);
+            packet = &compressedPacket_;
+        }
+    }
+
     if (peer_) {
-        peer_->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, reliability, (char) 0,
+        peer_->Send((const char *) packet->GetData(), (int) packet->GetSize(), HIGH_PRIORITY, reliability, (char) 0,
                     *address_, false);
         tempPacketCounter_.y_++;
     }
@@ -466,15 +599,50 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
     if (buffer.GetSize() == 0)
         return false;
 
+    if (msgID == MSG_PACKED_MESSAGE_COMPRESSED)
+    {
+        const unsigned uncompressedSize = buffer.ReadVLE();
+        if (!uncompressedSize || uncompressedSize > MAX_DECOMPRESSED_PACKET_SIZE)
+        {
+            URHO3D_LOGERROR("Invalid compressed packet size " + ea::to_string(uncompressedSize));
+            return true;
+        }
+
+        // Decompress into a buffer of its own, as processing the messages may send new ones
+        decompressBuffer_.resize(uncompressedSize);
+        const int compressedSize = buffer.GetSize() - buffer.GetPosition();
+        if (LZ4_decompress_safe((const char*)buffer.GetData() + buffer.GetPosition(), (char*)decompressBuffer_.data(),
+            compressedSize, uncompressedSize) != (int)uncompressedSize)
+        {
+            URHO3D_LOGERROR("Failed to decompress packet");
+            return true;
+        }
+
+        MemoryBuffer uncompressedBuffer(decompressBuffer_);
+        ProcessPackedMessage(uncompressedBuffer);
+        return true;
+    }
+
     if (msgID != MSG_PACKED_MESSAGE)
     {
         ProcessUnknownMessage(msgID, buffer);
         return true;
     }
 
+    ProcessPackedMessage(buffer);
+    return true;
+}
+
+void Connection::ProcessPackedMessage(MemoryBuffer& buffer)
+{
     while (!buffer.IsEof()) {
-        msgID = buffer.ReadUInt();
-        unsigned int packetSize = buffer.ReadUInt();
+        int msgID = (int)buffer.ReadVLE();
+        unsigned int packetSize = buffer.ReadVLE();
+        if (packetSize > buffer.GetSize() - buffer.GetPosition())
+        {
+            URHO3D_LOGERROR("Malformed packed message");
+            break;
+        }
         MemoryBuffer msg(buffer.GetData() + buffer.GetPosition(), packetSize);
         buffer.Seek(buffer.GetPosition() + packetSize);
 
@@ -488,6 +656,10 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
                 ProcessControls(msgID, msg);
                 break;
 
+            case MSG_SNAPSHOTACK:
+                ProcessSnapshotAck(msgID, msg);
+                break;
+
             case MSG_SCENELOADED:
                 ProcessSceneLoaded(msgID, msg);
                 break;
@@ -513,6 +685,7 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
             case MSG_COMPONENTDELTAUPDATE:
             case MSG_COMPONENTLATESTDATA:
             case MSG_REMOVECOMPONENT:
+            case MSG_SNAPSHOT:
                 ProcessSceneUpdate(msgID, msg);
                 break;
 
@@ -529,7 +702,6 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
                 break;
         }
     }
-    return true;
 }
 
 void Connection::Ban()
@@ -698,23 +870,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
         break;
 
     case MSG_NODELATESTDATA:
-        {
-            unsigned nodeID = msg.ReadNetID();
-            Node* node = scene_->GetNode(nodeID);
-            if (node)
-            {
-                node->ReadLatestDataUpdate(msg);
-                // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
-                // Furthermore it would propagate to components and child nodes, which is not desired in this case
-            }
-            else
-            {
-                // Latest data messages may be received out-of-order relative to node creation, so cache if necessary
-                ea::vector<unsigned char>& data = nodeLatestData_[nodeID];
-                data.resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
-            }
-        }
+        ProcessNodeLatestData(msg);
         break;
 
     case MSG_REMOVENODE:
@@ -776,22 +932,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
         break;
 
     case MSG_COMPONENTLATESTDATA:
-        {
-            unsigned componentID = msg.ReadNetID();
-            Component* component = scene_->GetComponent(componentID);
-            if (component)
-            {
-                if (component->ReadLatestDataUpdate(msg))
-                    component->ApplyAttributes();
-            }
-            else
-            {
-                // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
-                ea::vector<unsigned char>& data = componentLatestData_[componentID];
-                data.resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
-            }
-        }
+        ProcessComponentLatestData(msg);
         break;
 
     case MSG_REMOVECOMPONENT:
@@ -804,10 +945,95 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
         }
         break;
 
+    case MSG_SNAPSHOT:
+        ProcessSnapshot(msg);
+        break;
+
     default: break;
     }
 }
 
+void Connection::ProcessSnapshot(MemoryBuffer& msg)
+{
+    const unsigned sequence = msg.ReadVLE();
+    msg.ReadVLE(); // Baseline, not needed to apply the entries
+    const unsigned part = msg.ReadVLE();
+    const bool last = msg.ReadBool();
+    unsigned numEntries = msg.ReadVLE();
+
+    // Parts of older snapshots would overwrite newer data
+    if (sequence < snapshotReceived_)
+        return;
+    if (sequence > snapshotReceived_)
+    {
+        snapshotReceived_ = sequence;
+        snapshotPartsReceived_ = 0;
+        snapshotNumParts_ = 0;
+    }
+
+    while (numEntries--)
+    {
+        const bool isComponent = msg.ReadBool();
+        const unsigned size = msg.ReadVLE();
+        if (size > msg.GetSize() - msg.GetPosition())
+        {
+            URHO3D_LOGERROR("Malformed snapshot from server " + ToString());
+            return;
+        }
+
+        MemoryBuffer entry(msg.GetData() + msg.GetPosition(), size);
+        if (isComponent)
+            ProcessComponentLatestData(entry);
+        else
+            ProcessNodeLatestData(entry);
+        msg.Seek(msg.GetPosition() + size);
+    }
+
+    // Acknowledge the snapshot once all of its parts have been applied
+    ++snapshotPartsReceived_;
+    if (last)
+        snapshotNumParts_ = part + 1;
+    if (snapshotNumParts_ && snapshotPartsReceived_ == snapshotNumParts_)
+        snapshotAck_ = sequence;
+}
+
+void Connection::ProcessNodeLatestData(MemoryBuffer& msg)
+{
+    unsigned nodeID = msg.ReadNetID();
+    Node* node = scene_->GetNode(nodeID);
+    if (node)
+    {
+        node->ReadLatestDataUpdate(msg);
+        // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
+        // Furthermore it would propagate to components and child nodes, which is not desired in this case
+    }
+    else
+    {
+        // Latest data messages may be received out-of-order relative to node creation, so cache if necessary
+        ea::vector<unsigned char>& data = nodeLatestData_[nodeID];
+        data.resize(msg.GetSize());
+        memcpy(&data[0], msg.GetData(), msg.GetSize());
+    }
+}
+
+void Connection::ProcessComponentLatestData(MemoryBuffer& msg)
+{
+    unsigned componentID = msg.ReadNetID();
+    Component* component = scene_->GetComponent(componentID);
+    if (component)
+    {
+        if (component->ReadLatestDataUpdate(msg))
+            component->ApplyAttributes();
+    }
+    else
+    {
+        // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
+        ea::vector<unsigned char>& data = componentLatestData_[componentID];
+        data.resize(msg.GetSize());
+        memcpy(&data[0], msg.GetData(), msg.GetSize());
+    }
+}
+
 void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
 {
     switch (msgID)
@@ -995,6 +1221,17 @@ void Connection::ProcessControls(int msgID, MemoryBuffer& msg)
         rotation_ = msg.ReadPackedQuaternion();
 }
 
+void Connection::ProcessSnapshotAck(int msgID, MemoryBuffer& msg)
+{
+    if (!IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected SnapshotAck message from server");
+        return;
+    }
+
+    snapshotHistory_.Acknowledge(msg.ReadVLE());
+}
+
 void Connection::ProcessSceneLoaded(int msgID, MemoryBuffer& msg)
 {
     if (!IsClient())
@@ -1201,6 +1438,20 @@ void Connection::SetPacketSizeLimit(int limit)
     packedMessageLimit_ = limit;
 }
 
+void Connection::SetPacketCompression(bool enable)
+{
+    packetCompression_ = enable;
+}
+
+void Connection::SetSnapshotReplication(bool enable)
+{
+    if (enable != snapshotReplication_)
+    {
+        snapshotReplication_ = enable;
+        snapshotHistory_.Clear();
+    }
+}
+
 void Connection::HandleAsyncLoadFinished(StringHash eventType, VariantMap& eventData)
 {
     sceneLoaded_ = true;
@@ -1234,6 +1485,7 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
+            RemoveSnapshotEntries(nodeID, i->second);
             sceneState_.nodeStates_.erase(nodeID);
         }
         else
@@ -1356,7 +1608,10 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(node->GetID());
             node->WriteLatestDataUpdate(msg_, timeStamp_);
 
-            SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
+            if (snapshotReplication_)
+                snapshotHistory_.SetEntry(SnapshotHistory::GetNodeKey(node->GetID()), msg_.GetData(), msg_.GetSize());
+            else
+                SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
         }
 
         // Send deltaupdate if remaining dirty bits, or vars have changed
@@ -1407,6 +1662,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(current->first);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
+            snapshotHistory_.RemoveEntry(SnapshotHistory::GetComponentKey(current->first));
             nodeState.componentStates_.erase(current);
         }
         else
@@ -1434,7 +1690,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     msg_.WriteNetID(component->GetID());
                     component->WriteLatestDataUpdate(msg_, timeStamp_);
 
-                    SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
+                    if (snapshotReplication_)
+                    {
+                        snapshotHistory_.SetEntry(SnapshotHistory::GetComponentKey(component->GetID()), msg_.GetData(),
+                            msg_.GetSize());
+                    }
+                    else
+                        SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
                 }
 
                 // Send deltaupdate if remaining dirty bits
@@ -1645,6 +1907,164 @@ void Connection::OnPackagesReady()
     }
 }
 
+void Connection::SendSnapshot()
+{
+    URHO3D_PROFILE("SendSnapshot");
+
+    const unsigned sequence = snapshotHistory_.Commit();
+    const unsigned baseline = snapshotHistory_.GetDelta(snapshotKeys_) ? snapshotHistory_.GetAckedSequence() : 0;
+
+    // Nothing changed since the acknowledged snapshot: the client is already up to date with this one
+    if (snapshotKeys_.empty())
+    {
+        snapshotHistory_.Acknowledge(sequence);
+        return;
+    }
+
+    // Split into parts that fit in a packet, as the transport would send larger unreliable messages reliably.
+    // A single entry larger than the part size is still sent alone in its own part
+    unsigned part = 0;
+    unsigned numEntries = 0;
+    snapshotPart_.Clear();
+    for (unsigned key : snapshotKeys_)
+    {
+        const ea::vector<unsigned char>& data = *snapshotHistory_.GetEntry(key);
+        const unsigned dataSize = data.size();
+        const unsigned sizeBytes = dataSize < 0x80 ? 1 : dataSize < 0x4000 ? 2 : dataSize < 0x200000 ? 3 : 4;
+        const unsigned entrySize = 1 + sizeBytes + dataSize;
+        if (numEntries && snapshotPart_.GetSize() + entrySize > SNAPSHOT_PART_SIZE)
+        {
+            SendSnapshotPart(sequence, baseline, part++, false, numEntries);
+            numEntries = 0;
+            snapshotPart_.Clear();
+        }
+
+        snapshotPart_.WriteBool(SnapshotHistory::IsComponentKey(key));
+        snapshotPart_.WriteVLE(dataSize);
+        snapshotPart_.Write(data.data(), dataSize);
+        ++numEntries;
+    }
+
+    SendSnapshotPart(sequence, baseline, part, true, numEntries);
+}
+
+void Connection::SendSnapshotPart(unsigned sequence, unsigned baseline, unsigned part, bool last, unsigned numEntries)
+{
+    msg_.Clear();
+    msg_.WriteVLE(sequence);
+    msg_.WriteVLE(baseline);
+    msg_.WriteVLE(part);
+    msg_.WriteBool(last);
+    msg_.WriteVLE(numEntries);
+    msg_.Write(snapshotPart_.GetData(), snapshotPart_.GetSize());
+    SendMessage(MSG_SNAPSHOT, false, false, msg_);
+}
+
+void Connection::RemoveSnapshotEntries(unsigned nodeID, const NodeReplicationState& nodeState)
+{
+    snapshotHistory_.RemoveEntry(SnapshotHistory::GetNodeKey(nodeID));
+    for (const auto& componentState : nodeState.componentStates_)
+        snapshotHistory_.RemoveEntry(SnapshotHistory::GetComponentKey(componentState.first));
+}
+
+void Connection::UpdateInterestScope(InterestGrid* grid)
+{
+    grid->Query(position_, interestRadius_, interestQuery_);
+    for (unsigned nodeID : interestQuery_)
+    {
+        if (!scopeNodes_.contains(nodeID))
+        {
+            if (Node* node = scene_->GetNode(nodeID))
+                EnterInterestScope(node);
+        }
+    }
+
+    // Find the nodes that went out of scope. Removed nodes are sent as removed by ProcessNode(), and reparented nodes
+    // remain known to the client
+    const float leaveRadius = interestRadius_ * INTEREST_LEAVE_FACTOR;
+    const float leaveRadiusSquared = leaveRadius * leaveRadius;
+    interestQuery_.clear();
+    for (auto i = scopeNodes_.begin(); i != scopeNodes_.end();)
+    {
+        Node* node = scene_->GetNode(*i);
+        if (!node || node->GetParent() != scene_)
+        {
+            i = scopeNodes_.erase(i);
+            continue;
+        }
+
+        if (node->GetOwner() != this && (node->GetWorldPosition() - position_).LengthSquared() > leaveRadiusSquared)
+            interestQuery_.push_back(*i);
+        ++i;
+    }
+
+    for (unsigned nodeID : interestQuery_)
+        LeaveInterestScope(scene_->GetNode(nodeID));
+}
+
+void Connection::EnterInterestScope(Node* node)
+{
+    const unsigned nodeID = node->GetID();
+    scopeNodes_.insert(nodeID);
+    sceneState_.dirtyNodes_.insert(nodeID);
+
+    node->GetChildren(interestNodes_, true);
+    for (Node* child : interestNodes_)
+    {
+        if (child->IsReplicated())
+            sceneState_.dirtyNodes_.insert(child->GetID());
+    }
+
+    using namespace NodeEnteredScope;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_CONNECTION] = this;
+    eventData[P_NODE] = node;
+    SendEvent(E_NODEENTEREDSCOPE, eventData);
+}
+
+void Connection::LeaveInterestScope(Node* node)
+{
+    const unsigned nodeID = node->GetID();
+    scopeNodes_.erase(nodeID);
+
+    // Removing the top-level node on the client removes its children too
+    msg_.Clear();
+    msg_.WriteNetID(nodeID);
+    SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+    // Forget the replication states so that the node hierarchy is sent in full if it enters the scope again
+    node->GetChildren(interestNodes_, true);
+    interestNodes_.push_back(node);
+    for (Node* child : interestNodes_)
+    {
+        const unsigned childID = child->GetID();
+        auto i = sceneState_.nodeStates_.find(childID);
+        if (i != sceneState_.nodeStates_.end())
+        {
+            NodeReplicationState& nodeState = i->second;
+            for (auto& componentState : nodeState.componentStates_)
+            {
+                if (componentState.second.component_)
+                    componentState.second.component_->RemoveReplicationState(&componentState.second);
+            }
+            child->RemoveReplicationState(&nodeState);
+            RemoveSnapshotEntries(childID, nodeState);
+            sceneState_.nodeStates_.erase(i);
+        }
+
+        sceneState_.dirtyNodes_.erase(childID);
+        nodesToProcess_.erase(childID);
+    }
+
+    using namespace NodeLeftScope;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_CONNECTION] = this;
+    eventData[P_NODE] = node;
+    SendEvent(E_NODELEFTSCOPE, eventData);
+}
+
 void Connection::ProcessPackageInfo(int msgID, MemoryBuffer& msg)
 {
     if (!scene_)
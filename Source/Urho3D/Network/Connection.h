@@ -30,6 +30,7 @@
 #include "../Core/Timer.h"
 #include "../Input/Controls.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/SnapshotHistory.h"
 #include "../Scene/ReplicationState.h"
 
 namespace SLNet
@@ -46,6 +47,7 @@ namespace Urho3D
 {
 
 class File;
+class InterestGrid;
 class MemoryBuffer;
 class Node;
 class Scene;
@@ -151,6 +153,9 @@ public:
     /// Set the observer position for interest management, to be sent to the server.
     /// @property
     void SetPosition(const Vector3& position);
+    /// Set radius around the observer position within which top-level replicated nodes and their children are sent to the client. Zero (default) sends all replicated nodes.
+    /// @property
+    void SetInterestRadius(float radius);
     /// Set the observer rotation for interest management, to be sent to the server. Note: not used by the NetworkPriority component.
     /// @property
     void SetRotation(const Quaternion& rotation);
@@ -199,6 +204,11 @@ public:
     /// Return the observer position sent by the client for interest management.
     /// @property
     const Vector3& GetPosition() const { return position_; }
+    /// Return interest management radius.
+    /// @property
+    float GetInterestRadius() const { return interestRadius_; }
+    /// Return number of top-level replicated nodes currently in the interest scope.
+    unsigned GetNumNodesInScope() const { return scopeNodes_.size(); }
 
     /// Return the observer rotation sent by the client for interest management.
     /// @property
@@ -274,6 +284,14 @@ public:
     void ConfigureNetworkSimulator(int latencyMs, float packetLoss);
     /// Buffered packet size limit, when reached, packet is sent out immediately
     void SetPacketSizeLimit(int limit);
+    /// Set whether to compress large outgoing packets. Compressed packets are always accepted. Called by Network.
+    void SetPacketCompression(bool enable);
+    /// Return whether large outgoing packets are compressed.
+    bool GetPacketCompression() const { return packetCompression_; }
+    /// Set whether to send latest data to the client as unreliable snapshots, delta compressed against the last snapshot acknowledged by the client. Called by Network.
+    void SetSnapshotReplication(bool enable);
+    /// Return whether latest data is sent as snapshots.
+    bool GetSnapshotReplication() const { return snapshotReplication_; }
 
     /// Current controls.
     Controls controls_;
@@ -285,6 +303,8 @@ public:
 private:
     /// Handle scene loaded event.
     void HandleAsyncLoadFinished(StringHash eventType, VariantMap& eventData);
+    /// Process the messages of a packed message.
+    void ProcessPackedMessage(MemoryBuffer& buffer);
     /// Process a LoadScene message from the server. Called by Network.
     void ProcessLoadScene(int msgID, MemoryBuffer& msg);
     /// Process a SceneChecksumError message from the server. Called by Network.
@@ -297,6 +317,14 @@ private:
     void ProcessIdentity(int msgID, MemoryBuffer& msg);
     /// Process a Controls message from the client. Called by Network.
     void ProcessControls(int msgID, MemoryBuffer& msg);
+    /// Process a SnapshotAck message from the client. Called by Network.
+    void ProcessSnapshotAck(int msgID, MemoryBuffer& msg);
+    /// Process a part of a snapshot from the server.
+    void ProcessSnapshot(MemoryBuffer& msg);
+    /// Process node latest data, or cache it if the node does not exist yet.
+    void ProcessNodeLatestData(MemoryBuffer& msg);
+    /// Process component latest data, or cache it if the component does not exist yet.
+    void ProcessComponentLatestData(MemoryBuffer& msg);
     /// Process a SceneLoaded message from the client. Called by Network.
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
@@ -307,6 +335,18 @@ private:
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Send latest data changed after the snapshot acknowledged by the client.
+    void SendSnapshot();
+    /// Send the entries written to the snapshot part buffer.
+    void SendSnapshotPart(unsigned sequence, unsigned baseline, unsigned part, bool last, unsigned numEntries);
+    /// Remove a node and its components from the snapshot history.
+    void RemoveSnapshotEntries(unsigned nodeID, const NodeReplicationState& nodeState);
+    /// Update the set of top-level nodes in the interest scope from the interest grid.
+    void UpdateInterestScope(InterestGrid* grid);
+    /// Add a top-level node to the interest scope and mark it and its replicated children for sending.
+    void EnterInterestScope(Node* node);
+    /// Remove a top-level node from the interest scope, remove it from the client and drop its replication states.
+    void LeaveInterestScope(Node* node);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Process unknown message. All unknown messages are forwarded as an events
@@ -338,6 +378,12 @@ private:
     ea::unordered_map<unsigned, ea::vector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     ea::hash_set<unsigned> nodesToProcess_;
+    /// Top-level node ID's in the interest scope.
+    ea::hash_set<unsigned> scopeNodes_;
+    /// Reusable interest grid query result.
+    ea::vector<unsigned> interestQuery_;
+    /// Reusable node list for interest scope changes.
+    ea::vector<Node*> interestNodes_;
     /// Reusable message buffer.
     VectorBuffer msg_;
     /// Queued remote events.
@@ -352,6 +398,8 @@ private:
     Vector3 position_;
     /// Observer rotation for interest management.
     Quaternion rotation_;
+    /// Interest management radius. Zero disables interest management.
+    float interestRadius_;
     /// Send mode for the observer position & rotation.
     ObserverPositionSendMode sendMode_;
     /// Client connection flag.
@@ -378,6 +426,30 @@ private:
     ea::unordered_map<int, VectorBuffer> outgoingBuffer_;
     /// Outgoing packet size limit
     int packedMessageLimit_;
+    /// Compress large outgoing packets flag.
+    bool packetCompression_;
+    /// Reusable buffer for compressed packet data.
+    ea::vector<unsigned char> compressBuffer_;
+    /// Reusable buffer for outgoing compressed packets.
+    VectorBuffer compressedPacket_;
+    /// Reusable buffer for decompressed incoming packet data.
+    ea::vector<unsigned char> decompressBuffer_;
+    /// Send latest data as snapshots flag.
+    bool snapshotReplication_;
+    /// Latest data sent to the client as snapshots.
+    SnapshotHistory snapshotHistory_;
+    /// Reusable list of snapshot entries to send.
+    ea::vector<unsigned> snapshotKeys_;
+    /// Reusable buffer for snapshot part entries.
+    VectorBuffer snapshotPart_;
+    /// Newest snapshot of which parts have been received from the server.
+    unsigned snapshotReceived_;
+    /// Number of parts received of the newest snapshot.
+    unsigned snapshotPartsReceived_;
+    /// Total number of parts of the newest snapshot, or zero if the last part has not been received.
+    unsigned snapshotNumParts_;
+    /// Newest fully received snapshot, to be acknowledged to the server.
+    unsigned snapshotAck_;
 };
 
 }
@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Network/InterestGrid.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum cell size, to keep the number of cells touched by a query bounded.
+static const float MIN_CELL_SIZE = 1.0f;
+
+InterestGrid::InterestGrid(float cellSize) :
+    cellSize_(Max(cellSize, MIN_CELL_SIZE))
+{
+}
+
+void InterestGrid::SetCellSize(float cellSize)
+{
+    cellSize = Max(cellSize, MIN_CELL_SIZE);
+    if (cellSize != cellSize_)
+    {
+        cellSize_ = cellSize;
+        cells_.clear();
+    }
+}
+
+void InterestGrid::Rebuild(Scene* scene)
+{
+    for (auto& cell : cells_)
+        cell.second.clear();
+    numNodes_ = 0;
+
+    if (!scene)
+        return;
+
+    // Only top-level nodes are indexed: replicated children enter and leave scope together with their top-level ancestor
+    for (Node* node : scene->GetChildren())
+    {
+        if (!node->IsReplicated())
+            continue;
+
+        const Vector3 position = node->GetWorldPosition();
+        cells_[GetCell(position)].push_back(Entry{node->GetID(), position});
+        ++numNodes_;
+    }
+}
+
+void InterestGrid::Query(const Vector3& position, float radius, ea::vector<unsigned>& result) const
+{
+    result.clear();
+
+    const IntVector2 minCell = GetCell(position - Vector3(radius, 0.0f, radius));
+    const IntVector2 maxCell = GetCell(position + Vector3(radius, 0.0f, radius));
+    const float radiusSquared = radius * radius;
+
+    // When the query spans more cells than are occupied, visiting the occupied cells is cheaper
+    const long long numQueryCells = (long long)(maxCell.x_ - minCell.x_ + 1) * (maxCell.y_ - minCell.y_ + 1);
+    if (numQueryCells > (long long)cells_.size())
+    {
+        for (const auto& cell : cells_)
+        {
+            for (const Entry& entry : cell.second)
+            {
+                if ((entry.position_ - position).LengthSquared() <= radiusSquared)
+                    result.push_back(entry.nodeID_);
+            }
+        }
+        return;
+    }
+
+    for (int z = minCell.y_; z <= maxCell.y_; ++z)
+    {
+        for (int x = minCell.x_; x <= maxCell.x_; ++x)
+        {
+            auto cell = cells_.find(IntVector2(x, z));
+            if (cell == cells_.end())
+                continue;
+
+            for (const Entry& entry : cell->second)
+            {
+                if ((entry.position_ - position).LengthSquared() <= radiusSquared)
+                    result.push_back(entry.nodeID_);
+            }
+        }
+    }
+}
+
+IntVector2 InterestGrid::GetCell(const Vector3& position) const
+{
+    return IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+}
+
+}
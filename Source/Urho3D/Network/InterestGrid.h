@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "../Container/Hash.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Scene;
+
+/// Uniform grid over the XZ plane holding the world positions of the top-level replicated nodes of a scene. Used by interest management to find the nodes near a client without visiting the whole scene.
+class URHO3D_API InterestGrid
+{
+public:
+    /// Grid entry.
+    struct Entry
+    {
+        /// Node ID.
+        unsigned nodeID_;
+        /// World position at the last rebuild.
+        Vector3 position_;
+    };
+
+    /// Construct.
+    explicit InterestGrid(float cellSize);
+
+    /// Set cell size. Takes effect on the next rebuild.
+    void SetCellSize(float cellSize);
+    /// Rebuild from the replicated child nodes of the scene.
+    void Rebuild(Scene* scene);
+    /// Return IDs of the nodes within radius of a position.
+    void Query(const Vector3& position, float radius, ea::vector<unsigned>& result) const;
+
+    /// Return cell size.
+    float GetCellSize() const { return cellSize_; }
+    /// Return number of nodes in the grid.
+    unsigned GetNumNodes() const { return numNodes_; }
+
+private:
+    /// Return cell containing a position.
+    IntVector2 GetCell(const Vector3& position) const;
+
+    /// Cells by coordinate. Emptied cells keep their storage for reuse.
+    ea::unordered_map<IntVector2, ea::vector<Entry> > cells_;
+    /// Cell size.
+    float cellSize_;
+    /// Number of nodes in the grid.
+    unsigned numNodes_{};
+};
+
+}
@@ -192,12 +192,16 @@ static const char* RAKNET_MESSAGEID_STRINGS[] = {
 
 static const int DEFAULT_UPDATE_FPS = 30;
 static const int SERVER_TIMEOUT_TIME = 10000;
+static const float DEFAULT_INTEREST_CELL_SIZE = 32.0f;
 
 Network::Network(Context* context) :
     Object(context),
+    interestCellSize_(DEFAULT_INTEREST_CELL_SIZE),
     updateFps_(DEFAULT_UPDATE_FPS),
     simulatedLatency_(0),
     simulatedPacketLoss_(0.0f),
+    packetCompression_(true),
+    snapshotReplication_(false),
     updateInterval_(1.0f / (float)DEFAULT_UPDATE_FPS),
     updateAcc_(0.0f),
     isServer_(false),
@@ -311,6 +315,8 @@ void Network::NewConnectionEstablished(const SLNet::AddressOrGUID& connection)
     SharedPtr<Connection> newConnection(context_->CreateObject<Connection>());
     newConnection->Initialize(true, connection, rakPeer_);
     newConnection->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+    newConnection->SetPacketCompression(packetCompression_);
+    newConnection->SetSnapshotReplication(snapshotReplication_);
     clientConnections_[GetEndpointHash(connection)] = newConnection;
     URHO3D_LOGINFO("Client " + newConnection->ToString() + " connected");
 
@@ -389,6 +395,7 @@ bool Network::Connect(const ea::string& address, unsigned short port, Scene* sce
         serverConnection_->SetIdentity(identity);
         serverConnection_->SetConnectPending(true);
         serverConnection_->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+        serverConnection_->SetPacketCompression(packetCompression_);
 
         URHO3D_LOGINFO("Connecting to server " + address + ":" + ea::to_string(port) + ", Client: " + serverConnection_->ToString());
         return true;
@@ -589,6 +596,61 @@ void Network::SetSimulatedPacketLoss(float probability)
     ConfigureNetworkSimulator();
 }
 
+void Network::SetPacketCompression(bool enable)
+{
+    packetCompression_ = enable;
+
+    if (serverConnection_)
+        serverConnection_->SetPacketCompression(enable);
+
+    for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+        i->second->SetPacketCompression(enable);
+}
+
+void Network::SetSnapshotReplication(bool enable)
+{
+    snapshotReplication_ = enable;
+
+    for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+        i->second->SetSnapshotReplication(enable);
+}
+
+void Network::SetInterestCellSize(float cellSize)
+{
+    interestCellSize_ = Max(cellSize, 1.0f);
+
+    for (auto& grid : interestGrids_)
+        grid.second->SetCellSize(interestCellSize_);
+}
+
+InterestGrid* Network::GetInterestGrid(Scene* scene) const
+{
+    auto i = interestGrids_.find(scene);
+    return i != interestGrids_.end() ? i->second.get() : nullptr;
+}
+
+void Network::UpdateInterestGrids(const ea::hash_set<Scene*>& scenes)
+{
+    URHO3D_PROFILE("UpdateInterestGrids");
+
+    // Drop grids of scenes that are no longer networked with interest management
+    for (auto i = interestGrids_.begin(); i != interestGrids_.end();)
+    {
+        if (!scenes.contains(i->first))
+            i = interestGrids_.erase(i);
+        else
+            ++i;
+    }
+
+    for (Scene* scene : scenes)
+    {
+        ea::unique_ptr<InterestGrid>& grid = interestGrids_[scene];
+        if (!grid)
+            grid = ea::make_unique<InterestGrid>(interestCellSize_);
+        grid->Rebuild(scene);
+    }
+}
+
 void Network::RegisterRemoteEvent(StringHash eventType)
 {
     if (blacklistedRemoteEvents_.find(eventType) != blacklistedRemoteEvents_.end())
@@ -929,15 +991,22 @@ void Network::PostUpdate(float timeStep)
                 URHO3D_PROFILE("PrepareServerUpdate");
 
                 networkScenes_.clear();
+                ea::hash_set<Scene*> interestScenes;
                 for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
                 {
                     Scene* scene = i->second->GetScene();
                     if (scene)
+                    {
                         networkScenes_.insert(scene);
+                        if (i->second->GetInterestRadius() > 0.0f)
+                            interestScenes.insert(scene);
+                    }
                 }
 
                 for (auto i = networkScenes_.begin(); i != networkScenes_.end(); ++i)
                     (*i)->PrepareNetworkUpdate();
+
+                UpdateInterestGrids(interestScenes);
             }
 
             {
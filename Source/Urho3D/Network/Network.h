@@ -23,10 +23,12 @@
 #pragma once
 
 #include <EASTL/hash_set.h>
+#include <EASTL/unique_ptr.h>
 
 #include "../Core/Object.h"
 #include "../IO/VectorBuffer.h"
 #include "../Network/Connection.h"
+#include "../Network/InterestGrid.h"
 
 namespace Urho3D
 {
@@ -95,6 +97,15 @@ public:
     /// Set simulated packet loss probability between 0.0 - 1.0.
     /// @property
     void SetSimulatedPacketLoss(float probability);
+    /// Set whether to compress large outgoing packets with LZ4. Enabled by default.
+    /// @property
+    void SetPacketCompression(bool enable);
+    /// Set whether to send latest data of client connections as unreliable snapshots, delta compressed against the last snapshot acknowledged by the client, instead of per-object messages. Disabled by default.
+    /// @property
+    void SetSnapshotReplication(bool enable);
+    /// Set cell size of the spatial grid used for interest management. See Connection::SetInterestRadius().
+    /// @property
+    void SetInterestCellSize(float cellSize);
     /// Register a remote event as allowed to be received. There is also a fixed blacklist of events that can not be allowed in any case, such as ConsoleCommand.
     void RegisterRemoteEvent(StringHash eventType);
     /// Unregister a remote event as allowed to received.
@@ -122,6 +133,21 @@ public:
     /// @property
     float GetSimulatedPacketLoss() const { return simulatedPacketLoss_; }
 
+    /// Return whether large outgoing packets are compressed.
+    /// @property
+    bool GetPacketCompression() const { return packetCompression_; }
+
+    /// Return whether latest data is sent as snapshots.
+    /// @property
+    bool GetSnapshotReplication() const { return snapshotReplication_; }
+
+    /// Return cell size of the interest management grid.
+    /// @property
+    float GetInterestCellSize() const { return interestCellSize_; }
+
+    /// Return interest management grid of a networked scene, or null if no client connection of the scene uses interest management.
+    InterestGrid* GetInterestGrid(Scene* scene) const;
+
     /// Return a client or server connection by RakNet connection address, or null if none exist.
     Connection* GetConnection(const SLNet::AddressOrGUID& connection) const;
     /// Return the connection to the server. Null if not connected.
@@ -156,6 +182,8 @@ private:
     void OnServerDisconnected(const SLNet::AddressOrGUID& address);
     /// Reconfigure network simulator parameters on all existing connections.
     void ConfigureNetworkSimulator();
+    /// Rebuild interest management grids of the scenes and drop the grids of other scenes.
+    void UpdateInterestGrids(const ea::hash_set<Scene*>& scenes);
     /// All incoming packages are handled here.
     void HandleIncomingPacket(SLNet::Packet* packet, bool isServer);
     /// Return hash of endpoint.
@@ -175,12 +203,20 @@ private:
     ea::hash_set<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     ea::hash_set<Scene*> networkScenes_;
+    /// Interest management grids of networked scenes.
+    ea::unordered_map<Scene*, ea::unique_ptr<InterestGrid> > interestGrids_;
+    /// Interest management grid cell size.
+    float interestCellSize_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
     int simulatedLatency_;
     /// Simulated packet loss probability between 0.0 - 1.0.
     float simulatedPacketLoss_;
+    /// Compress large outgoing packets flag.
+    bool packetCompression_;
+    /// Snapshot replication flag.
+    bool snapshotReplication_;
     /// Update time interval.
     float updateInterval_;
     /// Update time accumulator.
@@ -102,6 +102,20 @@ URHO3D_EVENT(E_REMOTEEVENTDATA, RemoteEventData)
     URHO3D_PARAM(P_CONNECTION, Connection);      // Connection pointer
 }
 
+/// Top-level replicated node entered the interest scope of a client connection on the server. The node and its replicated children will be sent to the client.
+URHO3D_EVENT(E_NODEENTEREDSCOPE, NodeEnteredScope)
+{
+    URHO3D_PARAM(P_CONNECTION, Connection);      // Connection pointer
+    URHO3D_PARAM(P_NODE, Node);                  // Node pointer
+}
+
+/// Top-level replicated node left the interest scope of a client connection on the server. The node and its children have been removed from the client.
+URHO3D_EVENT(E_NODELEFTSCOPE, NodeLeftScope)
+{
+    URHO3D_PARAM(P_CONNECTION, Connection);      // Connection pointer
+    URHO3D_PARAM(P_NODE, Node);                  // Node pointer
+}
+
 /// Server refuses client connection because of the ban.
 URHO3D_EVENT(E_NETWORKBANNED, NetworkBanned)
 {
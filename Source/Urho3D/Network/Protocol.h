@@ -63,9 +63,15 @@ static const int MSG_REMOTEEVENT = 0x96;
 static const int MSG_REMOTENODEEVENT = 0x97;
 /// Server->client: info about package.
 static const int MSG_PACKAGEINFO = 0x98;
+/// Server->client: part of a latest data snapshot, delta against the last snapshot acknowledged by the client.
+static const int MSG_SNAPSHOT = 0x9C;
+/// Client->server: acknowledge the last fully received snapshot.
+static const int MSG_SNAPSHOTACK = 0x9D;
 
-/// Packet that includes all the above messages
-static const int MSG_PACKED_MESSAGE = 0x99;
+/// Packet that includes all the above messages. Each message is framed with VLE encoded message ID and size.
+static const int MSG_PACKED_MESSAGE = 0x9A;
+/// Packed message compressed with LZ4. The payload is the VLE encoded uncompressed size followed by the compressed messages.
+static const int MSG_PACKED_MESSAGE_COMPRESSED = 0x9B;
 
 /// Used to define custom messages, usually of the form MSG_USER + x, where x is an integer value.
 static const int MSG_USER = 0x200;
@@ -74,5 +80,13 @@ static const int MSG_USER = 0x200;
 static const unsigned CONTROLS_CONTENT_ID = 1;
 /// Package file fragment size.
 static const unsigned PACKAGE_FRAGMENT_SIZE = 1024;
+/// Minimum packed message size that is compressed before sending.
+static const unsigned PACKET_COMPRESSION_THRESHOLD = 128;
+/// Number of snapshots kept by the server for delta compression against the client's acknowledged snapshot.
+static const unsigned SNAPSHOT_HISTORY_SIZE = 32;
+/// Maximum snapshot part size, so that parts are not split (and thus made reliable) by the transport.
+static const unsigned SNAPSHOT_PART_SIZE = 1000;
+/// Maximum uncompressed size accepted for a compressed packed message.
+static const unsigned MAX_DECOMPRESSED_PACKET_SIZE = 1024 * 1024;
 
 }
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Math/MathDefs.h"
+#include "../Network/SnapshotHistory.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+SnapshotHistory::SnapshotHistory(unsigned size) :
+    history_(Max(size, 1u))
+{
+}
+
+void SnapshotHistory::SetEntry(unsigned key, const unsigned char* data, unsigned size)
+{
+    entries_[key].assign(data, data + size);
+    pending_.push_back(key);
+}
+
+void SnapshotHistory::RemoveEntry(unsigned key)
+{
+    entries_.erase(key);
+}
+
+unsigned SnapshotHistory::Commit()
+{
+    ++sequence_;
+    ea::vector<unsigned>& changes = history_[sequence_ % history_.size()];
+    changes.swap(pending_);
+    pending_.clear();
+    return sequence_;
+}
+
+void SnapshotHistory::Acknowledge(unsigned sequence)
+{
+    if (sequence > ackedSequence_ && sequence <= sequence_)
+        ackedSequence_ = sequence;
+}
+
+void SnapshotHistory::Clear()
+{
+    entries_.clear();
+    for (ea::vector<unsigned>& changes : history_)
+        changes.clear();
+    pending_.clear();
+    ackedSequence_ = 0;
+}
+
+bool SnapshotHistory::GetDelta(ea::vector<unsigned>& keys)
+{
+    keys.clear();
+
+    // The snapshots after the acknowledged one must all be in the history
+    if (!ackedSequence_ || sequence_ - ackedSequence_ >= history_.size())
+    {
+        for (const auto& entry : entries_)
+            keys.push_back(entry.first);
+        return false;
+    }
+
+    deltaKeys_.clear();
+    for (unsigned sequence = ackedSequence_ + 1; sequence <= sequence_; ++sequence)
+    {
+        for (unsigned key : history_[sequence % history_.size()])
+        {
+            // Skip objects removed since
+            if (deltaKeys_.insert(key).second && entries_.contains(key))
+                keys.push_back(key);
+        }
+    }
+    return true;
+}
+
+const ea::vector<unsigned char>* SnapshotHistory::GetEntry(unsigned key) const
+{
+    auto i = entries_.find(key);
+    return i != entries_.end() ? &i->second : nullptr;
+}
+
+}
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "../Container/Hash.h"
+
+#include <EASTL/hash_set.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Server-side history of the latest data states sent to one client, used by snapshot replication. Holds the current state of each replicated object and a ring of the objects changed in each recent snapshot, so that a delta against the last snapshot acknowledged by the client can be found without storing full world states.
+class URHO3D_API SnapshotHistory
+{
+public:
+    /// Construct with the number of snapshots to keep.
+    explicit SnapshotHistory(unsigned size);
+
+    /// Set the latest data of an object in the snapshot being built.
+    void SetEntry(unsigned key, const unsigned char* data, unsigned size);
+    /// Remove an object, e.g. when it has been removed or has left the client's interest scope.
+    void RemoveEntry(unsigned key);
+    /// Finish the snapshot being built and return its sequence number.
+    unsigned Commit();
+    /// Mark a snapshot as acknowledged by the client. Older and unknown sequence numbers are ignored.
+    void Acknowledge(unsigned sequence);
+    /// Remove all objects and forget the acknowledged snapshot. Sequence numbers keep increasing.
+    void Clear();
+
+    /// Return keys of the objects changed after the acknowledged snapshot. Return true on success, or false if there is no acknowledged snapshot in the history, in which case all keys are returned.
+    bool GetDelta(ea::vector<unsigned>& keys);
+    /// Return latest data of an object, or null if not found.
+    const ea::vector<unsigned char>* GetEntry(unsigned key) const;
+    /// Return sequence number of the last committed snapshot.
+    unsigned GetSequence() const { return sequence_; }
+    /// Return sequence number of the last acknowledged snapshot, or zero if none.
+    unsigned GetAckedSequence() const { return ackedSequence_; }
+
+    /// Return key of a node.
+    static unsigned GetNodeKey(unsigned nodeID) { return nodeID << 1u; }
+    /// Return key of a component.
+    static unsigned GetComponentKey(unsigned componentID) { return (componentID << 1u) | 1u; }
+    /// Return whether a key refers to a component.
+    static bool IsComponentKey(unsigned key) { return key & 1u; }
+    /// Return node or component ID from a key.
+    static unsigned GetKeyID(unsigned key) { return key >> 1u; }
+
+private:
+    /// Latest data by key.
+    ea::unordered_map<unsigned, ea::vector<unsigned char> > entries_;
+    /// Keys changed in each snapshot, indexed by sequence number modulo history size.
+    ea::vector<ea::vector<unsigned> > history_;
+    /// Keys changed in the snapshot being built.
+    ea::vector<unsigned> pending_;
+    /// Reusable set for merging changed keys.
+    ea::hash_set<unsigned> deltaKeys_;
+    /// Last committed sequence number.
+    unsigned sequence_{};
+    /// Last acknowledged sequence number.
+    unsigned ackedSequence_{};
+};
+
+}
@@ -32,6 +32,8 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/PhysicsUtils.h"
@@ -49,6 +51,7 @@
 #include <Bullet/BulletCollision/CollisionShapes/btConvexHullShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btCylinderShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btOptimizedBvh.h>
 #include <Bullet/BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
@@ -62,6 +65,8 @@ namespace Urho3D
 
 static const float DEFAULT_COLLISION_MARGIN = 0.04f;
 static const unsigned QUANTIZE_MAX_TRIANGLES = 1000000;
+static const unsigned BVH_CACHE_VERSION = 2;
+static const unsigned BVH_ALIGNMENT = 16;
 
 static const btVector3 WHITE(1.0f, 1.0f, 1.0f);
 static const btVector3 GREEN(0.0f, 1.0f, 0.0f);
@@ -133,8 +138,11 @@ public:
             m_indexedMeshes.push_back(meshIndex);
 
             totalTriangles += meshIndex.m_numTriangles;
+            numVertices_ += geometry->GetVertexCount();
         }
 
+        numTriangles_ = totalTriangles;
+
         // Bullet will not work properly with quantized AABB compression, if the triangle count is too large. Use a conservative
         // threshold value
         useQuantize_ = totalTriangles <= QUANTIZE_MAX_TRIANGLES;
@@ -185,35 +193,207 @@ public:
             totalTriangles += meshIndex.m_numTriangles;
         }
 
+        numVertices_ = totalVertexCount;
+        numTriangles_ = totalTriangles;
         useQuantize_ = totalTriangles <= QUANTIZE_MAX_TRIANGLES;
     }
 
+    /// Return 64-bit FNV-1a hash of the triangle positions, which identifies the BVH built from them.
+    unsigned long long GetContentHash() const
+    {
+        unsigned long long hash = 0xcbf29ce484222325ull;
+        const auto combine = [&hash](unsigned value)
+        {
+            hash ^= value;
+            hash *= 0x100000001b3ull;
+        };
+
+        combine(useQuantize_ ? 1 : 0);
+        for (int i = 0; i < m_indexedMeshes.size(); ++i)
+        {
+            const btIndexedMesh& mesh = m_indexedMeshes[i];
+            combine((unsigned)mesh.m_numTriangles);
+
+            for (int j = 0; j < mesh.m_numTriangles; ++j)
+            {
+                const unsigned char* indexData = mesh.m_triangleIndexBase + j * mesh.m_triangleIndexStride;
+                for (unsigned k = 0; k < 3; ++k)
+                {
+                    const unsigned index = mesh.m_indexType == PHY_SHORT ? ((const unsigned short*)indexData)[k]
+                        : ((const unsigned*)indexData)[k];
+                    const auto* position = reinterpret_cast<const unsigned*>(mesh.m_vertexBase + index * mesh.m_vertexStride);
+                    combine(position[0]);
+                    combine(position[1]);
+                    combine(position[2]);
+                }
+            }
+        }
+        return hash;
+    }
+
     /// OK to use quantization flag.
     bool useQuantize_;
+    /// Number of vertices in the meshes.
+    unsigned numVertices_{};
+    /// Number of triangles in the meshes.
+    unsigned numTriangles_{};
 
 private:
     /// Shared vertex/index data used in the collision.
     ea::vector<ea::shared_array<unsigned char> > dataArrays_;
 };
 
-TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel)
+TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel, const ea::string& bvhCacheDir)
 {
     meshInterface_ = ea::make_unique<TriangleMeshInterface>(model, lodLevel);
-    shape_ = ea::make_unique<btBvhTriangleMeshShape>(meshInterface_.get(), meshInterface_->useQuantize_, true);
 
-    infoMap_ = ea::make_unique<btTriangleInfoMap>();
-    btGenerateInternalEdgeInfo(shape_.get(), infoMap_.get());
+    if (bvhCacheDir.empty())
+    {
+        Build();
+        return;
+    }
+
+    // Cached data is identified by the triangle content, so it stays valid across model renames and is shared by identical models
+    const unsigned long long contentHash = meshInterface_->GetContentHash();
+    const ea::string cacheFileName = Format("{}{:016x}.bvh", bvhCacheDir, contentHash);
+
+    auto* cache = model->GetSubsystem<ResourceCache>();
+    SharedPtr<File> cacheFile = cache->GetFile(cacheFileName, false);
+    if (cacheFile && LoadBvhCache(*cacheFile, contentHash))
+        return;
+
+    Build();
+
+    // Filename may or may not be inside the resource system
+    ea::string fullName = cacheFileName;
+    if (!IsAbsolutePath(fullName))
+    {
+        // If not absolute, use the resource dir of the model. Models in packages are not cached
+        const ea::string modelFileName = cache->GetResourceFileName(model->GetName());
+        if (modelFileName.empty())
+            return;
+        fullName = modelFileName.substr(0, modelFileName.find(model->GetName())) + cacheFileName;
+    }
+
+    auto* fileSystem = model->GetSubsystem<FileSystem>();
+    const ea::string path = GetPath(fullName);
+    if (!fileSystem->DirExists(path))
+        fileSystem->CreateDir(path);
+
+    File file(model->GetContext(), fullName, FILE_WRITE);
+    if (file.IsOpen())
+        SaveBvhCache(file, contentHash);
 }
 
 TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
 {
     meshInterface_ = ea::make_unique<TriangleMeshInterface>(custom);
+    Build();
+}
+
+TriangleMeshData::~TriangleMeshData()
+{
+    // The shape does not own a BVH loaded from cache, destroy it before releasing the memory
+    shape_.reset();
+    if (bvhData_)
+    {
+        static_cast<btOptimizedBvh*>(bvhData_)->~btOptimizedBvh();
+        btAlignedFree(bvhData_);
+    }
+}
+
+void TriangleMeshData::Build()
+{
     shape_ = ea::make_unique<btBvhTriangleMeshShape>(meshInterface_.get(), meshInterface_->useQuantize_, true);
 
     infoMap_ = ea::make_unique<btTriangleInfoMap>();
     btGenerateInternalEdgeInfo(shape_.get(), infoMap_.get());
 }
 
+bool TriangleMeshData::LoadBvhCache(Deserializer& source, unsigned long long contentHash)
+{
+    // The BVH is stored as a memory image, so the layout must match as well as the content
+    if (source.ReadFileID() != "UBVH" || source.ReadUInt() != BVH_CACHE_VERSION ||
+        source.ReadUInt() != sizeof(btQuantizedBvh) || source.ReadUInt64() != contentHash)
+        return false;
+
+    // Guard against hash collisions
+    const unsigned numVertices = source.ReadUInt();
+    const unsigned numTriangles = source.ReadUInt();
+    if (numVertices != meshInterface_->numVertices_ || numTriangles != meshInterface_->numTriangles_)
+    {
+        URHO3D_LOGWARNING("BVH cache " + source.GetName() + " does not match the mesh, rebuilding");
+        return false;
+    }
+
+    const bool quantized = source.ReadBool();
+    const unsigned bvhSize = source.ReadUInt();
+    if (quantized != meshInterface_->useQuantize_ || !bvhSize)
+        return false;
+
+    void* bvhData = btAlignedAlloc(bvhSize, BVH_ALIGNMENT);
+    btOptimizedBvh* bvh = nullptr;
+    if (source.Read(bvhData, bvhSize) == bvhSize)
+        bvh = btOptimizedBvh::deSerializeInPlace(bvhData, bvhSize, false);
+    if (!bvh)
+    {
+        URHO3D_LOGWARNING("Corrupted BVH cache data in " + source.GetName());
+        btAlignedFree(bvhData);
+        return false;
+    }
+
+    bvhData_ = bvhData;
+    shape_ = ea::make_unique<btBvhTriangleMeshShape>(meshInterface_.get(), quantized, false);
+    shape_->setOptimizedBvh(bvh);
+
+    infoMap_ = ea::make_unique<btTriangleInfoMap>();
+    const unsigned numInfos = source.ReadUInt();
+    for (unsigned i = 0; i < numInfos && !source.IsEof(); ++i)
+    {
+        const int key = source.ReadInt();
+        btTriangleInfo info;
+        info.m_flags = source.ReadInt();
+        info.m_edgeV0V1Angle = source.ReadFloat();
+        info.m_edgeV1V2Angle = source.ReadFloat();
+        info.m_edgeV2V0Angle = source.ReadFloat();
+        infoMap_->insert(btHashInt(key), info);
+    }
+    shape_->setTriangleInfoMap(infoMap_.get());
+
+    return true;
+}
+
+void TriangleMeshData::SaveBvhCache(Serializer& dest, unsigned long long contentHash) const
+{
+    const btOptimizedBvh* bvh = shape_->getOptimizedBvh();
+    const unsigned bvhSize = bvh->calculateSerializeBufferSize();
+    void* bvhData = btAlignedAlloc(bvhSize, BVH_ALIGNMENT);
+    bvh->serializeInPlace(bvhData, bvhSize, false);
+
+    dest.WriteFileID("UBVH");
+    dest.WriteUInt(BVH_CACHE_VERSION);
+    dest.WriteUInt(sizeof(btQuantizedBvh));
+    dest.WriteUInt64(contentHash);
+    dest.WriteUInt(meshInterface_->numVertices_);
+    dest.WriteUInt(meshInterface_->numTriangles_);
+    dest.WriteBool(meshInterface_->useQuantize_);
+    dest.WriteUInt(bvhSize);
+    dest.Write(bvhData, bvhSize);
+    btAlignedFree(bvhData);
+
+    const int numInfos = infoMap_->size();
+    dest.WriteUInt((unsigned)numInfos);
+    for (int i = 0; i < numInfos; ++i)
+    {
+        const btTriangleInfo* info = infoMap_->getAtIndex(i);
+        dest.WriteInt(infoMap_->getKeyAtIndex(i).getUid1());
+        dest.WriteInt(info->m_flags);
+        dest.WriteFloat(info->m_edgeV0V1Angle);
+        dest.WriteFloat(info->m_edgeV1V2Angle);
+        dest.WriteFloat(info->m_edgeV2V0Angle);
+    }
+}
+
 GImpactMeshData::GImpactMeshData(Model* model, unsigned lodLevel)
 {
     meshInterface_ = ea::make_unique<TriangleMeshInterface>(model, lodLevel);
@@ -394,12 +574,13 @@ bool HasDynamicBuffers(Model* model, unsigned lodLevel)
     return false;
 }
 
-CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel)
+CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel,
+    const ea::string& bvhCacheDir)
 {
     switch (shapeType)
     {
     case SHAPE_TRIANGLEMESH:
-        return new TriangleMeshData(model, lodLevel);
+        return new TriangleMeshData(model, lodLevel, bvhCacheDir);
     case SHAPE_CONVEXHULL:
         return new ConvexData(model, lodLevel);
     case SHAPE_GIMPACTMESH:
@@ -1122,10 +1303,12 @@ void CollisionShape::UpdateCachedGeometryShape(CollisionGeometryDataCache& cache
             geometry_ = cachedGeometry->second;
         else
         {
-            geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
-            assert(geometry_);
             // Check if model has dynamic buffers, do not cache in that case
-            if (!HasDynamicBuffers(model_, lodLevel_))
+            const bool dynamicBuffers = HasDynamicBuffers(model_, lodLevel_);
+            const ea::string& bvhCacheDir = physicsWorld_ && !dynamicBuffers ? physicsWorld_->GetBvhCacheDir() : EMPTY_STRING;
+            geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_, bvhCacheDir);
+            assert(geometry_);
+            if (!dynamicBuffers)
                 cache[id] = geometry_;
         }
 
@@ -42,10 +42,12 @@ namespace Urho3D
 {
 
 class CustomGeometry;
+class Deserializer;
 class Geometry;
 class Model;
 class PhysicsWorld;
 class RigidBody;
+class Serializer;
 class Terrain;
 class TriangleMeshInterface;
 
@@ -76,10 +78,12 @@ using CollisionGeometryDataCache = ea::unordered_map<ea::pair<Model*, unsigned>,
 /// Triangle mesh geometry data.
 struct TriangleMeshData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    TriangleMeshData(Model* model, unsigned lodLevel);
+    /// Construct from a model. If BVH cache directory is not empty, load the BVH from the cache or save it there after building.
+    TriangleMeshData(Model* model, unsigned lodLevel, const ea::string& bvhCacheDir = EMPTY_STRING);
     /// Construct from a custom geometry.
     explicit TriangleMeshData(CustomGeometry* custom);
+    /// Destruct.
+    ~TriangleMeshData() override;
 
     /// Bullet triangle mesh interface.
     ea::unique_ptr<TriangleMeshInterface> meshInterface_;
@@ -87,6 +91,17 @@ struct TriangleMeshData : public CollisionGeometryData
     ea::unique_ptr<btBvhTriangleMeshShape> shape_;
     /// Bullet triangle info map.
     ea::unique_ptr<btTriangleInfoMap> infoMap_;
+
+private:
+    /// Build BVH and triangle info map.
+    void Build();
+    /// Load BVH and triangle info map from cached data. Return true if successful.
+    bool LoadBvhCache(Deserializer& source, unsigned long long contentHash);
+    /// Save BVH and triangle info map.
+    void SaveBvhCache(Serializer& dest, unsigned long long contentHash) const;
+
+    /// Aligned memory holding the BVH loaded from cache.
+    void* bvhData_{};
 };
 
 /// Triangle mesh geometry data.
@@ -27,8 +27,11 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Math/Ray.h"
 #include "../Physics/CollisionShape.h"
@@ -45,10 +48,15 @@
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btCompoundShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#if BT_THREADSAFE
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#endif
 
 
 extern ContactAddedCallback gContactAddedCallback;
@@ -61,9 +69,218 @@ extern const char* SUBSYSTEM_CATEGORY;
 
 static const int MAX_SOLVER_ITERATIONS = 256;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+static const unsigned MIN_QUERIES_PER_TASK = 64;
 
 PhysicsWorldConfig PhysicsWorld::config;
 
+#if BT_THREADSAFE
+/// Bullet task scheduler that runs parallel loops on the engine work queue.
+class WorkQueueTaskScheduler : public btITaskScheduler
+{
+public:
+    /// Construct.
+    WorkQueueTaskScheduler() :
+        btITaskScheduler("WorkQueue")
+    {
+    }
+
+    /// Set work queue to use. Parallel loops run serially if there is none.
+    void SetWorkQueue(WorkQueue* workQueue) { workQueue_ = workQueue; }
+
+    /// Return maximum number of threads.
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    /// Return number of threads including the main thread.
+    int getNumThreads() const override { return workQueue_ ? (int)workQueue_->GetNumThreads() + 1 : 1; }
+    /// Set number of threads. Controlled by the work queue instead.
+    void setNumThreads(int numThreads) override { }
+
+    /// Run parallel for loop.
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        const int numTasks = GetNumTasks(iBegin, iEnd, grainSize);
+        if (numTasks <= 1)
+        {
+            body.forLoop(iBegin, iEnd);
+            return;
+        }
+
+        const int taskSize = (iEnd - iBegin + numTasks - 1) / numTasks;
+        for (int begin = iBegin; begin < iEnd; begin += taskSize)
+        {
+            const int end = Min(begin + taskSize, iEnd);
+            workQueue_->AddWorkItem([&body, begin, end]() { body.forLoop(begin, end); }, M_MAX_UNSIGNED);
+        }
+        workQueue_->Complete(M_MAX_UNSIGNED);
+    }
+
+    /// Run parallel sum loop.
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        const int numTasks = GetNumTasks(iBegin, iEnd, grainSize);
+        if (numTasks <= 1)
+            return body.sumLoop(iBegin, iEnd);
+
+        const int taskSize = (iEnd - iBegin + numTasks - 1) / numTasks;
+        ea::vector<btScalar> sums((unsigned)numTasks, 0.0f);
+        for (int begin = iBegin, task = 0; begin < iEnd; begin += taskSize, ++task)
+        {
+            const int end = Min(begin + taskSize, iEnd);
+            btScalar* sum = &sums[task];
+            workQueue_->AddWorkItem([&body, begin, end, sum]() { *sum = body.sumLoop(begin, end); }, M_MAX_UNSIGNED);
+        }
+        workQueue_->Complete(M_MAX_UNSIGNED);
+
+        btScalar result = 0.0f;
+        for (btScalar sum : sums)
+            result += sum;
+        return result;
+    }
+
+private:
+    /// Return number of tasks to split a loop into. Loops are run serially outside the main thread or when the work queue is busy.
+    int GetNumTasks(int iBegin, int iEnd, int grainSize) const
+    {
+        if (!workQueue_ || !workQueue_->GetNumThreads() || workQueue_->IsCompleting() || !Thread::IsMainThread())
+            return 1;
+
+        // Use a few tasks per thread to balance uneven islands
+        const int maxTasks = ((int)workQueue_->GetNumThreads() + 1) * 4;
+        const int numGrains = (iEnd - iBegin + Max(grainSize, 1) - 1) / Max(grainSize, 1);
+        return Min(numGrains, maxTasks);
+    }
+
+    /// Work queue.
+    WeakPtr<WorkQueue> workQueue_;
+};
+
+/// Return the task scheduler shared by all multithreaded physics worlds.
+static WorkQueueTaskScheduler& GetTaskScheduler()
+{
+    static WorkQueueTaskScheduler scheduler;
+    return scheduler;
+}
+#endif
+
+static void ResetRaycastResult(PhysicsRaycastResult& result)
+{
+    result.body_ = nullptr;
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+}
+
+static void RaycastSingleImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float maxDistance,
+    unsigned collisionMask)
+{
+    btCollisionWorld::ClosestRayResultCallback
+        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+    }
+    else
+        ResetRaycastResult(result);
+}
+
+static void ConvexCastImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const btConvexShape* shape,
+    const Vector3& startPos, const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
+{
+    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(shape, btTransform(ToBtQuaternion(startRot), convexCallback.m_convexFromWorld),
+        btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+        ResetRaycastResult(result);
+}
+
+/// Return whether any collision object uses a GImpact shape. GImpact meshes lock their vertex data during queries and can not be queried concurrently.
+static bool FindGImpactShapes(const btCollisionWorld* world)
+{
+    const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        const btCollisionShape* shape = objects[i]->getCollisionShape();
+        if (shape->getShapeType() == GIMPACT_SHAPE_PROXYTYPE)
+            return true;
+
+        if (shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE)
+        {
+            const auto* compound = static_cast<const btCompoundShape*>(shape);
+            for (int j = 0; j < compound->getNumChildShapes(); ++j)
+            {
+                if (compound->getChildShape(j)->getShapeType() == GIMPACT_SHAPE_PROXYTYPE)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// Run a batch of read-only collision world queries. Ranges are processed in worker threads if the queries are numerous enough and the world can be queried concurrently.
+template <class T>
+static void ProcessQueryBatch(WorkQueue* workQueue, bool concurrent, unsigned count, const T& processRange)
+{
+#if BT_THREADSAFE
+    if (count > MIN_QUERIES_PER_TASK && workQueue && workQueue->GetNumThreads() && !workQueue->IsCompleting()
+        && Thread::IsMainThread() && concurrent)
+    {
+        const unsigned maxTasks = (workQueue->GetNumThreads() + 1) * 4;
+        const unsigned numTasks = Min((count + MIN_QUERIES_PER_TASK - 1) / MIN_QUERIES_PER_TASK, maxTasks);
+        const unsigned taskSize = (count + numTasks - 1) / numTasks;
+        for (unsigned begin = 0; begin < count; begin += taskSize)
+        {
+            const unsigned end = Min(begin + taskSize, count);
+            workQueue->AddWorkItem([&processRange, begin, end]() { processRange(begin, end); }, M_MAX_UNSIGNED);
+        }
+        workQueue->Complete(M_MAX_UNSIGNED);
+        return;
+    }
+#endif
+
+    processRange(0, count);
+}
+
+static unsigned long long GetContactPairId(const RigidBody* bodyA, const RigidBody* bodyB)
+{
+    const unsigned long long idA = bodyA->GetID();
+    const unsigned long long idB = bodyB->GetID();
+    return idA < idB ? (idA << 32u) | idB : (idB << 32u) | idA;
+}
+
+static bool IsCollisionReported(const RigidBody* bodyA, const RigidBody* bodyB)
+{
+    // Skip collision event signaling if both objects are static, or if collision event mode does not match
+    if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
+        !bodyA->IsActive() && !bodyB->IsActive())
+        return false;
+    return true;
+}
+
 static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
@@ -159,12 +376,43 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     else
         collisionConfiguration_ = new btDefaultCollisionConfiguration();
 
-    collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
-    btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+    if (PhysicsWorld::config.multithreaded_)
+    {
+#if BT_THREADSAFE
+        if (Thread::IsMainThread())
+            multithreaded_ = true;
+        else
+            URHO3D_LOGWARNING("Multithreaded physics world must be created in the main thread, falling back to single-threaded");
+#else
+        URHO3D_LOGWARNING("Multithreaded physics world requires the URHO3D_PHYSICS_MULTITHREADED build option, falling back to single-threaded");
+#endif
+    }
 
     broadphase_ = ea::make_unique<btDbvtBroadphase>();
-    solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
-    world_ = ea::make_unique<btDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+
+#if BT_THREADSAFE
+    if (multithreaded_)
+    {
+        auto* workQueue = GetSubsystem<WorkQueue>();
+        const int numSolvers = workQueue ? (int)workQueue->GetNumThreads() + 1 : 1;
+
+        GetTaskScheduler().SetWorkQueue(workQueue);
+        btSetTaskScheduler(&GetTaskScheduler());
+
+        collisionDispatcher_ = ea::make_unique<btCollisionDispatcherMt>(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+        solver_ = ea::make_unique<btConstraintSolverPoolMt>(Min(numSolvers, (int)BT_MAX_THREAD_COUNT));
+        world_ = ea::make_unique<btDiscreteDynamicsWorldMt>(collisionDispatcher_.get(), broadphase_.get(),
+            static_cast<btConstraintSolverPoolMt*>(solver_.get()), nullptr, collisionConfiguration_);
+    }
+    else
+#endif
+    {
+        collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+        solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
+        world_ = ea::make_unique<btDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    }
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -213,6 +461,7 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Collision Events", bool, collisionEventsEnabled_, true, AM_FILE);
 }
 
 bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
@@ -273,6 +522,12 @@ void PhysicsWorld::Update(float timeStep)
     delayedWorldTransforms_.clear();
     simulating_ = true;
 
+#if BT_THREADSAFE
+    // Worlds may belong to different contexts, make sure the scheduler uses this world's work queue
+    if (multithreaded_)
+        GetTaskScheduler().SetWorkQueue(GetSubsystem<WorkQueue>());
+#endif
+
     if (interpolation_)
         world_->stepSimulation(timeStep, maxSubSteps, internalTimeStep);
     else
@@ -351,6 +606,17 @@ void PhysicsWorld::SetInterpolation(bool enable)
     interpolation_ = enable;
 }
 
+void PhysicsWorld::SetBvhCacheDir(const ea::string& path)
+{
+    const ea::string trimmedPath = path.trimmed();
+    bvhCacheDir_ = trimmedPath.empty() ? EMPTY_STRING : AddTrailingSlash(trimmedPath);
+}
+
+void PhysicsWorld::SetCollisionEventsEnabled(bool enable)
+{
+    collisionEventsEnabled_ = enable;
+}
+
 void PhysicsWorld::SetInternalEdge(bool enable)
 {
     internalEdge_ = enable;
@@ -407,29 +673,7 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
-
-    if (rayCallback.hasHit())
-    {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
-    {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+    RaycastSingleImpl(world_.get(), result, ray, maxDistance, collisionMask);
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask, float overlapDistance)
@@ -492,32 +736,9 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
     btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
-
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
+    const Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
 
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
-    {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+    ConvexCastImpl(world_.get(), result, &shape, ray.origin_, Quaternion::IDENTITY, endPos, Quaternion::IDENTITY, collisionMask);
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
@@ -526,11 +747,7 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shap
     if (!shape || !shape->GetCollisionShape())
     {
         URHO3D_LOGERROR("Null collision shape for convex cast");
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
+        ResetRaycastResult(result);
         return;
     }
 
@@ -567,51 +784,139 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
     if (!shape)
     {
         URHO3D_LOGERROR("Null collision shape for convex cast");
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
+        ResetRaycastResult(result);
         return;
     }
 
     if (!shape->isConvex())
     {
         URHO3D_LOGERROR("Can not use non-convex collision shape for convex cast");
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
+        ResetRaycastResult(result);
         return;
     }
 
     URHO3D_PROFILE("PhysicsConvexCast");
 
-    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    ConvexCastImpl(world_.get(), result, static_cast<btConvexShape*>(shape), startPos, startRot, endPos, endRot, collisionMask);
+}
 
-    world_->convexSweepTest(static_cast<btConvexShape*>(shape), btTransform(ToBtQuaternion(startRot),
-            convexCallback.m_convexFromWorld), btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld),
-        convexCallback);
+void PhysicsWorld::RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsRaycastQuery> queries)
+{
+    URHO3D_PROFILE("PhysicsRaycastSingleBatch");
 
-    if (convexCallback.hasHit())
+    results.resize(queries.size());
+
+    for (const PhysicsRaycastQuery& query : queries)
     {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
+        if (query.maxDistance_ >= M_INFINITY)
+        {
+            URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
+            break;
+        }
     }
-    else
+
+    const btCollisionWorld* world = world_.get();
+    PhysicsRaycastResult* resultsData = results.data();
+    ProcessQueryBatch(GetSubsystem<WorkQueue>(), !HasGImpactShapes(), (unsigned)queries.size(), [=](unsigned begin, unsigned end)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const PhysicsRaycastQuery& query = queries[i];
+            if (query.radius_ > 0.0f)
+            {
+                btSphereShape shape(query.radius_);
+                const Vector3 endPos = query.ray_.origin_ + query.maxDistance_ * query.ray_.direction_;
+                ConvexCastImpl(world, resultsData[i], &shape, query.ray_.origin_, Quaternion::IDENTITY, endPos,
+                    Quaternion::IDENTITY, query.collisionMask_);
+            }
+            else
+                RaycastSingleImpl(world, resultsData[i], query.ray_, query.maxDistance_, query.collisionMask_);
+        }
+    });
+}
+
+void PhysicsWorld::ConvexCastBatch(ea::vector<PhysicsRaycastResult>& results, CollisionShape* shape,
+    ea::span<const PhysicsConvexCastQuery> queries)
+{
+    if (!shape || !shape->GetCollisionShape())
+    {
+        URHO3D_LOGERROR("Null collision shape for convex cast");
+        results.resize(queries.size());
+        for (PhysicsRaycastResult& result : results)
+            ResetRaycastResult(result);
+        return;
     }
+
+    // If shape is attached in a rigidbody, set its collision group temporarily to 0 to make sure it is not returned in the sweep result
+    auto* bodyComp = shape->GetComponent<RigidBody>();
+    btRigidBody* body = bodyComp ? bodyComp->GetBody() : nullptr;
+    btBroadphaseProxy* proxy = body ? body->getBroadphaseProxy() : nullptr;
+    short group = 0;
+    if (proxy)
+    {
+        group = proxy->m_collisionFilterGroup;
+        proxy->m_collisionFilterGroup = 0;
+    }
+
+    // Take the shape's offset position & rotation into account
+    Node* shapeNode = shape->GetNode();
+    const Vector3 scale = shapeNode ? shapeNode->GetWorldScale() : Vector3::ONE;
+    ea::vector<PhysicsConvexCastQuery> effectiveQueries(queries.begin(), queries.end());
+    for (PhysicsConvexCastQuery& query : effectiveQueries)
+    {
+        query.startPos_ = Matrix3x4(query.startPos_, query.startRot_, scale) * shape->GetPosition();
+        query.endPos_ = Matrix3x4(query.endPos_, query.endRot_, scale) * shape->GetPosition();
+        query.startRot_ = query.startRot_ * shape->GetRotation();
+        query.endRot_ = query.endRot_ * shape->GetRotation();
+    }
+
+    ConvexCastBatch(results, shape->GetCollisionShape(), effectiveQueries);
+
+    // Restore the collision group
+    if (proxy)
+        proxy->m_collisionFilterGroup = group;
+}
+
+void PhysicsWorld::ConvexCastBatch(ea::vector<PhysicsRaycastResult>& results, btCollisionShape* shape,
+    ea::span<const PhysicsConvexCastQuery> queries)
+{
+    results.resize(queries.size());
+
+    if (!shape || !shape->isConvex())
+    {
+        if (!shape)
+            URHO3D_LOGERROR("Null collision shape for convex cast");
+        else
+            URHO3D_LOGERROR("Can not use non-convex collision shape for convex cast");
+        for (PhysicsRaycastResult& result : results)
+            ResetRaycastResult(result);
+        return;
+    }
+
+    URHO3D_PROFILE("PhysicsConvexCastBatch");
+
+    const btCollisionWorld* world = world_.get();
+    const auto* convexShape = static_cast<const btConvexShape*>(shape);
+    PhysicsRaycastResult* resultsData = results.data();
+    ProcessQueryBatch(GetSubsystem<WorkQueue>(), !HasGImpactShapes(), (unsigned)queries.size(), [=](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const PhysicsConvexCastQuery& query = queries[i];
+            ConvexCastImpl(world, resultsData[i], convexShape, query.startPos_, query.startRot_, query.endPos_,
+                query.endRot_, query.collisionMask_);
+        }
+    });
+}
+
+bool PhysicsWorld::HasGImpactShapes()
+{
+    if (gImpactShapesDirty_)
+    {
+        hasGImpactShapes_ = FindGImpactShapes(world_.get());
+        gImpactShapesDirty_ = false;
+    }
+    return hasGImpactShapes_;
 }
 
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
@@ -687,18 +992,18 @@ void PhysicsWorld::GetCollidingBodies(ea::vector<RigidBody*>& result, const Rigi
 
     result.clear();
 
-    for (auto i = currentCollisions_.begin();
-         i != currentCollisions_.end(); ++i)
+    for (unsigned i = 0; i < contactPairs_.size(); ++i)
     {
-        if (i->first.first == body)
+        const ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >& bodies = contactPairBodies_[i];
+        if (bodies.first == body)
         {
-            if (i->first.second)
-                result.push_back(i->first.second);
+            if (bodies.second)
+                result.push_back(bodies.second);
         }
-        else if (i->first.second == body)
+        else if (bodies.second == body)
         {
-            if (i->first.first)
-                result.push_back(i->first.first);
+            if (bodies.first)
+                result.push_back(bodies.first);
         }
     }
 }
@@ -818,7 +1123,9 @@ void PhysicsWorld::PostStep(float timeStep)
 {
     // URHO3D_PROFILE_END();
 
-    SendCollisionEvents();
+    UpdateContactStream();
+    if (collisionEventsEnabled_)
+        SendCollisionEvents();
 
     // Send post-step event
     using namespace PhysicsPostStep;
@@ -829,68 +1136,148 @@ void PhysicsWorld::PostStep(float timeStep)
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
-void PhysicsWorld::SendCollisionEvents()
+void PhysicsWorld::UpdateContactStream()
 {
-    URHO3D_PROFILE("SendCollisionEvents");
+    URHO3D_PROFILE("UpdateContactStream");
 
-    currentCollisions_.clear();
-    physicsCollisionData_.clear();
-    nodeCollisionData_.clear();
+    contactManifolds_.clear();
+    contactPairs_.clear();
+    endedContactPairs_.clear();
+    contacts_.clear();
+    contactPairBodies_.clear();
 
-    int numManifolds = collisionDispatcher_->getNumManifolds();
+    const int numManifolds = collisionDispatcher_->getNumManifolds();
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
+        // First check that there are actual contacts, as the manifold exists also when objects are close but not touching
+        if (!contactManifold->getNumContacts())
+            continue;
+
+        auto* bodyA = static_cast<RigidBody*>(contactManifold->getBody0()->getUserPointer());
+        auto* bodyB = static_cast<RigidBody*>(contactManifold->getBody1()->getUserPointer());
+        // If it's not a rigidbody, maybe a ghost object
+        if (!bodyA || !bodyB)
+            continue;
+
+        if (!IsCollisionReported(bodyA, bodyB))
+            continue;
+
+        contactManifolds_.push_back(ContactManifoldRef{GetContactPairId(bodyA, bodyB), i, contactManifold});
+    }
 
-    if (numManifolds)
+    // Sort so that manifolds of the same pair are adjacent and pairs can be matched against the previous step with a merge
+    ea::sort(contactManifolds_.begin(), contactManifolds_.end(), [](const ContactManifoldRef& lhs, const ContactManifoldRef& rhs)
     {
-        physicsCollisionData_[PhysicsCollision::P_WORLD] = this;
+        return lhs.pairId_ != rhs.pairId_ ? lhs.pairId_ < rhs.pairId_ : lhs.index_ < rhs.index_;
+    });
+
+    auto previousIter = previousPairIds_.begin();
+    for (const ContactManifoldRef& manifoldRef : contactManifolds_)
+    {
+        btPersistentManifold* contactManifold = manifoldRef.manifold_;
+        auto* body0 = static_cast<RigidBody*>(contactManifold->getBody0()->getUserPointer());
+        auto* body1 = static_cast<RigidBody*>(contactManifold->getBody1()->getUserPointer());
+        // Pair body order is by component ID, flip normals if the manifold has the bodies the other way around
+        const bool flipped = body0->GetID() > body1->GetID();
 
-        for (int i = 0; i < numManifolds; ++i)
+        if (contactPairs_.empty() || contactPairs_.back().id_ != manifoldRef.pairId_)
         {
-            btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
-            // First check that there are actual contacts, as the manifold exists also when objects are close but not touching
-            if (!contactManifold->getNumContacts())
-                continue;
+            PhysicsContactPair pair;
+            pair.id_ = manifoldRef.pairId_;
+            pair.bodyA_ = flipped ? body1 : body0;
+            pair.bodyB_ = flipped ? body0 : body1;
+            pair.firstContact_ = contacts_.size();
+            pair.trigger_ = body0->IsTrigger() || body1->IsTrigger();
+
+            while (previousIter != previousPairIds_.end() && *previousIter < pair.id_)
+                ++previousIter;
+            pair.started_ = previousIter == previousPairIds_.end() || *previousIter != pair.id_;
+
+            contactPairs_.push_back(pair);
+            contactPairBodies_.emplace_back(WeakPtr<RigidBody>(pair.bodyA_), WeakPtr<RigidBody>(pair.bodyB_));
+        }
 
-            const btCollisionObject* objectA = contactManifold->getBody0();
-            const btCollisionObject* objectB = contactManifold->getBody1();
+        PhysicsContactPair& pair = contactPairs_.back();
+        const int numContacts = contactManifold->getNumContacts();
+        for (int j = 0; j < numContacts; ++j)
+        {
+            const btManifoldPoint& point = contactManifold->getContactPoint(j);
+            PhysicsContact contact;
+            contact.position_ = ToVector3(point.m_positionWorldOnB);
+            contact.normal_ = flipped ? -ToVector3(point.m_normalWorldOnB) : ToVector3(point.m_normalWorldOnB);
+            contact.distance_ = point.m_distance1;
+            contact.impulse_ = point.m_appliedImpulse;
+            contacts_.push_back(contact);
+        }
+        pair.numContacts_ += numContacts;
+    }
 
-            auto* bodyA = static_cast<RigidBody*>(objectA->getUserPointer());
-            auto* bodyB = static_cast<RigidBody*>(objectB->getUserPointer());
-            // If it's not a rigidbody, maybe a ghost object
-            if (!bodyA || !bodyB)
-                continue;
+    // Pairs of the previous step that are missing now have ended. Both lists are sorted by identifier
+    Scene* scene = GetScene();
+    auto currentIter = contactPairs_.begin();
+    for (unsigned long long pairId : previousPairIds_)
+    {
+        while (currentIter != contactPairs_.end() && currentIter->id_ < pairId)
+            ++currentIter;
+        if ((currentIter != contactPairs_.end() && currentIter->id_ == pairId) || !scene)
+            continue;
+
+        // Bodies may have been removed since the previous step, look them up by ID
+        auto* bodyA = dynamic_cast<RigidBody*>(scene->GetComponent((unsigned)(pairId >> 32u)));
+        auto* bodyB = dynamic_cast<RigidBody*>(scene->GetComponent((unsigned)(pairId & M_MAX_UNSIGNED)));
+        if (!bodyA || !bodyB || !IsCollisionReported(bodyA, bodyB))
+            continue;
+
+        PhysicsContactPair pair;
+        pair.id_ = pairId;
+        pair.bodyA_ = bodyA;
+        pair.bodyB_ = bodyB;
+        pair.firstContact_ = contacts_.size();
+        pair.trigger_ = bodyA->IsTrigger() || bodyB->IsTrigger();
+        endedContactPairs_.push_back(pair);
+    }
 
-            // Skip collision event signaling if both objects are static, or if collision event mode does not match
-            if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
-                continue;
-            if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
-                continue;
-            if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
-                !bodyA->IsActive() && !bodyB->IsActive())
-                continue;
+    for (const PhysicsContactPair& pair : endedContactPairs_)
+        contactPairBodies_.emplace_back(WeakPtr<RigidBody>(pair.bodyA_), WeakPtr<RigidBody>(pair.bodyB_));
 
-            WeakPtr<RigidBody> bodyWeakA(bodyA);
-            WeakPtr<RigidBody> bodyWeakB(bodyB);
+    previousPairIds_.clear();
+    for (const PhysicsContactPair& pair : contactPairs_)
+        previousPairIds_.push_back(pair.id_);
+}
 
-            // First only store the collision pair as weak pointers and the manifold pointer, so user code can safely destroy
-            // objects during collision event handling
-            ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> > bodyPair;
-            if (bodyA < bodyB)
-            {
-                bodyPair = ea::make_pair(bodyWeakA, bodyWeakB);
-                currentCollisions_[bodyPair].manifold_ = contactManifold;
-            }
-            else
-            {
-                bodyPair = ea::make_pair(bodyWeakB, bodyWeakA);
-                currentCollisions_[bodyPair].flippedManifold_ = contactManifold;
-            }
-        }
+void PhysicsWorld::WriteEventContacts(const PhysicsContactPair& pair, bool flip)
+{
+    eventContacts_.Clear();
+    for (const PhysicsContact& contact : GetContacts(pair))
+    {
+        eventContacts_.WriteVector3(contact.position_);
+        eventContacts_.WriteVector3(flip ? -contact.normal_ : contact.normal_);
+        eventContacts_.WriteFloat(contact.distance_);
+        eventContacts_.WriteFloat(contact.impulse_);
+    }
+}
+
+void PhysicsWorld::SendCollisionEvents()
+{
+    URHO3D_PROFILE("SendCollisionEvents");
+
+    physicsCollisionData_.clear();
+    nodeCollisionData_.clear();
 
-        for (auto i = currentCollisions_.begin();
-             i != currentCollisions_.end(); ++i)
+    // Bodies are checked through the weak pointers, so user code can safely destroy objects during collision event handling
+    const unsigned numPairs = contactPairs_.size();
+    if (numPairs)
+    {
+        physicsCollisionData_[PhysicsCollision::P_WORLD] = this;
+
+        for (unsigned i = 0; i < numPairs; ++i)
         {
-            RigidBody* bodyA = i->first.first;
-            RigidBody* bodyB = i->first.second;
+            const PhysicsContactPair& pair = contactPairs_[i];
+            const WeakPtr<RigidBody>& bodyWeakA = contactPairBodies_[i].first;
+            const WeakPtr<RigidBody>& bodyWeakB = contactPairBodies_[i].second;
+            RigidBody* bodyA = bodyWeakA;
+            RigidBody* bodyB = bodyWeakB;
             if (!bodyA || !bodyB)
                 continue;
 
@@ -899,113 +1286,57 @@ void PhysicsWorld::SendCollisionEvents()
             WeakPtr<Node> nodeWeakA(nodeA);
             WeakPtr<Node> nodeWeakB(nodeB);
 
-            bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
-            bool newCollision = !previousCollisions_.contains(i->first);
-
             physicsCollisionData_[PhysicsCollision::P_NODEA] = nodeA;
             physicsCollisionData_[PhysicsCollision::P_NODEB] = nodeB;
             physicsCollisionData_[PhysicsCollision::P_BODYA] = bodyA;
             physicsCollisionData_[PhysicsCollision::P_BODYB] = bodyB;
-            physicsCollisionData_[PhysicsCollision::P_TRIGGER] = trigger;
+            physicsCollisionData_[PhysicsCollision::P_TRIGGER] = pair.trigger_;
 
-            contacts_.Clear();
-
-            // "Pointers not flipped"-manifold, send unmodified normals
-            btPersistentManifold* contactManifold = i->second.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            // "Pointers flipped"-manifold, flip normals also
-            contactManifold = i->second.flippedManifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-
-            physicsCollisionData_[PhysicsCollision::P_CONTACTS] = contacts_.GetBuffer();
+            WriteEventContacts(pair, false);
+            physicsCollisionData_[PhysicsCollision::P_CONTACTS] = eventContacts_.GetBuffer();
 
             // Send separate collision start event if collision is new
-            if (newCollision)
+            if (pair.started_)
             {
                 SendEvent(E_PHYSICSCOLLISIONSTART, physicsCollisionData_);
                 // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
                     continue;
             }
 
             // Then send the ongoing collision event
             SendEvent(E_PHYSICSCOLLISION, physicsCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+            if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
                 continue;
 
             nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
             nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
             nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+            nodeCollisionData_[NodeCollision::P_TRIGGER] = pair.trigger_;
+            nodeCollisionData_[NodeCollision::P_CONTACTS] = eventContacts_.GetBuffer();
 
-            if (newCollision)
+            if (pair.started_)
             {
                 nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
                     continue;
             }
 
             nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+            if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
                 continue;
 
             // Flip perspective to body B
-            contacts_.Clear();
-            contactManifold = i->second.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            contactManifold = i->second.flippedManifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-
+            WriteEventContacts(pair, true);
             nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
             nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
             nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+            nodeCollisionData_[NodeCollision::P_CONTACTS] = eventContacts_.GetBuffer();
 
-            if (newCollision)
+            if (pair.started_)
             {
                 nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
                     continue;
             }
 
@@ -1014,69 +1345,62 @@ void PhysicsWorld::SendCollisionEvents()
     }
 
     // Send collision end events as applicable
+    const unsigned numEndedPairs = endedContactPairs_.size();
+    if (numEndedPairs)
     {
         physicsCollisionData_[PhysicsCollisionEnd::P_WORLD] = this;
 
-        for (auto
-                 i = previousCollisions_.begin(); i != previousCollisions_.end(); ++i)
+        for (unsigned i = 0; i < numEndedPairs; ++i)
         {
-            if (!currentCollisions_.contains(i->first))
-            {
-                RigidBody* bodyA = i->first.first;
-                RigidBody* bodyB = i->first.second;
-                if (!bodyA || !bodyB)
-                    continue;
-
-                bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
-
-                // Skip collision event signaling if both objects are static, or if collision event mode does not match
-                if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
-                    continue;
-                if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
-                    continue;
-                if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
-                    !bodyA->IsActive() && !bodyB->IsActive())
-                    continue;
+            const PhysicsContactPair& pair = endedContactPairs_[i];
+            const WeakPtr<RigidBody>& bodyWeakA = contactPairBodies_[numPairs + i].first;
+            const WeakPtr<RigidBody>& bodyWeakB = contactPairBodies_[numPairs + i].second;
+            RigidBody* bodyA = bodyWeakA;
+            RigidBody* bodyB = bodyWeakB;
+            if (!bodyA || !bodyB)
+                continue;
 
-                Node* nodeA = bodyA->GetNode();
-                Node* nodeB = bodyB->GetNode();
-                WeakPtr<Node> nodeWeakA(nodeA);
-                WeakPtr<Node> nodeWeakB(nodeB);
+            Node* nodeA = bodyA->GetNode();
+            Node* nodeB = bodyB->GetNode();
+            WeakPtr<Node> nodeWeakA(nodeA);
+            WeakPtr<Node> nodeWeakB(nodeB);
 
-                physicsCollisionData_[PhysicsCollisionEnd::P_BODYA] = bodyA;
-                physicsCollisionData_[PhysicsCollisionEnd::P_BODYB] = bodyB;
-                physicsCollisionData_[PhysicsCollisionEnd::P_NODEA] = nodeA;
-                physicsCollisionData_[PhysicsCollisionEnd::P_NODEB] = nodeB;
-                physicsCollisionData_[PhysicsCollisionEnd::P_TRIGGER] = trigger;
+            physicsCollisionData_[PhysicsCollisionEnd::P_BODYA] = bodyA;
+            physicsCollisionData_[PhysicsCollisionEnd::P_BODYB] = bodyB;
+            physicsCollisionData_[PhysicsCollisionEnd::P_NODEA] = nodeA;
+            physicsCollisionData_[PhysicsCollisionEnd::P_NODEB] = nodeB;
+            physicsCollisionData_[PhysicsCollisionEnd::P_TRIGGER] = pair.trigger_;
 
-                SendEvent(E_PHYSICSCOLLISIONEND, physicsCollisionData_);
-                // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
-                    continue;
+            SendEvent(E_PHYSICSCOLLISIONEND, physicsCollisionData_);
+            // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
+            if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
+                continue;
 
-                nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyA;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeB;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyB;
-                nodeCollisionData_[NodeCollisionEnd::P_TRIGGER] = trigger;
+            nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyA;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeB;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyB;
+            nodeCollisionData_[NodeCollisionEnd::P_TRIGGER] = pair.trigger_;
 
-                nodeA->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
-                    continue;
+            nodeA->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
+            if (!nodeWeakA || !nodeWeakB || !bodyWeakA || !bodyWeakB)
+                continue;
 
-                nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyB;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeA;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyA;
+            nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyB;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeA;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyA;
 
-                nodeB->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
-            }
+            nodeB->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
         }
     }
-
-    previousCollisions_ = currentCollisions_;
 }
 
 void RegisterPhysicsLibrary(Context* context)
 {
+#if BT_THREADSAFE
+    // Bullet assigns thread index 0 to the first thread that asks for it, make sure it is the main thread
+    btGetCurrentThreadIndex();
+#endif
+
     CollisionShape::RegisterObject(context);
     RigidBody::RegisterObject(context);
     Constraint::RegisterObject(context);
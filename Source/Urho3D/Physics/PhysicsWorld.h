@@ -22,10 +22,13 @@
 
 #pragma once
 
+#include <EASTL/span.h>
 #include <EASTL/unique_ptr.h>
 
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Scene/Component.h"
@@ -49,7 +52,6 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -78,6 +80,34 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
+/// Physics raycast or swept sphere query for batched execution.
+struct URHO3D_API PhysicsRaycastQuery
+{
+    /// Ray origin and direction.
+    Ray ray_;
+    /// Maximum distance along the ray.
+    float maxDistance_{};
+    /// Sphere radius for swept sphere test, or zero for raycast.
+    float radius_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Physics swept convex query for batched execution.
+struct URHO3D_API PhysicsConvexCastQuery
+{
+    /// Start position.
+    Vector3 startPos_;
+    /// Start rotation.
+    Quaternion startRot_;
+    /// End position.
+    Vector3 endPos_;
+    /// End rotation.
+    Quaternion endRot_;
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -91,32 +121,62 @@ struct DelayedWorldTransform
     Quaternion worldRotation_;
 };
 
-/// Manifold pointers stored during collision processing.
-struct ManifoldPair
+/// Contact point in the physics contact stream.
+struct URHO3D_API PhysicsContact
 {
-    /// Construct with defaults.
-    ManifoldPair() :
-        manifold_(nullptr),
-        flippedManifold_(nullptr)
-    {
-    }
+    /// Contact worldspace position.
+    Vector3 position_;
+    /// Contact worldspace normal, pointing from body B towards body A.
+    Vector3 normal_;
+    /// Contact distance, negative when penetrating.
+    float distance_{};
+    /// Impulse applied by the solver.
+    float impulse_{};
+};
 
-    /// Manifold without the body pointers flipped.
+/// Colliding rigid body pair in the physics contact stream.
+struct URHO3D_API PhysicsContactPair
+{
+    /// Pair identifier composed of the component IDs of both bodies. Stays the same for as long as the pair is colliding.
+    unsigned long long id_{};
+    /// Rigid body with the lower component ID.
+    RigidBody* bodyA_{};
+    /// Rigid body with the higher component ID.
+    RigidBody* bodyB_{};
+    /// Index of the first contact point in the contact stream.
+    unsigned firstContact_{};
+    /// Number of contact points.
+    unsigned numContacts_{};
+    /// Whether either body is a trigger.
+    bool trigger_{};
+    /// Whether the pair started colliding on this step.
+    bool started_{};
+};
+
+/// Manifold reference stored during contact stream building.
+struct ContactManifoldRef
+{
+    /// Pair identifier.
+    unsigned long long pairId_;
+    /// Index of the manifold in the dispatcher, used for deterministic ordering.
+    int index_;
+    /// Manifold.
     btPersistentManifold* manifold_;
-    /// Manifold with the body pointers flipped.
-    btPersistentManifold* flippedManifold_;
 };
 
 /// Custom overrides of physics internals. To use overrides, must be set before the physics component is created.
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        multithreaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Use multithreaded Bullet world, which runs narrowphase, island solving and integration in WorkQueue worker threads. Requires the URHO3D_PHYSICS_MULTITHREADED build option.
+    bool multithreaded_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -192,6 +252,11 @@ public:
     void SetSplitImpulse(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set directory for cached triangle mesh BVH data. Relative paths are resolved from the resource directory of each model. Empty (default) disables the cache.
+    void SetBvhCacheDir(const ea::string& path);
+    /// Set whether to send collision events. The contact stream is updated regardless. Enabled by default.
+    /// @property
+    void SetCollisionEventsEnabled(bool enable);
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (ea::vector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -209,6 +274,12 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a batch of raycasts and swept sphere tests and return the closest hit for each query. Results are stored in query order. Queries are executed in worker threads when possible.
+    void RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsRaycastQuery> queries);
+    /// Perform a batch of swept convex tests using a user-supplied collision shape and return the first hit for each query. Results are stored in query order. Queries are executed in worker threads when possible.
+    void ConvexCastBatch(ea::vector<PhysicsRaycastResult>& results, CollisionShape* shape, ea::span<const PhysicsConvexCastQuery> queries);
+    /// Perform a batch of swept convex tests using a user-supplied Bullet collision shape and return the first hit for each query. Results are stored in query order. Queries are executed in worker threads when possible.
+    void ConvexCastBatch(ea::vector<PhysicsRaycastResult>& results, btCollisionShape* shape, ea::span<const PhysicsConvexCastQuery> queries);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -217,7 +288,7 @@ public:
     void GetRigidBodies(ea::vector<RigidBody*>& result, const BoundingBox& box, unsigned collisionMask = M_MAX_UNSIGNED);
     /// Return rigid bodies by contact test with the specified body. It needs to be active to return all contacts reliably.
     void GetRigidBodies(ea::vector<RigidBody*>& result, const RigidBody* body);
-    /// Return rigid bodies that have been in collision with the specified body on the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions.
+    /// Return rigid bodies that have been in collision with the specified body on the last simulation step. Only returns collisions that are reported in the contact stream (depends on collision event mode) and excludes e.g. static-static collisions.
     void GetCollidingBodies(ea::vector<RigidBody*>& result, const RigidBody* body);
 
     /// Return gravity.
@@ -255,6 +326,25 @@ public:
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return directory for cached triangle mesh BVH data.
+    const ea::string& GetBvhCacheDir() const { return bvhCacheDir_; }
+
+    /// Return whether collision events are sent.
+    /// @property
+    bool GetCollisionEventsEnabled() const { return collisionEventsEnabled_; }
+
+    /// Return colliding pairs of the last simulation step, sorted by pair identifier. Valid until the next step. Body pointers are not guarded against removal, so check them if bodies may be removed in collision event handlers.
+    const ea::vector<PhysicsContactPair>& GetContactPairs() const { return contactPairs_; }
+    /// Return pairs that stopped colliding on the last simulation step. Pairs whose bodies were removed are not included, and the pairs have no contact points.
+    const ea::vector<PhysicsContactPair>& GetEndedContactPairs() const { return endedContactPairs_; }
+    /// Return contact points of the last simulation step. Each pair references a contiguous range.
+    const ea::vector<PhysicsContact>& GetContacts() const { return contacts_; }
+    /// Return contact points of a colliding pair.
+    ea::span<const PhysicsContact> GetContacts(const PhysicsContactPair& pair) const
+    {
+        return ea::span<const PhysicsContact>(contacts_.data() + pair.firstContact_, pair.numContacts_);
+    }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
@@ -269,6 +359,8 @@ public:
     void RemoveConstraint(Constraint* constraint);
     /// Add a delayed world transform assignment. Called by RigidBody.
     void AddDelayedWorldTransform(const DelayedWorldTransform& transform);
+    /// Mark the collision shapes in the world changed. Called by RigidBody when its shape changes or it is added to or removed from the world.
+    void MarkCollisionShapesDirty() { gImpactShapesDirty_ = true; }
     /// Add debug geometry to the debug renderer.
     void DrawDebugGeometry(bool depthTest);
     /// Set debug renderer to use. Called both by PhysicsWorld itself and physics components.
@@ -300,6 +392,9 @@ public:
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
 
+    /// Return whether the world was created as multithreaded.
+    bool IsMultithreaded() const { return multithreaded_; }
+
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
 
@@ -314,8 +409,14 @@ private:
     void PreStep(float timeStep);
     /// Trigger update after each physics simulation step.
     void PostStep(float timeStep);
-    /// Send accumulated collision events.
+    /// Rebuild the contact stream from the collision dispatcher manifolds.
+    void UpdateContactStream();
+    /// Send collision events from the contact stream.
     void SendCollisionEvents();
+    /// Write contact points of a pair to the event contact buffer, optionally with normals flipped for the perspective of body B.
+    void WriteEventContacts(const PhysicsContactPair& pair, bool flip);
+    /// Return whether any collision object uses a GImpact shape. Cached until the collision shapes change.
+    bool HasGImpactShapes();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -335,10 +436,18 @@ private:
     ea::vector<CollisionShape*> collisionShapes_;
     /// Constraints in the world.
     ea::vector<Constraint*> constraints_;
-    /// Collision pairs on this frame.
-    ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> currentCollisions_;
-    /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
-    ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
+    /// Manifolds with contacts on this step, sorted by pair identifier.
+    ea::vector<ContactManifoldRef> contactManifolds_;
+    /// Colliding pairs on this step.
+    ea::vector<PhysicsContactPair> contactPairs_;
+    /// Pairs that stopped colliding on this step.
+    ea::vector<PhysicsContactPair> endedContactPairs_;
+    /// Contact points on this step.
+    ea::vector<PhysicsContact> contacts_;
+    /// Sorted identifiers of the pairs colliding on the previous step. Used to check if a collision is "new."
+    ea::vector<unsigned long long> previousPairIds_;
+    /// Weak pointers to the bodies of the colliding pairs followed by the ended pairs. Used to detect removal during collision event handling.
+    ea::vector<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> > > contactPairBodies_;
     /// Delayed (parented) world transform assignments.
     ea::unordered_map<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
@@ -351,8 +460,10 @@ private:
     VariantMap physicsCollisionData_;
     /// Preallocated event data map for node collision events.
     VariantMap nodeCollisionData_;
-    /// Preallocated buffer for physics collision contact data.
-    VectorBuffer contacts_;
+    /// Directory for cached triangle mesh BVH data.
+    ea::string bvhCacheDir_;
+    /// Preallocated buffer for physics collision event contact data.
+    VectorBuffer eventContacts_;
     /// Simulation substeps per second.
     unsigned fps_{DEFAULT_FPS};
     /// Maximum number of simulation substeps per frame. 0 (default) unlimited, or negative values for adaptive timestep.
@@ -371,6 +482,14 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Multithreaded world flag.
+    bool multithreaded_{};
+    /// Whether any collision object uses a GImpact shape.
+    bool hasGImpactShapes_{};
+    /// GImpact shapes need to be looked up again flag.
+    bool gImpactShapesDirty_{true};
+    /// Collision events enabled flag.
+    bool collisionEventsEnabled_{true};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
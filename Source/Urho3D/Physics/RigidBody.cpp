@@ -783,6 +783,7 @@ void RigidBody::UpdateMass()
 
     btCollisionShape* oldCollisionShape = body_->getCollisionShape();
     body_->setCollisionShape(useCompound ? shiftedCompoundShape_.get() : shiftedCompoundShape_->getChildShape(0));
+    physicsWorld_->MarkCollisionShapesDirty();
 
     // If we have one shape and this is a triangle mesh, we use a custom material callback in order to adjust internal edges
     if (!useCompound && body_->getCollisionShape()->getShapeType() == SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE &&
@@ -1012,6 +1013,7 @@ void RigidBody::AddBodyToWorld()
 
     btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
     world->addRigidBody(body_.get(), (short)collisionLayer_, (short)collisionMask_);
+    physicsWorld_->MarkCollisionShapesDirty();
     inWorld_ = true;
     readdBody_ = false;
     hasSimulated_ = false;
@@ -1031,6 +1033,7 @@ void RigidBody::RemoveBodyFromWorld()
     {
         btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
         world->removeRigidBody(body_.get());
+        physicsWorld_->MarkCollisionShapesDirty();
         inWorld_ = false;
     }
 }
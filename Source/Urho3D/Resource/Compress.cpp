@@ -0,0 +1,495 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Resource/Compress.h"
+
+#include <cstring>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Number of pixels in a block.
+const unsigned BLOCK_PIXELS = 16;
+
+/// Block of 4x4 RGBA pixels in row-major order.
+struct PixelBlock
+{
+    unsigned char rgba_[BLOCK_PIXELS][4];
+};
+
+/// Encoded color part of a block.
+struct ColorEncoding
+{
+    unsigned short color0_{};
+    unsigned short color1_{};
+    unsigned char indices_[BLOCK_PIXELS]{};
+    unsigned error_{M_MAX_UNSIGNED};
+};
+
+/// Fetch a block of pixels, repeating the last row and column for edge blocks.
+void FetchBlock(const unsigned char* rgba, int width, int height, int blockX, int blockY, PixelBlock& block)
+{
+    for (int y = 0; y < 4; ++y)
+    {
+        const int sourceY = Min(blockY * 4 + y, height - 1);
+        for (int x = 0; x < 4; ++x)
+        {
+            const int sourceX = Min(blockX * 4 + x, width - 1);
+            memcpy(block.rgba_[y * 4 + x], &rgba[(sourceY * width + sourceX) * 4], 4);
+        }
+    }
+}
+
+/// Quantize color in 0-255 range to RGB565.
+unsigned short Pack565(const float* color)
+{
+    const int red = Clamp(RoundToInt(color[0] * 31.0f / 255.0f), 0, 31);
+    const int green = Clamp(RoundToInt(color[1] * 63.0f / 255.0f), 0, 63);
+    const int blue = Clamp(RoundToInt(color[2] * 31.0f / 255.0f), 0, 31);
+    return (unsigned short)((red << 11) | (green << 5) | blue);
+}
+
+/// Expand RGB565 to 8 bits per channel the same way as the decoder does.
+void Unpack565(unsigned short value, int* color)
+{
+    const int red = (value >> 11) & 0x1f;
+    const int green = (value >> 5) & 0x3f;
+    const int blue = value & 0x1f;
+    color[0] = (red << 3) | (red >> 2);
+    color[1] = (green << 2) | (green >> 4);
+    color[2] = (blue << 3) | (blue >> 2);
+}
+
+/// Assign the nearest four-color palette entry to each pixel. Return total squared error.
+unsigned FindColorIndices(const PixelBlock& block, const int (&palette)[4][3], unsigned char* indices)
+{
+    unsigned error = 0;
+
+#ifdef URHO3D_SSE
+    // Process 4 pixels at once: red and green are interleaved for one multiply-add, blue is paired with zero for another
+    for (unsigned quad = 0; quad < BLOCK_PIXELS; quad += 4)
+    {
+        const unsigned char (*pixels)[4] = &block.rgba_[quad];
+        const __m128i redGreen = _mm_setr_epi16(pixels[0][0], pixels[0][1], pixels[1][0], pixels[1][1],
+            pixels[2][0], pixels[2][1], pixels[3][0], pixels[3][1]);
+        const __m128i blue = _mm_setr_epi16(pixels[0][2], 0, pixels[1][2], 0, pixels[2][2], 0, pixels[3][2], 0);
+
+        __m128i bestDistance = _mm_set1_epi32(M_MAX_INT);
+        __m128i bestIndex = _mm_setzero_si128();
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i diffRedGreen = _mm_sub_epi16(redGreen, _mm_setr_epi16(palette[i][0], palette[i][1],
+                palette[i][0], palette[i][1], palette[i][0], palette[i][1], palette[i][0], palette[i][1]));
+            const __m128i diffBlue = _mm_sub_epi16(blue, _mm_setr_epi16(palette[i][2], 0, palette[i][2], 0,
+                palette[i][2], 0, palette[i][2], 0));
+            const __m128i distance = _mm_add_epi32(_mm_madd_epi16(diffRedGreen, diffRedGreen), _mm_madd_epi16(diffBlue, diffBlue));
+
+            const __m128i closer = _mm_cmplt_epi32(distance, bestDistance);
+            bestDistance = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, bestDistance));
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(i)), _mm_andnot_si128(closer, bestIndex));
+        }
+
+        alignas(16) int distances[4];
+        alignas(16) int quadIndices[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(distances), bestDistance);
+        _mm_store_si128(reinterpret_cast<__m128i*>(quadIndices), bestIndex);
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            indices[quad + j] = (unsigned char)quadIndices[j];
+            error += distances[j];
+        }
+    }
+#else
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        const unsigned char* pixel = block.rgba_[i];
+        int bestDistance = M_MAX_INT;
+        for (int j = 0; j < 4; ++j)
+        {
+            const int diffRed = pixel[0] - palette[j][0];
+            const int diffGreen = pixel[1] - palette[j][1];
+            const int diffBlue = pixel[2] - palette[j][2];
+            const int distance = diffRed * diffRed + diffGreen * diffGreen + diffBlue * diffBlue;
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                indices[i] = (unsigned char)j;
+            }
+        }
+        error += bestDistance;
+    }
+#endif
+
+    return error;
+}
+
+/// Quantize endpoints, find indices and keep the result if it is better than the current one.
+bool EvaluateColorEndpoints(const PixelBlock& block, const float* endpoint0, const float* endpoint1, ColorEncoding& best)
+{
+    ColorEncoding candidate;
+    candidate.color0_ = Pack565(endpoint0);
+    candidate.color1_ = Pack565(endpoint1);
+
+    int palette[4][3];
+    Unpack565(candidate.color0_, palette[0]);
+    Unpack565(candidate.color1_, palette[1]);
+    for (int i = 0; i < 3; ++i)
+    {
+        palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+        palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+    }
+
+    candidate.error_ = FindColorIndices(block, palette, candidate.indices_);
+    if (candidate.error_ >= best.error_)
+        return false;
+
+    best = candidate;
+    return true;
+}
+
+/// Calculate endpoints from the bounding box of the block colors, inset slightly to reduce quantization error.
+void CalculateBoundingBoxEndpoints(const PixelBlock& block, float* endpoint0, float* endpoint1)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        int minValue = 255;
+        int maxValue = 0;
+        for (unsigned j = 0; j < BLOCK_PIXELS; ++j)
+        {
+            minValue = Min(minValue, (int)block.rgba_[j][i]);
+            maxValue = Max(maxValue, (int)block.rgba_[j][i]);
+        }
+
+        const float inset = (maxValue - minValue) / 16.0f;
+        endpoint0[i] = maxValue - inset;
+        endpoint1[i] = minValue + inset;
+    }
+}
+
+/// Calculate endpoints from the extents of the block colors along their principal axis.
+void CalculatePrincipalAxisEndpoints(const PixelBlock& block, float* endpoint0, float* endpoint1)
+{
+    float mean[3]{};
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            mean[j] += block.rgba_[i][j];
+    }
+    for (float& value : mean)
+        value /= BLOCK_PIXELS;
+
+    // Symmetric covariance matrix: rr, rg, rb, gg, gb, bb
+    float covariance[6]{};
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        const float red = block.rgba_[i][0] - mean[0];
+        const float green = block.rgba_[i][1] - mean[1];
+        const float blue = block.rgba_[i][2] - mean[2];
+        covariance[0] += red * red;
+        covariance[1] += red * green;
+        covariance[2] += red * blue;
+        covariance[3] += green * green;
+        covariance[4] += green * blue;
+        covariance[5] += blue * blue;
+    }
+
+    // Power iteration for the dominant eigenvector, starting from the bounding box diagonal
+    float boxMin[3], boxMax[3];
+    CalculateBoundingBoxEndpoints(block, boxMax, boxMin);
+    float axis[3] = { boxMax[0] - boxMin[0], boxMax[1] - boxMin[1], boxMax[2] - boxMin[2] };
+    for (int iteration = 0; iteration < 4; ++iteration)
+    {
+        const float red = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+        const float green = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+        const float blue = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+        const float length = Max(Max(Abs(red), Abs(green)), Abs(blue));
+        if (length < M_EPSILON)
+            break;
+        axis[0] = red / length;
+        axis[1] = green / length;
+        axis[2] = blue / length;
+    }
+
+    // Use the extreme pixels along the axis
+    float minDot = M_INFINITY;
+    float maxDot = -M_INFINITY;
+    unsigned minIndex = 0;
+    unsigned maxIndex = 0;
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        const float dot = block.rgba_[i][0] * axis[0] + block.rgba_[i][1] * axis[1] + block.rgba_[i][2] * axis[2];
+        if (dot < minDot)
+        {
+            minDot = dot;
+            minIndex = i;
+        }
+        if (dot > maxDot)
+        {
+            maxDot = dot;
+            maxIndex = i;
+        }
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        endpoint0[i] = block.rgba_[maxIndex][i];
+        endpoint1[i] = block.rgba_[minIndex][i];
+    }
+}
+
+/// Solve endpoints that minimize the squared error for the given indices. Return false if the system is degenerate.
+bool RefineColorEndpoints(const PixelBlock& block, const unsigned char* indices, float* endpoint0, float* endpoint1)
+{
+    // Weight of endpoint 0 for each palette index
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+    float alphaX[3]{}, betaX[3]{};
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        const float alpha = weights[indices[i]];
+        const float beta = 1.0f - alpha;
+        alpha2 += alpha * alpha;
+        beta2 += beta * beta;
+        alphaBeta += alpha * beta;
+        for (int j = 0; j < 3; ++j)
+        {
+            alphaX[j] += alpha * block.rgba_[i][j];
+            betaX[j] += beta * block.rgba_[i][j];
+        }
+    }
+
+    const float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+    if (Abs(determinant) < M_EPSILON)
+        return false;
+
+    const float factor = 1.0f / determinant;
+    for (int j = 0; j < 3; ++j)
+    {
+        endpoint0[j] = Clamp((alphaX[j] * beta2 - betaX[j] * alphaBeta) * factor, 0.0f, 255.0f);
+        endpoint1[j] = Clamp((betaX[j] * alpha2 - alphaX[j] * alphaBeta) * factor, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+/// Encode the color part of a block. Always uses the four-color mode, as DXT3 and DXT5 do not support the three-color mode.
+void EncodeColorBlock(const PixelBlock& block, CompressionQuality quality, unsigned char* dest)
+{
+    float endpoint0[3], endpoint1[3];
+    if (quality == COMPRESSION_FAST)
+        CalculateBoundingBoxEndpoints(block, endpoint0, endpoint1);
+    else
+        CalculatePrincipalAxisEndpoints(block, endpoint0, endpoint1);
+
+    ColorEncoding best;
+    EvaluateColorEndpoints(block, endpoint0, endpoint1, best);
+
+    const int refinements = quality == COMPRESSION_HIGH ? 4 : quality == COMPRESSION_NORMAL ? 1 : 0;
+    for (int i = 0; i < refinements && best.error_ > 0; ++i)
+    {
+        if (!RefineColorEndpoints(block, best.indices_, endpoint0, endpoint1))
+            break;
+        if (!EvaluateColorEndpoints(block, endpoint0, endpoint1, best))
+            break;
+    }
+
+    // Four-color mode requires color0 > color1, swapping the endpoints swaps indices 0-1 and 2-3
+    unsigned char flip = 0;
+    if (best.color0_ < best.color1_)
+    {
+        ea::swap(best.color0_, best.color1_);
+        flip = 1;
+    }
+    else if (best.color0_ == best.color1_)
+        memset(best.indices_, 0, sizeof best.indices_);
+
+    dest[0] = (unsigned char)(best.color0_ & 0xff);
+    dest[1] = (unsigned char)(best.color0_ >> 8);
+    dest[2] = (unsigned char)(best.color1_ & 0xff);
+    dest[3] = (unsigned char)(best.color1_ >> 8);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const unsigned char* rowIndices = &best.indices_[i * 4];
+        dest[4 + i] = (unsigned char)((rowIndices[0] ^ flip) | ((rowIndices[1] ^ flip) << 2) |
+            ((rowIndices[2] ^ flip) << 4) | ((rowIndices[3] ^ flip) << 6));
+    }
+}
+
+/// Encode explicit 4-bit alpha of a DXT3 block.
+void EncodeAlphaBlockDXT3(const PixelBlock& block, unsigned char* dest)
+{
+    for (unsigned i = 0; i < BLOCK_PIXELS; i += 2)
+    {
+        const int low = (block.rgba_[i][3] * 15 + 127) / 255;
+        const int high = (block.rgba_[i + 1][3] * 15 + 127) / 255;
+        dest[i / 2] = (unsigned char)(low | (high << 4));
+    }
+}
+
+/// Build DXT5 alpha codebook the same way as the decoder does.
+void BuildAlphaCodes(int alpha0, int alpha1, int (&codes)[8])
+{
+    codes[0] = alpha0;
+    codes[1] = alpha1;
+    if (alpha0 <= alpha1)
+    {
+        for (int i = 1; i < 5; ++i)
+            codes[1 + i] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        codes[6] = 0;
+        codes[7] = 255;
+    }
+    else
+    {
+        for (int i = 1; i < 7; ++i)
+            codes[1 + i] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    }
+}
+
+/// Assign the nearest alpha code to each pixel. Return total squared error.
+unsigned FindAlphaIndices(const PixelBlock& block, const int (&codes)[8], unsigned char* indices)
+{
+    unsigned error = 0;
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        int bestDistance = M_MAX_INT;
+        for (int j = 0; j < 8; ++j)
+        {
+            const int diff = block.rgba_[i][3] - codes[j];
+            if (diff * diff < bestDistance)
+            {
+                bestDistance = diff * diff;
+                indices[i] = (unsigned char)j;
+            }
+        }
+        error += bestDistance;
+    }
+    return error;
+}
+
+/// Encode interpolated alpha of a DXT5 block.
+void EncodeAlphaBlockDXT5(const PixelBlock& block, CompressionQuality quality, unsigned char* dest)
+{
+    int minAlpha = 255, maxAlpha = 0;
+    int minInnerAlpha = 255, maxInnerAlpha = 0;
+    for (unsigned i = 0; i < BLOCK_PIXELS; ++i)
+    {
+        const int alpha = block.rgba_[i][3];
+        minAlpha = Min(minAlpha, alpha);
+        maxAlpha = Max(maxAlpha, alpha);
+        if (alpha != 0 && alpha != 255)
+        {
+            minInnerAlpha = Min(minInnerAlpha, alpha);
+            maxInnerAlpha = Max(maxInnerAlpha, alpha);
+        }
+    }
+
+    // Eight-code mode spanning the whole range
+    int alpha0 = maxAlpha;
+    int alpha1 = minAlpha;
+    int codes[8];
+    unsigned char indices[BLOCK_PIXELS];
+    BuildAlphaCodes(alpha0, alpha1, codes);
+    unsigned error = FindAlphaIndices(block, codes, indices);
+
+    // Six-code mode with explicit 0 and 255, better for blocks mixing cutout and soft alpha
+    if (quality == COMPRESSION_HIGH && error > 0 && minInnerAlpha <= maxInnerAlpha)
+    {
+        int innerCodes[8];
+        unsigned char innerIndices[BLOCK_PIXELS];
+        BuildAlphaCodes(minInnerAlpha, maxInnerAlpha, innerCodes);
+        const unsigned innerError = FindAlphaIndices(block, innerCodes, innerIndices);
+        if (innerError < error)
+        {
+            alpha0 = minInnerAlpha;
+            alpha1 = maxInnerAlpha;
+            memcpy(indices, innerIndices, sizeof indices);
+        }
+    }
+
+    dest[0] = (unsigned char)alpha0;
+    dest[1] = (unsigned char)alpha1;
+    for (unsigned half = 0; half < 2; ++half)
+    {
+        unsigned value = 0;
+        for (unsigned i = 0; i < 8; ++i)
+            value |= (unsigned)indices[half * 8 + i] << (3 * i);
+        for (unsigned i = 0; i < 3; ++i)
+            dest[2 + half * 3 + i] = (unsigned char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+}
+
+bool CompressImageDXT(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressedFormat format,
+    CompressionQuality quality, int beginBlockRow, int endBlockRow)
+{
+    if (format != CF_DXT1 && format != CF_DXT3 && format != CF_DXT5)
+        return false;
+    if (!blocks || !rgba || width <= 0 || height <= 0)
+        return false;
+
+    const int blocksWide = (width + 3) / 4;
+    const int blocksHigh = (height + 3) / 4;
+    const unsigned blockSize = format == CF_DXT1 ? 8 : 16;
+    endBlockRow = Min(endBlockRow, blocksHigh);
+
+    PixelBlock block;
+    for (int blockY = Max(beginBlockRow, 0); blockY < endBlockRow; ++blockY)
+    {
+        unsigned char* dest = &blocks[blockY * blocksWide * blockSize];
+        for (int blockX = 0; blockX < blocksWide; ++blockX, dest += blockSize)
+        {
+            FetchBlock(rgba, width, height, blockX, blockY, block);
+            switch (format)
+            {
+            case CF_DXT3:
+                EncodeAlphaBlockDXT3(block, dest);
+                EncodeColorBlock(block, quality, dest + 8);
+                break;
+
+            case CF_DXT5:
+                EncodeAlphaBlockDXT5(block, quality, dest);
+                EncodeColorBlock(block, quality, dest + 8);
+                break;
+
+            default:
+                EncodeColorBlock(block, quality, dest);
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
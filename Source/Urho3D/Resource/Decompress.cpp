@@ -25,6 +25,11 @@
 #include "../Resource/Decompress.h"
 
 #include <cstdint>
+#include <cstring>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 
 // ETC2 decompress
 typedef unsigned char uint8;
@@ -86,7 +91,7 @@ static int Unpack565(unsigned char const* packed, unsigned char* colour)
     return value;
 }
 
-static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isDxt1)
+static void DecompressColourPaletteDXT(unsigned* palette, void const* block, bool isDxt1)
 {
     // get the block bytes
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -118,29 +123,11 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
     codes[8 + 3] = 255;
     codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
 
-    // unpack the indices
-    unsigned char indices[16];
-    for (int i = 0; i < 4; ++i)
-    {
-        unsigned char* ind = indices + 4 * i;
-        unsigned char packed = bytes[4 + i];
-
-        ind[0] = (unsigned char)(packed & 0x3);
-        ind[1] = (unsigned char)((packed >> 2) & 0x3);
-        ind[2] = (unsigned char)((packed >> 4) & 0x3);
-        ind[3] = (unsigned char)((packed >> 6) & 0x3);
-    }
-
-    // store out the colours
-    for (int i = 0; i < 16; ++i)
-    {
-        auto offset = (unsigned char)(4 * indices[i]);
-        for (int j = 0; j < 4; ++j)
-            rgba[4 * i + j] = codes[offset + j];
-    }
+    // store the codes as whole pixels
+    memcpy(palette, codes, sizeof codes);
 }
 
-static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
+static void DecompressAlphaDXT3(unsigned char* alpha, void const* block)
 {
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
 
@@ -155,12 +142,12 @@ static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
         auto hi = (unsigned char)(quant & 0xf0);
 
         // convert back up to bytes
-        rgba[8 * i + 3] = lo | (lo << 4);
-        rgba[8 * i + 7] = hi | (hi >> 4);
+        alpha[2 * i] = lo | (lo << 4);
+        alpha[2 * i + 1] = hi | (hi >> 4);
     }
 }
 
-static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
+static void DecompressAlphaDXT5(unsigned char* alpha, void const* block)
 {
     // get the two alpha values
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -186,97 +173,111 @@ static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
             codes[1 + i] = (unsigned char)(((7 - i) * alpha0 + i * alpha1) / 7);
     }
 
-    // decode the indices
-    unsigned char indices[16];
-    unsigned char const* src = bytes + 2;
-    unsigned char* dest = indices;
-    for (int i = 0; i < 2; ++i)
-    {
-        // grab 3 bytes
-        int value = 0;
-        for (int j = 0; j < 3; ++j)
-        {
-            int byte = *src++;
-            value |= (byte << 8 * j);
-        }
-
-        // unpack 8 3-bit values from it
-        for (int j = 0; j < 8; ++j)
-        {
-            int index = (value >> 3 * j) & 0x7;
-            *dest++ = (unsigned char)index;
-        }
-    }
+    // grab all 48 bits of indices at once
+    uint64_t value = 0;
+    for (int i = 0; i < 6; ++i)
+        value |= (uint64_t)bytes[2 + i] << (8 * i);
 
     // write out the indexed codebook values
     for (int i = 0; i < 16; ++i)
-        rgba[4 * i + 3] = codes[indices[i]];
+        alpha[i] = codes[(value >> (3 * i)) & 0x7];
 }
 
-static void DecompressDXT(unsigned char* rgba, const void* block, CompressedFormat format)
+/// Decompress a DXT block and write its visible part to the image.
+static void DecompressBlockDXT(unsigned char* rgba, int pitch, int visibleWidth, int visibleHeight, const unsigned char* block,
+    CompressedFormat format)
 {
     // get the block locations
-    void const* colourBlock = block;
-    void const* alphaBock = block;
-    if (format == CF_DXT3 || format == CF_DXT5)
-        colourBlock = reinterpret_cast< unsigned char const* >( block ) + 8;
+    const unsigned char* colourBlock = format == CF_DXT1 ? block : block + 8;
 
-    // decompress colour
-    DecompressColourDXT(rgba, colourBlock, format == CF_DXT1);
+    unsigned palette[4];
+    DecompressColourPaletteDXT(palette, colourBlock, format == CF_DXT1);
 
     // decompress alpha separately if necessary
+    unsigned char alpha[16];
     if (format == CF_DXT3)
-        DecompressAlphaDXT3(rgba, alphaBock);
+        DecompressAlphaDXT3(alpha, block);
     else if (format == CF_DXT5)
-        DecompressAlphaDXT5(rgba, alphaBock);
-}
+        DecompressAlphaDXT5(alpha, block);
+
+#ifdef URHO3D_SSE
+    const __m128i colour0 = _mm_set1_epi32(palette[0]);
+    const __m128i colour1 = _mm_set1_epi32(palette[1]);
+    const __m128i colour2 = _mm_set1_epi32(palette[2]);
+    const __m128i colour3 = _mm_set1_epi32(palette[3]);
+    // Select each pixel's 2-bit index from the row byte in its own lane, avoiding per-lane shifts
+    const __m128i indexMask = _mm_setr_epi32(0x03, 0x0c, 0x30, 0xc0);
+    const __m128i index1 = _mm_setr_epi32(0x01, 0x04, 0x10, 0x40);
+    const __m128i index2 = _mm_setr_epi32(0x02, 0x08, 0x20, 0x80);
+    const __m128i colourMask = _mm_set1_epi32(0x00ffffff);
+    const __m128i zero = _mm_setzero_si128();
+#endif
+
+    for (int y = 0; y < visibleHeight; ++y)
+    {
+        const unsigned indexRow = colourBlock[4 + y];
+        unsigned char pixels[16];
+
+#ifdef URHO3D_SSE
+        const __m128i indices = _mm_and_si128(_mm_set1_epi32(indexRow), indexMask);
+        const __m128i select0 = _mm_cmpeq_epi32(indices, zero);
+        const __m128i select1 = _mm_cmpeq_epi32(indices, index1);
+        const __m128i select2 = _mm_cmpeq_epi32(indices, index2);
+        const __m128i select3 = _mm_cmpeq_epi32(indices, indexMask);
+        __m128i row = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(select0, colour0), _mm_and_si128(select1, colour1)),
+            _mm_or_si128(_mm_and_si128(select2, colour2), _mm_and_si128(select3, colour3)));
+
+        if (format != CF_DXT1)
+        {
+            int alphaRow;
+            memcpy(&alphaRow, &alpha[y * 4], sizeof alphaRow);
+            const __m128i alphaBytes = _mm_cvtsi32_si128(alphaRow);
+            const __m128i alphaWords = _mm_unpacklo_epi8(alphaBytes, zero);
+            const __m128i alphaValues = _mm_slli_epi32(_mm_unpacklo_epi16(alphaWords, zero), 24);
+            row = _mm_or_si128(_mm_and_si128(row, colourMask), alphaValues);
+        }
 
-void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
-{
-    // initialise the block input
-    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
-    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), row);
+#else
+        for (int x = 0; x < 4; ++x)
+            memcpy(&pixels[4 * x], &palette[(indexRow >> (2 * x)) & 0x3], 4);
 
-    // loop over blocks
-    for (int z = 0; z < depth; ++z)
-    {
-        int sz = width * height * 4 * z;
-        for (int y = 0; y < height; y += 4)
+        if (format != CF_DXT1)
         {
-            for (int x = 0; x < width; x += 4)
-            {
-                // decompress the block
-                unsigned char targetRgba[4 * 16];
-                DecompressDXT(targetRgba, sourceBlock, format);
+            for (int x = 0; x < 4; ++x)
+                pixels[4 * x + 3] = alpha[y * 4 + x];
+        }
+#endif
 
-                // write the decompressed pixels to the correct image locations
-                unsigned char const* sourcePixel = targetRgba;
-                for (int py = 0; py < 4; ++py)
-                {
-                    for (int px = 0; px < 4; ++px)
-                    {
-                        // get the target location
-                        int sx = x + px;
-                        int sy = y + py;
-                        if (sx < width && sy < height)
-                        {
-                            unsigned char* targetPixel = rgba + sz + 4 * (width * sy + sx);
-
-                            // copy the rgba value
-                            for (int i = 0; i < 4; ++i)
-                                *targetPixel++ = *sourcePixel++;
-                        }
-                        else
-                        {
-                            // skip this pixel as its outside the image
-                            sourcePixel += 4;
-                        }
-                    }
-                }
+        memcpy(rgba + y * pitch, pixels, visibleWidth * 4);
+    }
+}
 
-                // advance
-                sourceBlock += bytesPerBlock;
-            }
+void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    int beginBlockRow, int endBlockRow)
+{
+    // initialise the block input
+    auto const* sourceBlocks = reinterpret_cast< unsigned char const* >( blocks );
+    const int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    const int blocksWide = (width + 3) / 4;
+    const int blocksHigh = (height + 3) / 4;
+    const int pitch = width * 4;
+    endBlockRow = Min(endBlockRow, blocksHigh * depth);
+
+    // loop over block rows of all slices
+    for (int blockRow = Max(beginBlockRow, 0); blockRow < endBlockRow; ++blockRow)
+    {
+        const int z = blockRow / blocksHigh;
+        const int y = (blockRow % blocksHigh) * 4;
+        const int visibleHeight = Min(height - y, 4);
+
+        unsigned char const* sourceBlock = sourceBlocks + blockRow * blocksWide * bytesPerBlock;
+        unsigned char* targetRow = rgba + (z * height + y) * pitch;
+        for (int x = 0; x < width; x += 4)
+        {
+            DecompressBlockDXT(targetRow + x * 4, pitch, Min(width - x, 4), visibleHeight, sourceBlock, format);
+            sourceBlock += bytesPerBlock;
         }
     }
 }
@@ -909,23 +910,26 @@ static void ReadBigEndian4byteWord(uint32_t* pBlock, const unsigned char *s)
 }
 
 // Use ETCPACK to decompress ETC texture.
-void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha)
+void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha, int beginBlockRow,
+    int endBlockRow)
 {
     // ETCPACK initialization.
     static const bool placeholder = []() { setupAlphaTable(); return true; }();
 
     const int channelCount = hasAlpha ? 4 : 3;
-    unsigned char* src = (unsigned char*)blocks;
+    const int bytesPerBlock = hasAlpha ? 16 : 8;
     unsigned int blockPart1, blockPart2;
 
     // ETCPACK write 4x4 blocks, so it needs padding.
     int w4 = ((width + 3) / 4);
     int h4 = ((height + 3) / 4);
+    endBlockRow = Min(endBlockRow, h4);
 
     unsigned char buffer4x4[4 * 4 * 4];
 
-    for (int y = 0; y < h4; ++y)
+    for (int y = Max(beginBlockRow, 0); y < endBlockRow; ++y)
     {
+        unsigned char* src = (unsigned char*)blocks + y * w4 * bytesPerBlock;
         for (int x = 0; x < w4; ++x)
         {
             memset(&buffer4x4[0], 0xFF, 4 * 4 * 4);
@@ -941,20 +945,11 @@ void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width,
             src += 4;
             decompressBlockETC2c(blockPart1, blockPart2, &buffer4x4[0], 4, 4, 0, 0, 4);
 
+            // copy whole rows of the visible part
             int wbuf = Min(width - x * 4, 4);
             int hbuf = Min(height - y * 4, 4);
-            for(int dy = 0; dy < hbuf; ++dy)
-            {
-                for (int dx = 0; dx < wbuf; ++dx)
-                {
-                    int idst = ((y * 4 + dy) * width + x * 4 + dx) * 4;
-                    int ibuf = (dy * 4 + dx) * 4;
-                    dstImage[idst] = buffer4x4[ibuf];
-                    dstImage[idst + 1] = buffer4x4[ibuf + 1];
-                    dstImage[idst + 2] = buffer4x4[ibuf + 2];
-                    dstImage[idst + 3] = buffer4x4[ibuf + 3];
-                }
-            }
+            for (int dy = 0; dy < hbuf; ++dy)
+                memcpy(&dstImage[((y * 4 + dy) * width + x * 4) * 4], &buffer4x4[dy * 4 * 4], wbuf * 4);
         }
     }
 }
@@ -22,16 +22,18 @@
 
 #pragma once
 
+#include "../Math/MathDefs.h"
 #include "../Resource/Image.h"
 
 namespace Urho3D
 {
 
-/// Decompress a DXT compressed image to RGBA.
-URHO3D_API void
-    DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format);
-/// Decompress an ETC1/ETC2 compressed image to RGBA.
-URHO3D_API void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha);
+/// Decompress a DXT compressed image to RGBA. Optionally decompress only a range of block rows, counted through all depth slices, which may be done from several threads at once.
+URHO3D_API void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    int beginBlockRow = 0, int endBlockRow = M_MAX_INT);
+/// Decompress an ETC1/ETC2 compressed image to RGBA. Optionally decompress only a range of block rows, which may be done from several threads at once.
+URHO3D_API void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha,
+    int beginBlockRow = 0, int endBlockRow = M_MAX_INT);
 /// Decompress a PVRTC compressed image to RGBA.
 URHO3D_API void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format);
 /// Flip a compressed block vertically.
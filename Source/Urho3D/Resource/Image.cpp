@@ -24,12 +24,18 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/Compress.h"
 #include "../Resource/Decompress.h"
 
 #include <SDL/SDL_surface.h>
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 #include <STB/stb_image.h>
 #include <STB/stb_image_write.h>
 #ifdef URHO3D_WEBP
@@ -214,26 +220,92 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
-bool CompressedLevel::Decompress(unsigned char* dest) const
+/// Minimum amount of output pixels before image filtering is split between worker threads.
+static const int MIN_THREADED_FILTER_PIXELS = 128 * 128;
+/// Resolution of the linear to sRGB conversion table.
+static const int LINEAR_TO_SRGB_TABLE_SIZE = 4096;
+
+/// Lookup tables for sRGB filtering.
+struct SRGBTables
+{
+    SRGBTables()
+    {
+        for (int i = 0; i < 256; ++i)
+            toLinear_[i] = Color::ConvertGammaToLinear(i / 255.0f);
+        for (int i = 0; i < LINEAR_TO_SRGB_TABLE_SIZE; ++i)
+        {
+            const float value = Color::ConvertLinearToGamma(i / (float)(LINEAR_TO_SRGB_TABLE_SIZE - 1));
+            toSRGB_[i] = (unsigned char)Clamp(RoundToInt(value * 255.0f), 0, 255);
+        }
+    }
+
+    /// Convert linear value in range 0-1 to sRGB byte.
+    unsigned char ToSRGB(float value) const
+    {
+        return toSRGB_[Clamp(RoundToInt(value * (LINEAR_TO_SRGB_TABLE_SIZE - 1)), 0, LINEAR_TO_SRGB_TABLE_SIZE - 1)];
+    }
+
+    /// sRGB byte to linear value.
+    float toLinear_[256];
+    /// Linear value to sRGB byte.
+    unsigned char toSRGB_[LINEAR_TO_SRGB_TABLE_SIZE];
+};
+
+/// Return sRGB lookup tables. Initialized on first use.
+static const SRGBTables& GetSRGBTables()
+{
+    static const SRGBTables tables;
+    return tables;
+}
+
+/// Process image rows, splitting the work between worker threads if called from the main thread and the image is large enough.
+template <class T> static void ProcessImageRows(Context* context, int numRows, int rowPixels, const T& processRows)
+{
+    auto* queue = context ? context->GetSubsystem<WorkQueue>() : nullptr;
+    const bool threaded = queue && queue->GetNumThreads() && !queue->IsCompleting() && Thread::IsMainThread()
+        && numRows * rowPixels >= MIN_THREADED_FILTER_PIXELS;
+    if (!threaded)
+    {
+        processRows(0, numRows);
+        return;
+    }
+
+    // Worker threads + main thread
+    const int numItems = Min(numRows, (int)queue->GetNumThreads() + 1);
+    const int rowsPerItem = (numRows + numItems - 1) / numItems;
+    for (int beginRow = 0; beginRow < numRows; beginRow += rowsPerItem)
+    {
+        const int endRow = Min(beginRow + rowsPerItem, numRows);
+        queue->AddWorkItem([&processRows, beginRow, endRow]() { processRows(beginRow, endRow); }, M_MAX_UNSIGNED);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+bool CompressedLevel::Decompress(unsigned char* dest, Context* context) const
 {
     if (!data_)
         return false;
 
+    const int blockRows = (height_ + 3) / 4;
     switch (format_)
     {
     case CF_DXT1:
     case CF_DXT3:
     case CF_DXT5:
-        DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
+        ProcessImageRows(context, blockRows * depth_, width_ * 4, [&](int beginRow, int endRow)
+        {
+            DecompressImageDXT(dest, data_, width_, height_, depth_, format_, beginRow, endRow);
+        });
         return true;
 
     // ETC2 format is compatible with ETC1, so we just use the same function.
     case CF_ETC1:
     case CF_ETC2_RGB:
-        DecompressImageETC(dest, data_, width_, height_, false);
-        return true;
     case CF_ETC2_RGBA:
-        DecompressImageETC(dest, data_, width_, height_, true);
+        ProcessImageRows(context, blockRows, width_ * 4, [&](int beginRow, int endRow)
+        {
+            DecompressImageETC(dest, data_, width_, height_, format_ == CF_ETC2_RGBA, beginRow, endRow);
+        });
         return true;
 
     case CF_PVRTC_RGB_2BPP:
@@ -249,6 +321,144 @@ bool CompressedLevel::Decompress(unsigned char* dest) const
     }
 }
 
+/// Downsample rows of a 2D image by 2x2 box filter.
+static void DownsampleRows2D(const unsigned char* pixelDataIn, unsigned char* pixelDataOut, int widthIn, int widthOut,
+    unsigned components, int beginRow, int endRow)
+{
+    const unsigned rowSizeIn = widthIn * components;
+    const unsigned rowSizeOut = widthOut * components;
+
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        const unsigned char* inUpper = &pixelDataIn[(y * 2) * rowSizeIn];
+        const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * rowSizeIn];
+        unsigned char* out = &pixelDataOut[y * rowSizeOut];
+        int x = 0;
+
+#ifdef URHO3D_SSE
+        const __m128i zero = _mm_setzero_si128();
+        if (components == 4)
+        {
+            // 8 input pixels to 4 output pixels per iteration
+            for (; x + 4 <= widthOut; x += 4)
+            {
+                __m128i result[2];
+                for (unsigned half = 0; half < 2; ++half)
+                {
+                    const __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 8 + half * 16]));
+                    const __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 8 + half * 16]));
+                    // Sum vertically as 16-bit, then add horizontally adjacent pixels
+                    const __m128i sumLeft = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+                    const __m128i sumRight = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+                    const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(sumLeft, sumRight), _mm_unpackhi_epi64(sumLeft, sumRight));
+                    result[half] = _mm_srli_epi16(sum, 2);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x * 4]), _mm_packus_epi16(result[0], result[1]));
+            }
+        }
+        else if (components == 1)
+        {
+            // 16 input pixels to 8 output pixels per iteration
+            const __m128i lowMask = _mm_set1_epi16(0xff);
+            for (; x + 8 <= widthOut; x += 8)
+            {
+                const __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 2]));
+                const __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 2]));
+                const __m128i sumUpper = _mm_add_epi16(_mm_and_si128(upper, lowMask), _mm_srli_epi16(upper, 8));
+                const __m128i sumLower = _mm_add_epi16(_mm_and_si128(lower, lowMask), _mm_srli_epi16(lower, 8));
+                const __m128i result = _mm_srli_epi16(_mm_add_epi16(sumUpper, sumLower), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(result, result));
+            }
+        }
+#endif
+
+        for (unsigned i = x * components; i < rowSizeOut; ++i)
+        {
+            const unsigned c = i % components;
+            const unsigned left = (i - c) * 2 + c;
+            out[i] = (unsigned char)(((unsigned)inUpper[left] + inUpper[left + components] +
+                                      inLower[left] + inLower[left + components]) >> 2);
+        }
+    }
+}
+
+/// Downsample rows of a 2D RGB or RGBA image by 2x2 box filter in linear color space.
+static void DownsampleRows2DSRGB(const unsigned char* pixelDataIn, unsigned char* pixelDataOut, int widthIn, int widthOut,
+    unsigned components, int beginRow, int endRow)
+{
+    const SRGBTables& tables = GetSRGBTables();
+    const unsigned rowSizeIn = widthIn * components;
+    const unsigned rowSizeOut = widthOut * components;
+
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        const unsigned char* inUpper = &pixelDataIn[(y * 2) * rowSizeIn];
+        const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * rowSizeIn];
+        unsigned char* out = &pixelDataOut[y * rowSizeOut];
+
+        for (unsigned i = 0; i < rowSizeOut; i += components)
+        {
+            const unsigned left = i * 2;
+            const unsigned right = left + components;
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                const float sum = tables.toLinear_[inUpper[left + c]] + tables.toLinear_[inUpper[right + c]] +
+                    tables.toLinear_[inLower[left + c]] + tables.toLinear_[inLower[right + c]];
+                out[i + c] = tables.ToSRGB(sum * 0.25f);
+            }
+            // Alpha is always linear
+            if (components == 4)
+            {
+                out[i + 3] = (unsigned char)(((unsigned)inUpper[left + 3] + inUpper[right + 3] +
+                                              inLower[left + 3] + inLower[right + 3]) >> 2);
+            }
+        }
+    }
+}
+
+/// Source pixel contributions of each destination pixel along one image axis.
+struct ResampleAxis
+{
+    /// Construct for given source and destination size. Downsampling uses box filter over the whole source footprint, upsampling uses linear filter.
+    ResampleAxis(int srcSize, int dstSize)
+    {
+        offsets_.resize(dstSize + 1);
+        for (int i = 0; i < dstSize; ++i)
+        {
+            offsets_[i] = taps_.size();
+            if (dstSize < srcSize)
+            {
+                const float scale = (float)srcSize / (float)dstSize;
+                const float begin = i * scale;
+                const float end = Min(begin + scale, (float)srcSize);
+                for (int j = FloorToInt(begin); j < end; ++j)
+                {
+                    const float weight = Min(end, j + 1.0f) - Max(begin, (float)j);
+                    if (weight > 0.0f)
+                        taps_.emplace_back(j, weight / scale);
+                }
+            }
+            else
+            {
+                // Match the sampling positions of GetPixelBilinear()
+                const float coord = dstSize > 1 ? (float)i / (float)(dstSize - 1) : 0.0f;
+                const float pos = Clamp(coord * srcSize - 0.5f, 0.0f, (float)(srcSize - 1));
+                const int first = (int)pos;
+                const float fract = pos - first;
+                taps_.emplace_back(first, 1.0f - fract);
+                if (fract > 0.0f)
+                    taps_.emplace_back(Min(first + 1, srcSize - 1), fract);
+            }
+        }
+        offsets_[dstSize] = taps_.size();
+    }
+
+    /// Offsets into the taps for each destination pixel, followed by the total number of taps.
+    ea::vector<unsigned> offsets_;
+    /// Source pixel index and weight.
+    ea::vector<ea::pair<int, float>> taps_;
+};
+
 Image::Image(Context* context) :
     Resource(context)
 {
@@ -1187,36 +1397,66 @@ bool Image::Resize(int width, int height)
     if (!data_ || width <= 0 || height <= 0)
         return false;
 
-    /// \todo Reducing image size does not sample all needed pixels
+    // Filter separably: horizontally into a linear intermediate buffer, then vertically into the new image
+    const ResampleAxis axisX(width_, width);
+    const ResampleAxis axisY(height_, height);
+    const unsigned components = components_;
+    const bool sRGB = sRGB_ && components >= 3;
+    const SRGBTables& tables = GetSRGBTables();
+
+    ea::vector<float> intermediate(height_ * width * components);
+    const unsigned char* pixelDataIn = data_.get();
+    float* intermediateData = intermediate.data();
+    const int widthIn = width_;
+    ProcessImageRows(context_, height_, width, [&](int beginRow, int endRow)
+    {
+        for (int y = beginRow; y < endRow; ++y)
+        {
+            const unsigned char* in = &pixelDataIn[y * widthIn * components];
+            float* out = &intermediateData[y * width * components];
+            for (int x = 0; x < width; ++x)
+            {
+                float sum[4]{};
+                for (unsigned tap = axisX.offsets_[x]; tap < axisX.offsets_[x + 1]; ++tap)
+                {
+                    const unsigned char* src = &in[axisX.taps_[tap].first * components];
+                    const float weight = axisX.taps_[tap].second;
+                    for (unsigned c = 0; c < components; ++c)
+                        sum[c] += weight * (sRGB && c < 3 ? tables.toLinear_[src[c]] : src[c] / 255.0f);
+                }
+                for (unsigned c = 0; c < components; ++c)
+                    out[x * components + c] = sum[c];
+            }
+        }
+    });
+
     ea::shared_array<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
+    unsigned char* pixelDataOut = newData.get();
+    const unsigned rowSize = width * components;
+    ProcessImageRows(context_, height, width, [&](int beginRow, int endRow)
     {
-        for (int x = 0; x < width; ++x)
+        ea::vector<float> sum(rowSize);
+        for (int y = beginRow; y < endRow; ++y)
         {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData.get() + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
+            ea::fill(sum.begin(), sum.end(), 0.0f);
+            for (unsigned tap = axisY.offsets_[y]; tap < axisY.offsets_[y + 1]; ++tap)
+            {
+                const float* src = &intermediateData[axisY.taps_[tap].first * rowSize];
+                const float weight = axisY.taps_[tap].second;
+                for (unsigned i = 0; i < rowSize; ++i)
+                    sum[i] += weight * src[i];
+            }
 
-            switch (components_)
+            unsigned char* out = &pixelDataOut[y * rowSize];
+            for (unsigned i = 0; i < rowSize; ++i)
             {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
+                if (sRGB && i % components < 3)
+                    out[i] = tables.ToSRGB(sum[i]);
+                else
+                    out[i] = (unsigned char)Clamp(RoundToInt(sum[i] * 255.0f), 0, 255);
             }
         }
-    }
+    });
 
     width_ = width;
     height_ = height;
@@ -1350,21 +1590,54 @@ bool Image::SaveDDS(const ea::string& fileName) const
         return false;
     }
 
-    if (IsCompressed())
+    unsigned fourCC = 0;
+    switch (compressedFormat_)
     {
-        URHO3D_LOGERROR("Can not save compressed image to DDS");
+    case CF_NONE:
+        break;
+    case CF_DXT1:
+        fourCC = FOURCC_DXT1;
+        break;
+    case CF_DXT3:
+        fourCC = FOURCC_DXT3;
+        break;
+    case CF_DXT5:
+        fourCC = FOURCC_DXT5;
+        break;
+    default:
+        URHO3D_LOGERROR("Can not save compressed image of this format to DDS");
         return false;
     }
 
-    if (components_ != 4)
+    if (!fourCC && components_ != 4)
     {
         URHO3D_LOGERRORF("Can not save image with %u components to DDS", components_);
         return false;
     }
 
-    // Write image
+    // Cubemap faces and array slices are written one after another, each with its own mip chain
+    ea::vector<const Image*> faces;
+    for (const Image* face = this; face; face = face->nextSibling_)
+    {
+        if (face->width_ != width_ || face->height_ != height_ || face->components_ != components_ ||
+            face->compressedFormat_ != compressedFormat_ || face->numCompressedLevels_ != numCompressedLevels_)
+        {
+            URHO3D_LOGERROR("Can not save cubemap or array with differing faces to DDS");
+            return false;
+        }
+        faces.push_back(face);
+    }
+    if (cubemap_ && faces.size() != 6)
+    {
+        URHO3D_LOGERROR("Can not save cubemap without 6 faces to DDS");
+        return false;
+    }
+    const bool writeArray = !cubemap_ && faces.size() > 1;
+
     ea::vector<const Image*> levels;
-    GetLevels(levels);
+    if (!fourCC)
+        GetLevels(levels);
+    const unsigned numLevels = fourCC ? Max(numCompressedLevels_, 1u) : levels.size();
 
     outFile.WriteFileID("DDS ");
 
@@ -1375,18 +1648,89 @@ bool Image::SaveDDS(const ea::string& fileName) const
         | 0x00000002l /*DDSD_HEIGHT*/ | 0x00000004l /*DDSD_WIDTH*/ | 0x00020000l /*DDSD_MIPMAPCOUNT*/ | 0x00001000l /*DDSD_PIXELFORMAT*/;
     ddsd.dwWidth_ = width_;
     ddsd.dwHeight_ = height_;
-    ddsd.dwMipMapCount_ = levels.size();
-    ddsd.ddpfPixelFormat_.dwFlags_ = 0x00000040l /*DDPF_RGB*/ | 0x00000001l /*DDPF_ALPHAPIXELS*/;
+    ddsd.dwMipMapCount_ = numLevels;
     ddsd.ddpfPixelFormat_.dwSize_ = sizeof(ddsd.ddpfPixelFormat_);
-    ddsd.ddpfPixelFormat_.dwRGBBitCount_ = 32;
-    ddsd.ddpfPixelFormat_.dwRBitMask_ = 0x000000ff;
-    ddsd.ddpfPixelFormat_.dwGBitMask_ = 0x0000ff00;
-    ddsd.ddpfPixelFormat_.dwBBitMask_ = 0x00ff0000;
-    ddsd.ddpfPixelFormat_.dwRGBAlphaBitMask_ = 0xff000000;
+    if (fourCC)
+    {
+        const unsigned blockSize = compressedFormat_ == CF_DXT1 ? 8 : 16;
+        ddsd.dwFlags_ |= 0x00080000l /*DDSD_LINEARSIZE*/;
+        ddsd.dwLinearSize_ = ((width_ + 3) / 4) * ((height_ + 3) / 4) * blockSize;
+        ddsd.ddpfPixelFormat_.dwFlags_ = 0x00000004l /*DDPF_FOURCC*/;
+        ddsd.ddpfPixelFormat_.dwFourCC_ = fourCC;
+    }
+    else
+    {
+        ddsd.dwFlags_ |= 0x00000008l /*DDSD_PITCH*/;
+        ddsd.lPitch_ = width_ * 4;
+        ddsd.ddpfPixelFormat_.dwFlags_ = 0x00000040l /*DDPF_RGB*/ | 0x00000001l /*DDPF_ALPHAPIXELS*/;
+        ddsd.ddpfPixelFormat_.dwRGBBitCount_ = 32;
+        ddsd.ddpfPixelFormat_.dwRBitMask_ = 0x000000ff;
+        ddsd.ddpfPixelFormat_.dwGBitMask_ = 0x0000ff00;
+        ddsd.ddpfPixelFormat_.dwBBitMask_ = 0x00ff0000;
+        ddsd.ddpfPixelFormat_.dwRGBAlphaBitMask_ = 0xff000000;
+    }
+
+    ddsd.ddsCaps_.dwCaps_ = DDSCAPS_TEXTURE;
+    if (numLevels > 1)
+        ddsd.ddsCaps_.dwCaps_ |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    if (cubemap_)
+    {
+        ddsd.ddsCaps_.dwCaps_ |= DDSCAPS_COMPLEX;
+        ddsd.ddsCaps_.dwCaps2_ = DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALL_FACES;
+    }
+
+    // Arrays and sRGB formats can only be described with the DX10 header
+    const bool writeDX10 = writeArray || sRGB_;
+    DDSHeader10 dxgiHeader;     // NOLINT(hicpp-member-init)
+    if (writeDX10)
+    {
+        memset(&dxgiHeader, 0, sizeof(dxgiHeader));
+        switch (compressedFormat_)
+        {
+        case CF_DXT1:
+            dxgiHeader.dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC1_UNORM_SRGB : DDS_DXGI_FORMAT_BC1_UNORM;
+            break;
+        case CF_DXT3:
+            dxgiHeader.dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC2_UNORM_SRGB : DDS_DXGI_FORMAT_BC2_UNORM;
+            break;
+        case CF_DXT5:
+            dxgiHeader.dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC3_UNORM_SRGB : DDS_DXGI_FORMAT_BC3_UNORM;
+            break;
+        default:
+            dxgiHeader.dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DDS_DXGI_FORMAT_R8G8B8A8_UNORM;
+            break;
+        }
+        dxgiHeader.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+        // A cubemap is an array of one cube
+        dxgiHeader.miscFlag = cubemap_ ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+        dxgiHeader.arraySize = cubemap_ ? 1 : faces.size();
+        ddsd.ddpfPixelFormat_.dwFlags_ |= 0x00000004l /*DDPF_FOURCC*/;
+        ddsd.ddpfPixelFormat_.dwFourCC_ = FOURCC_DX10;
+    }
 
     outFile.Write(&ddsd, sizeof(ddsd));
-    for (unsigned i = 0; i < levels.size(); ++i)
-        outFile.Write(levels[i]->GetData(), levels[i]->GetWidth() * levels[i]->GetHeight() * 4);
+    if (writeDX10)
+        outFile.Write(&dxgiHeader, sizeof(dxgiHeader));
+
+    for (const Image* face : faces)
+    {
+        if (fourCC)
+        {
+            // Compressed levels are stored consecutively, write them as is
+            outFile.Write(face->data_.get(), face->GetMemoryUse());
+            continue;
+        }
+
+        if (face != this)
+            face->GetLevels(levels);
+        if (levels.size() != numLevels)
+        {
+            URHO3D_LOGERROR("Can not save cubemap or array faces with differing mip levels to DDS");
+            return false;
+        }
+        for (unsigned i = 0; i < levels.size(); ++i)
+            outFile.Write(levels[i]->GetData(), levels[i]->GetWidth() * levels[i]->GetHeight() * 4);
+    }
 
     return true;
 }
@@ -1636,6 +1980,7 @@ SharedPtr<Image> Image::GetNextLevel() const
         mipImage->SetSize(widthOut, heightOut, depthOut, components_);
     else
         mipImage->SetSize(widthOut, heightOut, components_);
+    mipImage->sRGB_ = sRGB_;
 
     const unsigned char* pixelDataIn = data_.get();
     unsigned char* pixelDataOut = mipImage->data_.get();
@@ -1689,83 +2034,22 @@ SharedPtr<Image> Image::GetNextLevel() const
     // 2D case
     else if (depth_ == 1)
     {
-        switch (components_)
+        const int widthIn = width_;
+        const unsigned components = components_;
+        // Alpha-only and luminance images are never filtered as sRGB
+        if (sRGB_ && components >= 3)
         {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
+            ProcessImageRows(context_, heightOut, widthOut, [=](int beginRow, int endRow)
             {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
+                DownsampleRows2DSRGB(pixelDataIn, pixelDataOut, widthIn, widthOut, components, beginRow, endRow);
+            });
+        }
+        else
+        {
+            ProcessImageRows(context_, heightOut, widthOut, [=](int beginRow, int endRow)
             {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
+                DownsampleRows2D(pixelDataIn, pixelDataOut, widthIn, widthOut, components, beginRow, endRow);
+            });
         }
     }
     // 3D case
@@ -2120,11 +2404,93 @@ SharedPtr<Image> Image::GetDecompressedImage() const
 
     auto decompressedImage = MakeShared<Image>(context_);
     decompressedImage->SetSize(compressedLevel.width_, compressedLevel.height_, 4);
-    compressedLevel.Decompress(decompressedImage->GetData());
+    compressedLevel.Decompress(decompressedImage->GetData(), context_);
 
     return decompressedImage;
 }
 
+SharedPtr<Image> Image::GetCompressedImage(CompressedFormat format, CompressionQuality quality, unsigned numLevels) const
+{
+    if (format != CF_DXT1 && format != CF_DXT3 && format != CF_DXT5)
+    {
+        URHO3D_LOGERROR("Unsupported image compression format");
+        return nullptr;
+    }
+    if (IsCompressed())
+    {
+        URHO3D_LOGERROR("Image is already compressed");
+        return nullptr;
+    }
+    if (depth_ > 1)
+    {
+        URHO3D_LOGERROR("Compressing 3D images is not supported");
+        return nullptr;
+    }
+
+    URHO3D_PROFILE("CompressImage");
+
+    SharedPtr<Image> level = ConvertToRGBA();
+    if (!level)
+        return nullptr;
+    level->SetSRGB(sRGB_);
+
+    ea::vector<SharedPtr<Image> > levels;
+    levels.push_back(level);
+    while ((!numLevels || levels.size() < numLevels) && (level->GetWidth() > 1 || level->GetHeight() > 1))
+    {
+        level = level->GetNextLevel();
+        if (!level)
+            return nullptr;
+        levels.push_back(level);
+    }
+
+    const unsigned blockSize = format == CF_DXT1 ? 8 : 16;
+    unsigned dataSize = 0;
+    for (const SharedPtr<Image>& image : levels)
+        dataSize += ((image->GetWidth() + 3) / 4) * ((image->GetHeight() + 3) / 4) * blockSize;
+
+    ea::shared_array<unsigned char> data(new unsigned char[dataSize]);
+    unsigned offset = 0;
+    for (const SharedPtr<Image>& image : levels)
+    {
+        const int width = image->GetWidth();
+        const int height = image->GetHeight();
+        const int blocksWide = (width + 3) / 4;
+        const int blocksHigh = (height + 3) / 4;
+        unsigned char* blocks = data.get() + offset;
+        const unsigned char* pixels = image->GetData();
+
+        ProcessImageRows(context_, blocksHigh, blocksWide * 16, [=](int beginRow, int endRow)
+        {
+            CompressImageDXT(blocks, pixels, width, height, format, quality, beginRow, endRow);
+        });
+        offset += blocksWide * blocksHigh * blockSize;
+    }
+
+    auto compressedImage = MakeShared<Image>(context_);
+    compressedImage->width_ = width_;
+    compressedImage->height_ = height_;
+    compressedImage->depth_ = 1;
+    compressedImage->components_ = format == CF_DXT1 ? 3 : 4;
+    compressedImage->compressedFormat_ = format;
+    compressedImage->numCompressedLevels_ = levels.size();
+    compressedImage->sRGB_ = sRGB_;
+    compressedImage->data_ = data;
+    compressedImage->SetMemoryUse(dataSize);
+
+    // Compress the remaining faces of a cubemap or array
+    if (nextSibling_)
+    {
+        compressedImage->cubemap_ = cubemap_;
+        compressedImage->array_ = array_;
+        compressedImage->nextSibling_ = nextSibling_->GetCompressedImage(format, quality, numLevels);
+        if (!compressedImage->nextSibling_)
+            return nullptr;
+    }
+
+    return compressedImage;
+}
+
 SharedPtr<Image> Image::GetSubimage(const IntRect& rect) const
 {
     if (!data_)
@@ -52,11 +52,22 @@ enum CompressedFormat
     CF_PVRTC_RGBA_4BPP,
 };
 
+/// Quality of built-in image compression.
+enum CompressionQuality
+{
+    /// Bounding box endpoints without refinement.
+    COMPRESSION_FAST = 0,
+    /// Principal axis endpoints with one refinement pass.
+    COMPRESSION_NORMAL,
+    /// Principal axis endpoints with iterative refinement and alternative alpha encodings.
+    COMPRESSION_HIGH
+};
+
 /// Compressed image mip level.
 struct URHO3D_API CompressedLevel
 {
-    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Return true if successful.
-    bool Decompress(unsigned char* dest) const;
+    /// Decompress to RGBA. The destination buffer required is width * height * depth * 4 bytes. If context is given, large DXT and ETC levels are decompressed in worker threads when called from the main thread. Return true if successful.
+    bool Decompress(unsigned char* dest, Context* context = nullptr) const;
 
     /// Compressed image data.
     unsigned char* data_{};
@@ -118,7 +129,7 @@ public:
     bool FlipHorizontal();
     /// Flip image vertically. Return true if successful.
     bool FlipVertical();
-    /// Resize image by bilinear resampling. Return true if successful.
+    /// Resize image. Enlarged axes are resampled bilinearly, reduced axes average all covered source pixels. Return true if successful.
     bool Resize(int width, int height);
     /// Clear the image with a color.
     void Clear(const Color& color);
@@ -132,7 +143,7 @@ public:
     bool SaveTGA(const ea::string& fileName) const;
     /// Save in JPG format with specified quality. Return true if successful.
     bool SaveJPG(const ea::string& fileName, int quality) const;
-    /// Save in DDS format. Only uncompressed RGBA images are supported. Return true if successful.
+    /// Save in DDS format. Only uncompressed RGBA and DXT compressed images are supported. Arrays and sRGB images are written with the DX10 header. Return true if successful.
     bool SaveDDS(const ea::string& fileName) const;
     /// Save in WebP format with minimum (fastest) or specified compression. Return true if successful. Fails always if WebP support is not compiled in.
     bool SaveWEBP(const ea::string& fileName, float compression = 0.0f) const;
@@ -142,7 +153,10 @@ public:
     /// Whether this texture has been detected as a volume, only relevant for DDS.
     /// @property
     bool IsArray() const { return array_; }
-    /// Whether this texture is in sRGB, only relevant for DDS.
+    /// Set whether color data is sRGB encoded. Mip levels and resized images of RGB and RGBA images are then filtered in linear color space.
+    /// @property
+    void SetSRGB(bool enable) { sRGB_ = enable; }
+    /// Whether this texture is in sRGB. Detected automatically only for DDS.
     /// @property
     bool IsSRGB() const { return sRGB_; }
 
@@ -190,7 +204,7 @@ public:
     /// @property
     unsigned GetNumCompressedLevels() const { return numCompressedLevels_; }
 
-    /// Return next mip level by bilinear filtering. Note that if the image is already 1x1x1, will keep returning an image of that size.
+    /// Return next mip level by box filtering. Large 2D images are filtered in worker threads when called from the main thread. Note that if the image is already 1x1x1, will keep returning an image of that size.
     SharedPtr<Image> GetNextLevel() const;
     /// Return the next sibling image of an array or cubemap.
     SharedPtr<Image> GetNextSibling() const { return nextSibling_;  }
@@ -198,8 +212,10 @@ public:
     SharedPtr<Image> ConvertToRGBA() const;
     /// Return a compressed mip level.
     CompressedLevel GetCompressedLevel(unsigned index) const;
-    /// Return decompressed image data in RGBA format.
+    /// Return decompressed image data in RGBA format. Large images are decompressed in worker threads when called from the main thread.
     SharedPtr<Image> GetDecompressedImage() const;
+    /// Return image compressed to DXT1, DXT3 or DXT5 format with the specified number of generated mip levels, 0 for a full mip chain down to 1x1. Cubemap and array siblings are compressed too. 3D images are not supported. Large images are compressed in worker threads when called from the main thread.
+    SharedPtr<Image> GetCompressedImage(CompressedFormat format, CompressionQuality quality = COMPRESSION_NORMAL, unsigned numLevels = 0) const;
     /// Return subimage from the image by the defined rect or null if failed. 3D images are not supported. You must free the subimage yourself.
     SharedPtr<Image> GetSubimage(const IntRect& rect) const;
     /// Return an SDL surface from the image, or null if failed. Only RGB images are supported. Specify rect to only return partial image. You must free the surface yourself.
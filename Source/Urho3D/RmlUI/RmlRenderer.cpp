@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/IndexBuffer.h"
@@ -53,6 +54,15 @@ Rml::TextureHandle WrapTextureHandle(CachedRmlTexture* texture) { return reinter
 /// Unwrap RmlUI handle to CachedRmlTexture pointer.
 CachedRmlTexture* UnwrapTextureHandle(Rml::TextureHandle texture) { return reinterpret_cast<CachedRmlTexture*>(texture); }
 
+static_assert(sizeof(Rml::Vertex) == 5 * sizeof(float), "Rml::Vertex layout does not match vertex elements");
+
+/// Vertex elements matching Rml::Vertex layout, so that vertices are copied into vertex buffers without conversion.
+const ea::vector<VertexElement> rmlVertexElements = {
+    VertexElement(TYPE_VECTOR2, SEM_POSITION),
+    VertexElement(TYPE_UBYTE4_NORM, SEM_COLOR),
+    VertexElement(TYPE_VECTOR2, SEM_TEXCOORD),
+};
+
 }
 
 RmlRenderer::RmlRenderer(Context* context)
@@ -62,6 +72,7 @@ RmlRenderer::RmlRenderer(Context* context)
 {
     InitializeGraphics();
     SubscribeToEvent(E_SCREENMODE, [this](StringHash, VariantMap&) { InitializeGraphics(); });
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(RmlRenderer, HandleBeginFrame));
 }
 
 void RmlRenderer::InitializeGraphics()
@@ -82,40 +93,22 @@ void RmlRenderer::InitializeGraphics()
 
 void RmlRenderer::CompileGeometry(CompiledGeometryForRml& compiledGeometryOut, Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, const Rml::TextureHandle texture)
 {
-    VertexBuffer* vertexBuffer;
-    IndexBuffer* indexBuffer;
     compiledGeometryOut.texture_ = texture;
     if (compiledGeometryOut.vertexBuffer_.Null())
-        compiledGeometryOut.vertexBuffer_ = vertexBuffer = context_->CreateObject<VertexBuffer>().Detach();
-    else
-        vertexBuffer = compiledGeometryOut.vertexBuffer_.Get();
-
+        compiledGeometryOut.vertexBuffer_ = context_->CreateObject<VertexBuffer>();
     if (compiledGeometryOut.indexBuffer_.Null())
-        compiledGeometryOut.indexBuffer_ = indexBuffer = context_->CreateObject<IndexBuffer>().Detach();
-    else
-        indexBuffer = compiledGeometryOut.indexBuffer_.Get();
+        compiledGeometryOut.indexBuffer_ = context_->CreateObject<IndexBuffer>();
 
-    vertexBuffer->SetSize(numVertices, MASK_POSITION | MASK_COLOR | (texture ? MASK_TEXCOORD1 : MASK_NONE), true);
+    VertexBuffer* vertexBuffer = compiledGeometryOut.vertexBuffer_;
+    IndexBuffer* indexBuffer = compiledGeometryOut.indexBuffer_;
     vertexBuffer->SetShadowed(true);
-    indexBuffer->SetSize(numIndices, true);
+    vertexBuffer->SetSize(numVertices, rmlVertexElements);
+    vertexBuffer->SetData(vertices);
     indexBuffer->SetShadowed(true);
+    indexBuffer->SetSize(numIndices, true);
+    indexBuffer->SetData(indices);
 
-    float* vertexData = static_cast<float*>(vertexBuffer->Lock(0, numVertices, true));
-    assert(vertexData != nullptr);
-    for (int i = 0; i < numVertices; ++i)
-    {
-        *vertexData++ = vertices[i].position.x;
-        *vertexData++ = vertices[i].position.y;
-        *vertexData++ = 0.f;
-        *((unsigned*)vertexData++) = (vertices[i].colour.alpha << 24u) | (vertices[i].colour.blue << 16u) | (vertices[i].colour.green << 8u) | vertices[i].colour.red;
-        if (texture)
-        {
-            *vertexData++ = vertices[i].tex_coord.x;
-            *vertexData++ = vertices[i].tex_coord.y;
-        }
-    }
-    vertexBuffer->Unlock();
-    indexBuffer->SetDataRange(indices, 0, numIndices);
+    numUploadedBytes_ += numVertices * sizeof(Rml::Vertex) + numIndices * sizeof(int);
 }
 
 Rml::CompiledGeometryHandle RmlRenderer::CompileGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, const Rml::TextureHandle texture)
@@ -129,6 +122,74 @@ void RmlRenderer::RenderCompiledGeometry(Rml::CompiledGeometryHandle geometryHan
 {
     CompiledGeometryForRml* geometry = reinterpret_cast<CompiledGeometryForRml*>(geometryHandle);
 
+    // Keep the draw order
+    FlushBatch();
+
+    DrawGeometry(geometry->vertexBuffer_, geometry->indexBuffer_, geometry->texture_, translation, 0,
+        geometry->indexBuffer_->GetIndexCount(), 0, geometry->vertexBuffer_->GetVertexCount());
+}
+
+void RmlRenderer::RenderGeometry(Rml::Vertex* vertices, int num_vertices, int* indices, int num_indices, Rml::TextureHandle texture, const Rml::Vector2f& translation)
+{
+    // Consecutive draws with the same texture and render state are merged into one draw call. Render state changes
+    // flush the batch before they are applied
+    if (texture != batchTexture_)
+        FlushBatch();
+    batchTexture_ = texture;
+
+    unsigned vertexStart = batchVertices_.size();
+    batchVertices_.resize(vertexStart + num_vertices);
+    Rml::Vertex* destVertices = batchVertices_.data() + vertexStart;
+    for (int i = 0; i < num_vertices; ++i)
+    {
+        destVertices[i] = vertices[i];
+        destVertices[i].position.x += translation.x;
+        destVertices[i].position.y += translation.y;
+    }
+
+    unsigned indexStart = batchIndices_.size();
+    batchIndices_.resize(indexStart + num_indices);
+    int* destIndices = batchIndices_.data() + indexStart;
+    for (int i = 0; i < num_indices; ++i)
+        destIndices[i] = indices[i] + vertexStart;
+}
+
+void RmlRenderer::FlushBatch()
+{
+    if (batchIndices_.empty())
+        return;
+
+    auto numVertices = (unsigned)batchVertices_.size();
+    auto numIndices = (unsigned)batchIndices_.size();
+
+    // Append the batch to the transient buffers. They are rewound only at frame begin, so that ranges already drawn
+    // this frame are never overwritten. Grow them when the batch does not fit; the size then settles at the largest
+    // amount of geometry drawn in one frame. Static buffers are used because partial updates of dynamic buffers
+    // discard their contents on some APIs
+    if (transientVertexCount_ + numVertices > vertexBuffer_->GetVertexCount())
+        vertexBuffer_->SetSize(NextPowerOfTwo(transientVertexCount_ + numVertices), rmlVertexElements);
+    if (transientIndexCount_ + numIndices > indexBuffer_->GetIndexCount())
+        indexBuffer_->SetSize(NextPowerOfTwo(transientIndexCount_ + numIndices), true);
+
+    for (int& index : batchIndices_)
+        index += transientVertexCount_;
+
+    vertexBuffer_->SetDataRange(batchVertices_.data(), transientVertexCount_, numVertices);
+    indexBuffer_->SetDataRange(batchIndices_.data(), transientIndexCount_, numIndices);
+    numUploadedBytes_ += numVertices * sizeof(Rml::Vertex) + numIndices * sizeof(int);
+
+    DrawGeometry(vertexBuffer_, indexBuffer_, batchTexture_, Rml::Vector2f(0.0f, 0.0f), transientIndexCount_, numIndices,
+        transientVertexCount_, numVertices);
+
+    transientVertexCount_ += numVertices;
+    transientIndexCount_ += numIndices;
+    batchVertices_.clear();
+    batchIndices_.clear();
+}
+
+void RmlRenderer::DrawGeometry(VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, Rml::TextureHandle textureHandle,
+    const Rml::Vector2f& translation, unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount)
+{
     // Engine does not render when window is closed or device is lost
     assert(graphics_ && graphics_->IsInitialized() && !graphics_->IsDeviceLost());
 
@@ -179,7 +240,7 @@ void RmlRenderer::RenderCompiledGeometry(Rml::CompiledGeometryHandle geometryHan
     ShaderVariation* vs;
 
     // Restore texture data if lost
-    CachedRmlTexture* cachedTexture = UnwrapTextureHandle(geometry->texture_);
+    CachedRmlTexture* cachedTexture = UnwrapTextureHandle(textureHandle);
     Texture2D* texture = cachedTexture ? cachedTexture->texture_ : nullptr;
     if (texture && texture->IsDataLost())
     {
@@ -203,8 +264,8 @@ void RmlRenderer::RenderCompiledGeometry(Rml::CompiledGeometryHandle geometryHan
     }
 
     graphics_->SetTexture(0, texture);
-    graphics_->SetVertexBuffer(geometry->vertexBuffer_);
-    graphics_->SetIndexBuffer(geometry->indexBuffer_);
+    graphics_->SetVertexBuffer(vertexBuffer);
+    graphics_->SetIndexBuffer(indexBuffer);
     graphics_->SetShaders(vs, ps);
     graphics_->SetLineAntiAlias(true);
 
@@ -224,17 +285,8 @@ void RmlRenderer::RenderCompiledGeometry(Rml::CompiledGeometryHandle geometryHan
     graphics_->SetShaderParameter(VSP_ELAPSEDTIME, elapsedTime);
     graphics_->SetShaderParameter(PSP_ELAPSEDTIME, elapsedTime);
 
-    graphics_->Draw(TRIANGLE_LIST, 0, geometry->indexBuffer_->GetIndexCount(), 0, geometry->vertexBuffer_->GetVertexCount());
-}
-
-void RmlRenderer::RenderGeometry(Rml::Vertex* vertices, int num_vertices, int* indices, int num_indices, Rml::TextureHandle texture, const Rml::Vector2f& translation)
-{
-    // Could this be optimized?
-    CompiledGeometryForRml geometry;
-    geometry.vertexBuffer_ = vertexBuffer_;
-    geometry.indexBuffer_ = indexBuffer_;
-    CompileGeometry(geometry, vertices, num_vertices, indices, num_indices, texture);
-    RenderCompiledGeometry(reinterpret_cast<Rml::CompiledGeometryHandle>(&geometry), translation);
+    graphics_->Draw(TRIANGLE_LIST, indexStart, indexCount, vertexStart, vertexCount);
+    ++numDrawCalls_;
 }
 
 void RmlRenderer::ReleaseCompiledGeometry(Rml::CompiledGeometryHandle geometry)
@@ -244,15 +296,17 @@ void RmlRenderer::ReleaseCompiledGeometry(Rml::CompiledGeometryHandle geometry)
 
 void RmlRenderer::EnableScissorRegion(bool enable)
 {
+    if (enable != scissorEnabled_)
+        FlushBatch();
     scissorEnabled_ = enable;
 }
 
 void RmlRenderer::SetScissorRegion(int x, int y, int width, int height)
 {
-    scissor_.left_ = x;
-    scissor_.top_ = y;
-    scissor_.bottom_ = y + height;
-    scissor_.right_ = x + width;
+    IntRect scissor(x, y, x + width, y + height);
+    if (scissor != scissor_)
+        FlushBatch();
+    scissor_ = scissor;
 }
 
 void RmlRenderer::ApplyScissorRegion(RenderSurface* surface, const IntVector2& viewSize)
@@ -376,16 +430,36 @@ bool RmlRenderer::GenerateTexture(Rml::TextureHandle& handleOut, const Rml::byte
 
 void RmlRenderer::ReleaseTexture(Rml::TextureHandle textureHandle)
 {
+    if (textureHandle == batchTexture_)
+    {
+        FlushBatch();
+        batchTexture_ = 0;
+    }
+
     CachedRmlTexture* cachedTexture = UnwrapTextureHandle(textureHandle);
     delete cachedTexture;
 }
 
 void RmlRenderer::SetTransform(const Rml::Matrix4f* transform)
 {
+    // Transform data is owned by the element, so the same pointer means the same transform
+    if (transformEnabled_ != (transform != nullptr) || (transform && transform->data() != matrix_))
+        FlushBatch();
+
     transformEnabled_ = transform != nullptr;
     matrix_ = transform ? transform->data() : Matrix4::IDENTITY.Data();
 }
 
+void RmlRenderer::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    transientVertexCount_ = 0;
+    transientIndexCount_ = 0;
+    lastNumDrawCalls_ = numDrawCalls_;
+    lastNumUploadedBytes_ = numUploadedBytes_;
+    numDrawCalls_ = 0;
+    numUploadedBytes_ = 0;
+}
+
 }   // namespace Detail
 
 }   // namespace Urho3D
@@ -24,7 +24,10 @@
 
 #include "../Container/Ptr.h"
 
+#include <EASTL/vector.h>
+
 #include <RmlUi/Core/RenderInterface.h>
+#include <RmlUi/Core/Vertex.h>
 
 
 namespace Urho3D
@@ -57,7 +60,7 @@ public:
     Rml::CompiledGeometryHandle CompileGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, const Rml::TextureHandle texture) override;
     /// Render compiled geometry.
     void RenderCompiledGeometry(Rml::CompiledGeometryHandle geometryHandle, const Rml::Vector2f& translation) override;
-    /// Compile and render geometry.
+    /// Compile and render geometry. Geometry is collected in a batch and drawn from transient buffers shared by all immediate draws.
     void RenderGeometry(Rml::Vertex* vertices, int num_vertices, int* indices, int num_indices, Rml::TextureHandle texture, const Rml::Vector2f& translation) override;
     /// Free compiled geometry which was returned by previous call to CompileGeometry().
     void ReleaseCompiledGeometry(Rml::CompiledGeometryHandle geometry) override;
@@ -75,10 +78,22 @@ public:
     void ReleaseTexture(Rml::TextureHandle textureHandle) override;
     /// Set or unset a custom transform.
     void SetTransform(const Rml::Matrix4f* transform) override;
+    /// Draw the batched immediate geometry. Must be called when RmlUi is done rendering a context.
+    void FlushBatch();
+
+    /// Return number of draw calls in the last frame.
+    unsigned GetNumDrawCalls() const { return lastNumDrawCalls_; }
+    /// Return number of vertex and index bytes uploaded in the last frame.
+    unsigned GetNumUploadedBytes() const { return lastNumUploadedBytes_; }
 
 private:
     /// Perform initialization tasks that require graphics subsystem.
     void InitializeGraphics();
+    /// Draw a range of the geometry with the current render state.
+    void DrawGeometry(VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, Rml::TextureHandle textureHandle,
+        const Rml::Vector2f& translation, unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount);
+    /// Handle frame begin. Rewind the transient buffers and update statistics.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
 
     /// Graphics subsystem instance.
     WeakPtr<Graphics> graphics_;
@@ -88,10 +103,28 @@ private:
     bool transformEnabled_ = false;
     /// Scissor region set by RmlUi.
     IntRect scissor_;
-    /// Temporary buffer used for rendering uncompiled geometry.
+    /// Transient buffer used for rendering uncompiled geometry. Batches are appended to it during the frame.
     SharedPtr<VertexBuffer> vertexBuffer_;
-    /// Temporary buffer used for rendering uncompiled geometry.
+    /// Transient buffer used for rendering uncompiled geometry. Batches are appended to it during the frame.
     SharedPtr<IndexBuffer> indexBuffer_;
+    /// Number of vertices of the transient vertex buffer in use this frame.
+    unsigned transientVertexCount_ = 0;
+    /// Number of indices of the transient index buffer in use this frame.
+    unsigned transientIndexCount_ = 0;
+    /// Uncompiled geometry vertices waiting to be drawn, with translation applied.
+    ea::vector<Rml::Vertex> batchVertices_;
+    /// Uncompiled geometry indices waiting to be drawn, relative to the batch start.
+    ea::vector<int> batchIndices_;
+    /// Texture of the uncompiled geometry waiting to be drawn.
+    Rml::TextureHandle batchTexture_ = 0;
+    /// Number of draw calls this frame.
+    unsigned numDrawCalls_ = 0;
+    /// Number of bytes uploaded this frame.
+    unsigned numUploadedBytes_ = 0;
+    /// Number of draw calls in the last frame.
+    unsigned lastNumDrawCalls_ = 0;
+    /// Number of bytes uploaded in the last frame.
+    unsigned lastNumUploadedBytes_ = 0;
     /// Transform requested by RmlUi. This pointer points either to data owned by RmlUi or to Matrix4::IDENTITY.data().
     const float* matrix_ = nullptr;
     /// Last viewport size.
@@ -600,6 +600,19 @@ void RmlUI::Render()
         graphics->SetRenderTarget(0, (RenderSurface*)nullptr);
 
     rmlContext_->Render();
+
+    // Draw the remaining batched geometry while the render target of this instance is still set
+    static_cast<Detail::RmlRenderer*>(Rml::GetRenderInterface())->FlushBatch();
+}
+
+unsigned RmlUI::GetNumDrawCalls() const
+{
+    return static_cast<Detail::RmlRenderer*>(Rml::GetRenderInterface())->GetNumDrawCalls();
+}
+
+unsigned RmlUI::GetNumUploadedBytes() const
+{
+    return static_cast<Detail::RmlRenderer*>(Rml::GetRenderInterface())->GetNumUploadedBytes();
 }
 
 void RmlUI::OnDocumentUnload(Rml::ElementDocument* document)
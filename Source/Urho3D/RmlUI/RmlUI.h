@@ -95,6 +95,10 @@ public:
     void Update(float timeStep);
     /// Render UI.
     void Render();
+    /// Return number of draw calls issued by all RmlUI instances in the last frame.
+    unsigned GetNumDrawCalls() const;
+    /// Return number of geometry bytes uploaded by all RmlUI instances in the last frame.
+    unsigned GetNumUploadedBytes() const;
     /// Unload passed document and load it's rml again, return newly loaded document. This operation preserves document position and size.
     Rml::ElementDocument* ReloadDocument(Rml::ElementDocument* document);
 
@@ -87,8 +87,9 @@ void Node::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Rotation", GetRotation, SetRotation, Quaternion, Quaternion::IDENTITY, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Scale", GetScale, SetScale, Vector3, Vector3::ONE, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Variables", VariantMap, vars_, Variant::emptyVariantMap, AM_FILE); // Network replication of vars uses custom data
+    // Replicate position with 1/1024 unit precision, which keeps the most frequently sent attribute at a few bytes per axis
     URHO3D_ACCESSOR_ATTRIBUTE("Network Position", GetNetPositionAttr, SetNetPositionAttr, Vector3, Vector3::ZERO,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
+        AM_NET | AM_LATESTDATA | AM_NOEDIT).SetNetworkPrecision(1.0f / 1024.0f);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
         AM_NET | AM_LATESTDATA | AM_NOEDIT);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Parent Node", GetNetParentAttr, SetNetParentAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
@@ -1738,6 +1739,122 @@ bool Node::Load(Deserializer& source, SceneResolver& resolver, bool loadChildren
     return true;
 }
 
+bool Node::LoadDecoded(DecodedNodeData& source, SceneResolver& resolver, bool loadChildren, bool rewriteIDs, CreateMode mode)
+{
+    // Remove all children and components first in case this is not a fresh load
+    RemoveAllChildren();
+    RemoveAllComponents();
+
+    if (!LoadAttributeValues(source.values_))
+        return false;
+
+    for (DecodedComponentData& compData : source.components_)
+    {
+        Component* newComponent = SafeCreateComponent(EMPTY_STRING, compData.type_,
+            (mode == REPLICATED && Scene::IsReplicatedID(compData.id_)) ? REPLICATED : LOCAL, rewriteIDs ? 0 : compData.id_);
+        if (newComponent)
+        {
+            resolver.AddComponent(compData.id_, newComponent);
+            // Components with per-instance attributes can not use values decoded against the registered attributes
+            if (compData.attributes_ && newComponent->GetAttributes() == compData.attributes_)
+                newComponent->LoadAttributeValues(compData.values_);
+            else
+                newComponent->Load(compData.data_);
+        }
+    }
+
+    if (!loadChildren)
+        return true;
+
+    for (DecodedNodeData& childData : source.children_)
+    {
+        Node* newNode = CreateChild(rewriteIDs ? 0 : childData.id_,
+            (mode == REPLICATED && Scene::IsReplicatedID(childData.id_)) ? REPLICATED : LOCAL);
+        resolver.AddNode(childData.id_, newNode);
+        if (!newNode->LoadDecoded(childData, resolver, loadChildren, rewriteIDs, mode))
+            return false;
+    }
+
+    return true;
+}
+
+bool Node::DecodeBinary(Context* context, Deserializer& source, DecodedNodeData& dest)
+{
+    const ea::vector<AttributeInfo>* nodeAttributes = context->GetAttributes(Node::GetTypeStatic());
+    if (nodeAttributes && !ReadAttributeValues(context, *nodeAttributes, source, dest.values_))
+        return false;
+
+    unsigned numComponents = source.ReadVLE();
+    dest.components_.resize(numComponents);
+    for (DecodedComponentData& compData : dest.components_)
+    {
+        compData.data_.SetData(source, source.ReadVLE());
+        compData.type_ = compData.data_.ReadStringHash();
+        compData.id_ = compData.data_.ReadUInt();
+
+        // Decode from a separate view so that the raw data stays positioned for a fallback load. Custom type values
+        // create objects when read, so components that have them are loaded from the raw data in the main thread
+        compData.attributes_ = context->GetAttributes(compData.type_);
+        if (compData.attributes_ && HasCustomAttributes(*compData.attributes_))
+            compData.attributes_ = nullptr;
+        if (compData.attributes_)
+        {
+            const unsigned position = compData.data_.GetPosition();
+            MemoryBuffer compBuffer(compData.data_.GetData() + position, compData.data_.GetSize() - position);
+            // Do not abort if component fails to decode, it will be loaded from the raw data instead
+            if (!ReadAttributeValues(context, *compData.attributes_, compBuffer, compData.values_))
+                compData.attributes_ = nullptr;
+        }
+    }
+
+    unsigned numChildren = source.ReadVLE();
+    dest.children_.resize(numChildren);
+    for (DecodedNodeData& childData : dest.children_)
+    {
+        childData.id_ = source.ReadUInt();
+        if (!DecodeBinary(context, source, childData))
+            return false;
+    }
+
+    return true;
+}
+
+bool Node::SkipBinary(Context* context, Deserializer& source)
+{
+    // Node attributes are not size-prefixed and have to be read, components can be skipped as whole
+    if (const ea::vector<AttributeInfo>* nodeAttributes = context->GetAttributes(Node::GetTypeStatic()))
+    {
+        for (const AttributeInfo& attr : *nodeAttributes)
+        {
+            if (!attr.ShouldLoad())
+                continue;
+
+            if (source.IsEof())
+                return false;
+            source.ReadVariant(attr.type_, context);
+        }
+    }
+
+    unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        const unsigned dataSize = source.ReadVLE();
+        const unsigned dataEnd = source.GetPosition() + dataSize;
+        if (source.Seek(dataEnd) != dataEnd)
+            return false;
+    }
+
+    unsigned numChildren = source.ReadVLE();
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        source.ReadUInt();
+        if (!SkipBinary(context, source))
+            return false;
+    }
+
+    return true;
+}
+
 bool Node::LoadXML(const XMLElement& source, SceneResolver& resolver, bool loadChildren, bool rewriteIDs, CreateMode mode)
 {
     // Remove all children and components first in case this is not a fresh load
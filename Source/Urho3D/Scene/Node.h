@@ -71,6 +71,34 @@ struct URHO3D_API NodeImpl
     mutable VectorBuffer attrBuffer_;
 };
 
+/// Component decoded from binary data ahead of creation.
+struct DecodedComponentData
+{
+    /// Component type.
+    StringHash type_;
+    /// Component ID as stored in the source data.
+    unsigned id_{};
+    /// Attribute descriptions used for decoding, or null if the type has no registered attributes.
+    const ea::vector<AttributeInfo>* attributes_{};
+    /// Decoded attribute values.
+    VariantVector values_;
+    /// Undecoded attribute data, used if the created component has a different attribute layout.
+    VectorBuffer data_;
+};
+
+/// Node subtree decoded from binary data ahead of creation. Components with custom type attributes are left undecoded, so that decoding does not create any objects and may run in worker threads.
+struct DecodedNodeData
+{
+    /// Node ID as stored in the source data.
+    unsigned id_{};
+    /// Decoded node attribute values.
+    VariantVector values_;
+    /// Decoded components.
+    ea::vector<DecodedComponentData> components_;
+    /// Decoded child nodes.
+    ea::vector<DecodedNodeData> children_;
+};
+
 /// %Scene node that may contain components and child nodes.
 class URHO3D_API Node : public Animatable
 {
@@ -653,6 +681,13 @@ public:
     /// Load components and optionally load child nodes.
     bool Load(Deserializer& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
         CreateMode mode = REPLICATED);
+    /// Load components and optionally child nodes from data decoded in advance by DecodeBinary. Source data is consumed.
+    bool LoadDecoded(DecodedNodeData& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
+        CreateMode mode = REPLICATED);
+    /// Decode node attributes, components and child nodes from binary data without creating any objects. Components with custom type attributes are kept as raw data and loaded by LoadDecoded. Node ID must have been read by the caller. May be called from worker threads unless node attributes include custom types. Return true if successful.
+    static bool DecodeBinary(Context* context, Deserializer& source, DecodedNodeData& dest);
+    /// Skip over node attributes, components and child nodes in binary data. Node ID must have been read by the caller. Return true if successful.
+    static bool SkipBinary(Context* context, Deserializer& source);
     /// Load components from XML data and optionally load child nodes.
     bool LoadXML(const XMLElement& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
         CreateMode mode = REPLICATED);
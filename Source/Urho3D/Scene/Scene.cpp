@@ -30,6 +30,7 @@
 #include "../IO/Archive.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
@@ -59,6 +60,23 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
 
+/// Root-level child node of a binary scene file decoded in a worker thread.
+struct AsyncNodeDecodeTask
+{
+    /// Remaining scene file data shared between all tasks. Released when decoding is done.
+    ea::shared_ptr<ByteVector> buffer_;
+    /// Offset of the node data in the buffer.
+    unsigned offset_{};
+    /// Size of the node data in the buffer.
+    unsigned size_{};
+    /// Decoded node subtree.
+    DecodedNodeData node_;
+    /// Whether the whole subtree was decoded successfully.
+    bool success_{};
+    /// Completed flag. Set by the worker thread after all other fields are written.
+    std::atomic<bool> completed_{};
+};
+
 Scene::Scene(Context* context) :
     Node(context),
     replicatedNodeID_(FIRST_REPLICATED_ID),
@@ -434,6 +452,13 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
 
         // Then prepare to load child nodes in the async updates
         asyncProgress_.totalNodes_ = file->ReadVLE();
+
+        // Optionally decode child nodes in worker threads, so that the async updates only need to create them
+        if (asyncLoadingThreaded_ && !StartAsyncDecoding(file))
+        {
+            StopAsyncLoading();
+            return false;
+        }
     }
     else
     {
@@ -588,6 +613,8 @@ void Scene::StopAsyncLoading()
     asyncProgress_.jsonFile_.Reset();
     asyncProgress_.xmlElement_ = XMLElement::EMPTY;
     asyncProgress_.jsonIndex_ = 0;
+    // Tasks still being decoded are kept alive by their work items
+    asyncProgress_.decodeTasks_.clear();
     asyncProgress_.resources_.clear();
     resolver_.Reset();
 }
@@ -1285,6 +1312,14 @@ void Scene::UpdateAsyncLoading()
         }
 
 
+        // Create child nodes decoded in worker threads, waiting for the next frame if the next one is not decoded yet
+        if (!asyncProgress_.decodeTasks_.empty())
+        {
+            if (!CommitAsyncDecodedNodes(asyncLoadTimer))
+                break;
+            continue;
+        }
+
         // Read one child node with its full sub-hierarchy either from binary, JSON, or XML
         /// \todo Works poorly in scenes where one root-level child node contains all content
         if (asyncProgress_.xmlFile_)
@@ -1333,6 +1368,87 @@ void Scene::UpdateAsyncLoading()
     SendEvent(E_ASYNCLOADPROGRESS, eventData);
 }
 
+bool Scene::StartAsyncDecoding(File* file)
+{
+    URHO3D_PROFILE("StartAsyncDecoding");
+
+    // Custom type node attributes can not be read in worker threads, load the child nodes in the main thread instead
+    const ea::vector<AttributeInfo>* nodeAttributes = context_->GetAttributes(Node::GetTypeStatic());
+    if (nodeAttributes && HasCustomAttributes(*nodeAttributes))
+        return true;
+
+    // Read the rest of the file at once, node data is not size-prefixed so the node boundaries are found by skipping
+    auto buffer = ea::make_shared<ByteVector>(file->GetSize() - file->GetPosition());
+    if (!buffer->empty() && file->Read(buffer->data(), buffer->size()) != buffer->size())
+    {
+        URHO3D_LOGERROR("Could not read scene data from " + file->GetName());
+        return false;
+    }
+
+    MemoryBuffer source(*buffer);
+    ea::vector<ea::shared_ptr<AsyncNodeDecodeTask>> tasks(asyncProgress_.totalNodes_);
+    for (ea::shared_ptr<AsyncNodeDecodeTask>& task : tasks)
+    {
+        task = ea::make_shared<AsyncNodeDecodeTask>();
+        task->buffer_ = buffer;
+        task->offset_ = source.GetPosition();
+
+        source.ReadUInt();
+        if (!Node::SkipBinary(context_, source))
+        {
+            URHO3D_LOGERROR("Could not find node data in " + file->GetName() + ", stream at end");
+            return false;
+        }
+
+        task->size_ = source.GetPosition() - task->offset_;
+    }
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    Context* context = context_;
+    for (const ea::shared_ptr<AsyncNodeDecodeTask>& task : tasks)
+    {
+        queue->AddWorkItem([task, context]()
+        {
+            MemoryBuffer nodeSource(task->buffer_->data() + task->offset_, task->size_);
+            task->node_.id_ = nodeSource.ReadUInt();
+            task->success_ = Node::DecodeBinary(context, nodeSource, task->node_);
+            task->buffer_ = nullptr;
+            task->completed_.store(true, std::memory_order_release);
+        });
+    }
+
+    asyncProgress_.decodeTasks_ = ea::move(tasks);
+    return true;
+}
+
+bool Scene::CommitAsyncDecodedNodes(HiresTimer& asyncLoadTimer)
+{
+    while (asyncProgress_.loadedNodes_ < asyncProgress_.totalNodes_)
+    {
+        AsyncNodeDecodeTask& task = *asyncProgress_.decodeTasks_[asyncProgress_.loadedNodes_];
+        if (!task.completed_.load(std::memory_order_acquire))
+            return false;
+
+        if (!task.success_)
+            URHO3D_LOGERROR("Could not decode node " + ea::to_string(task.node_.id_) + ", loading partially");
+
+        const unsigned nodeID = task.node_.id_;
+        Node* newNode = CreateChild(nodeID, IsReplicatedID(nodeID) ? REPLICATED : LOCAL);
+        resolver_.AddNode(nodeID, newNode);
+        newNode->LoadDecoded(task.node_, resolver_);
+
+        // Release decoded data as soon as possible
+        asyncProgress_.decodeTasks_[asyncProgress_.loadedNodes_] = nullptr;
+        ++asyncProgress_.loadedNodes_;
+
+        // Break if time limit exceeded, so that we keep sufficient FPS
+        if (asyncLoadTimer.GetUSec(false) >= asyncLoadingMs_ * 1000LL)
+            return false;
+    }
+
+    return true;
+}
+
 void Scene::FinishAsyncLoading()
 {
     if (asyncProgress_.mode_ > LOAD_RESOURCES_ONLY)
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <EASTL/shared_ptr.h>
 #include <EASTL/span.h>
 #include <EASTL/unique_ptr.h>
 
@@ -37,9 +38,12 @@ namespace Urho3D
 {
 
 class File;
+class HiresTimer;
 class PackageFile;
 class Texture2D;
 
+struct AsyncNodeDecodeTask;
+
 static const unsigned FIRST_REPLICATED_ID = 0x1;
 static const unsigned LAST_REPLICATED_ID = 0xffffff;
 static const unsigned FIRST_LOCAL_ID = 0x01000000;
@@ -72,6 +76,9 @@ struct AsyncProgress
     /// Current JSON child array and for JSON mode.
     unsigned jsonIndex_;
 
+    /// Root-level child nodes decoded in worker threads for threaded binary mode, in file order.
+    ea::vector<ea::shared_ptr<AsyncNodeDecodeTask>> decodeTasks_;
+
     /// Current load mode.
     LoadMode mode_;
     /// Resource name hashes left to load.
@@ -192,6 +199,9 @@ public:
     /// Set maximum milliseconds per frame to spend on async scene loading.
     /// @property
     void SetAsyncLoadingMs(int ms);
+    /// Set whether async binary scene loading decodes root-level child nodes in worker threads. Nodes are then only created and attached in the main thread.
+    /// @property
+    void SetAsyncLoadingThreaded(bool enable) { asyncLoadingThreaded_ = enable; }
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -259,6 +269,10 @@ public:
     /// @property
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return whether async binary scene loading decodes nodes in worker threads.
+    /// @property
+    bool IsAsyncLoadingThreaded() const { return asyncLoadingThreaded_; }
+
     /// Return required package files.
     /// @property
     const ea::vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
@@ -321,6 +335,10 @@ private:
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
     /// Update asynchronous loading.
     void UpdateAsyncLoading();
+    /// Split the rest of a binary scene file into root-level child nodes and queue them for decoding in worker threads.
+    bool StartAsyncDecoding(File* file);
+    /// Create root-level child nodes decoded in worker threads. Return false if the time limit was exceeded or the next node is not decoded yet.
+    bool CommitAsyncDecodedNodes(HiresTimer& asyncLoadTimer);
     /// Finish asynchronous loading.
     void FinishAsyncLoading();
     /// Finish loading. Sets the scene filename and checksum.
@@ -397,6 +415,8 @@ private:
     bool updateEnabled_;
     /// Asynchronous loading flag.
     bool asyncLoading_;
+    /// Threaded decoding flag for asynchronous binary loading.
+    bool asyncLoadingThreaded_{};
     /// Threaded update flag.
     bool threadedUpdate_;
 
@@ -63,6 +63,120 @@ static unsigned RemapAttributeIndex(const ea::vector<AttributeInfo>* attributes,
     return netAttrIndex; // Could not remap
 }
 
+/// Largest quantized magnitude that fits into a zigzag encoded VLE value.
+static const int MAX_QUANTIZED_VALUE = (1 << 28) - 1;
+/// Largest VLE value, which zigzag encodes one step below -MAX_QUANTIZED_VALUE. Marks a value written at full precision.
+static const unsigned FULL_PRECISION_MARKER = (1u << 29u) - 1;
+
+static void WriteQuantizedFloats(Serializer& dest, const float* values, unsigned count, float precision)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const float scaled = Round(values[i] / precision);
+        // Write values that are not representable as steps of the precision as is instead of clamping them. Compare in
+        // double precision, because MAX_QUANTIZED_VALUE rounds up to 2^28 as a float and would let +-2^28 through
+        if (IsNaN(scaled) || (double)Abs(scaled) > (double)MAX_QUANTIZED_VALUE)
+        {
+            dest.WriteVLE(FULL_PRECISION_MARKER);
+            dest.WriteFloat(values[i]);
+            continue;
+        }
+
+        const auto quantized = (int)scaled;
+        // Zigzag encode so that small negative values stay short
+        dest.WriteVLE(((unsigned)quantized << 1u) ^ (unsigned)(quantized >> 31));
+    }
+}
+
+static void ReadQuantizedFloats(Deserializer& source, float* values, unsigned count, float precision)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const unsigned encoded = source.ReadVLE();
+        if (encoded == FULL_PRECISION_MARKER)
+        {
+            values[i] = source.ReadFloat();
+            continue;
+        }
+
+        const int quantized = (int)(encoded >> 1u) ^ -(int)(encoded & 1u);
+        values[i] = (float)quantized * precision;
+    }
+}
+
+static void WriteNetworkAttribute(Serializer& dest, const AttributeInfo& attr, const Variant& value)
+{
+    const float precision = attr.networkPrecision_;
+    if (precision > 0.0f)
+    {
+        switch (attr.type_)
+        {
+        case VAR_FLOAT:
+        {
+            const float data = value.GetFloat();
+            WriteQuantizedFloats(dest, &data, 1, precision);
+            return;
+        }
+
+        case VAR_VECTOR2:
+            WriteQuantizedFloats(dest, value.GetVector2().Data(), 2, precision);
+            return;
+
+        case VAR_VECTOR3:
+            WriteQuantizedFloats(dest, value.GetVector3().Data(), 3, precision);
+            return;
+
+        case VAR_VECTOR4:
+            WriteQuantizedFloats(dest, value.GetVector4().Data(), 4, precision);
+            return;
+
+        case VAR_QUATERNION:
+            dest.WritePackedQuaternion(value.GetQuaternion());
+            return;
+
+        default:
+            break;
+        }
+    }
+
+    dest.WriteVariantData(value);
+}
+
+static Variant ReadNetworkAttribute(Deserializer& source, const AttributeInfo& attr)
+{
+    const float precision = attr.networkPrecision_;
+    if (precision > 0.0f)
+    {
+        float data[4];
+        switch (attr.type_)
+        {
+        case VAR_FLOAT:
+            ReadQuantizedFloats(source, data, 1, precision);
+            return data[0];
+
+        case VAR_VECTOR2:
+            ReadQuantizedFloats(source, data, 2, precision);
+            return Vector2(data);
+
+        case VAR_VECTOR3:
+            ReadQuantizedFloats(source, data, 3, precision);
+            return Vector3(data);
+
+        case VAR_VECTOR4:
+            ReadQuantizedFloats(source, data, 4, precision);
+            return Vector4(data);
+
+        case VAR_QUATERNION:
+            return source.ReadPackedQuaternion();
+
+        default:
+            break;
+        }
+    }
+
+    return source.ReadVariant(attr.type_);
+}
+
 static bool SaveAttributeWithName(Archive& archive, const AttributeInfo& attr, const Variant& value)
 {
     assert(!archive.IsInput());
@@ -369,6 +483,62 @@ bool Serializable::Load(Deserializer& source)
     return true;
 }
 
+bool Serializable::LoadAttributeValues(const VariantVector& values)
+{
+    const ea::vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    unsigned index = 0;
+    for (const AttributeInfo& attr : *attributes)
+    {
+        if (!attr.ShouldLoad())
+            continue;
+
+        if (index >= values.size())
+        {
+            URHO3D_LOGERROR("Could not load " + GetTypeName() + ", not enough attribute values");
+            return false;
+        }
+
+        OnSetAttribute(attr, values[index++]);
+    }
+
+    return true;
+}
+
+bool Serializable::ReadAttributeValues(Context* context, const ea::vector<AttributeInfo>& attributes, Deserializer& source,
+    VariantVector& values)
+{
+    values.clear();
+    for (const AttributeInfo& attr : attributes)
+    {
+        if (!attr.ShouldLoad())
+            continue;
+
+        if (source.IsEof())
+        {
+            URHO3D_LOGERROR("Could not read attribute values, stream not open or at end");
+            return false;
+        }
+
+        values.push_back(source.ReadVariant(attr.type_, context));
+    }
+
+    return true;
+}
+
+bool Serializable::HasCustomAttributes(const ea::vector<AttributeInfo>& attributes)
+{
+    for (const AttributeInfo& attr : attributes)
+    {
+        if (attr.ShouldLoad() && attr.type_ == VAR_CUSTOM)
+            return true;
+    }
+
+    return false;
+}
+
 bool Serializable::Save(Serializer& dest) const
 {
     const ea::vector<AttributeInfo>* attributes = GetAttributes();
@@ -976,6 +1146,12 @@ void Serializable::SetInterceptNetworkUpdate(const ea::string& attributeName, bo
     }
 }
 
+void Serializable::RemoveReplicationState(ReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.erase_first(state);
+}
+
 void Serializable::AllocateNetworkState()
 {
     if (networkState_)
@@ -1031,7 +1207,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkAttribute(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -1057,7 +1233,7 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkAttribute(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -1079,8 +1255,9 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
 
     for (unsigned i = 0; i < numAttributes; ++i)
     {
-        if (attributes->at(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        const AttributeInfo& attr = attributes->at(i);
+        if (attr.mode_ & AM_LATESTDATA)
+            WriteNetworkAttribute(dest, attr, networkState_->currentValues_[i]);
     }
 }
 
@@ -1105,7 +1282,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
             const AttributeInfo& attr = attributes->at(i);
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkAttribute(source, attr));
                 changed = true;
             }
             else
@@ -1117,7 +1294,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkAttribute(source, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
@@ -1145,7 +1322,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
         {
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkAttribute(source, attr));
                 changed = true;
             }
             else
@@ -1157,7 +1334,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkAttribute(source, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
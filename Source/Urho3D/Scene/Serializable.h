@@ -69,6 +69,8 @@ public:
 
     /// Load from binary data. Return true if successful.
     virtual bool Load(Deserializer& source);
+    /// Load from attribute values decoded in advance by ReadAttributeValues. Return true if successful.
+    virtual bool LoadAttributeValues(const VariantVector& values);
     /// Save as binary data. Return true if successful.
     virtual bool Save(Serializer& dest) const;
     /// Load from XML data. Return true if successful.
@@ -119,6 +121,8 @@ public:
     void SetInterceptNetworkUpdate(const ea::string& attributeName, bool enable);
     /// Allocate network attribute state.
     void AllocateNetworkState();
+    /// Remove a replication state that is tracking this object, e.g. when the object leaves the interest scope of a connection.
+    void RemoveReplicationState(ReplicationState* state);
     /// Write initial delta network update.
     void WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp);
     /// Write a delta network update according to dirty attribute bits.
@@ -153,6 +157,11 @@ public:
     /// Return whether an attribute's network updates are being intercepted.
     bool GetInterceptNetworkUpdate(const ea::string& attributeName) const;
 
+    /// Read loadable attribute values from binary data without creating an object. Does not touch object state. Custom type values create objects when read, so it may be called from worker threads only if HasCustomAttributes() is false. Return true if successful.
+    static bool ReadAttributeValues(Context* context, const ea::vector<AttributeInfo>& attributes, Deserializer& source, VariantVector& values);
+    /// Return whether any loadable attribute is of custom type.
+    static bool HasCustomAttributes(const ea::vector<AttributeInfo>& attributes);
+
     /// Return the network attribute state, if allocated.
     NetworkState* GetNetworkState() const { return networkState_.get(); }
 
@@ -127,6 +127,8 @@ public:
     /// Get material attribute.
     ResourceRef GetMaterialAttr() const;
 protected:
+    /// Return whether the rendering batches may be cached between frames.
+    bool CanCacheBatches() const override { return true; }
     /// Return UI rendering batches with offset to image rectangle.
     void GetBatches
         (ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor, const IntVector2& offset);
@@ -157,11 +157,13 @@ void Button::OnKey(Key key, MouseButtonFlags buttons, QualifierFlags qualifiers)
 void Button::SetPressedOffset(const IntVector2& offset)
 {
     pressedOffset_ = offset;
+    MarkBatchesDirty();
 }
 
 void Button::SetPressedOffset(int x, int y)
 {
     pressedOffset_ = IntVector2(x, y);
+    MarkBatchesDirty();
 }
 
 void Button::SetPressedChildOffset(const IntVector2& offset)
@@ -193,6 +195,7 @@ void Button::SetRepeatRate(float rate)
 void Button::SetPressed(bool enable)
 {
     pressed_ = enable;
+    MarkBatchesDirty();
     SetChildOffset(pressed_ ? pressedChildOffset_ : IntVector2::ZERO);
 }
 
@@ -108,6 +108,8 @@ public:
     void SetSelectionAttr(unsigned index);
 
 protected:
+    /// Return whether the rendering batches may be cached between frames. The selected item is rendered as well.
+    bool CanCacheBatches() const override { return false; }
     /// Filter implicit attributes in serialization process.
     bool FilterImplicitAttributes(XMLElement& dest) const override;
     /// Filter implicit attributes in serialization process.
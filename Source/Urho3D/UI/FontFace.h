@@ -96,6 +96,9 @@ public:
     /// Return textures.
     const ea::vector<SharedPtr<Texture2D> >& GetTextures() const { return textures_; }
 
+    /// Return version of glyph texture placement. Incremented whenever mutable glyphs are placed into or evicted from the textures.
+    unsigned GetGlyphsVersion() const { return glyphsVersion_; }
+
 protected:
     friend class FontFaceBitmap;
     /// Create a texture for font rendering.
@@ -115,6 +118,8 @@ protected:
     float pointSize_{};
     /// Row height.
     float rowHeight_{};
+    /// Glyph texture placement version.
+    unsigned glyphsVersion_{};
 };
 
 }
@@ -23,6 +23,10 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Texture2D.h"
 #include "../IO/FileSystem.h"
@@ -44,6 +48,9 @@
 namespace Urho3D
 {
 
+/// Maximum number of texture pages of a face with mutable glyphs before the least recently used page is evicted.
+static const unsigned MAX_MUTABLE_GLYPH_PAGES = 4;
+
 inline float FixedToFloat(FT_Pos value)
 {
     return value / 64.0f;
@@ -72,11 +79,80 @@ public:
 
     FT_Library GetLibrary() const { return library_; }
 
+    /// Add a face with mutable glyphs to be processed every frame.
+    void AddMutableFace(FontFaceFreeType* face)
+    {
+        if (mutableFaces_.empty())
+        {
+            SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(FreeTypeLibrary, HandleBeginFrame));
+            SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(FreeTypeLibrary, HandleEndFrame));
+        }
+        mutableFaces_.push_back(face);
+    }
+
+    /// Remove a face with mutable glyphs.
+    void RemoveMutableFace(FontFaceFreeType* face)
+    {
+        mutableFaces_.erase_first(face);
+        if (mutableFaces_.empty())
+        {
+            UnsubscribeFromEvent(E_BEGINFRAME);
+            UnsubscribeFromEvent(E_ENDFRAME);
+        }
+    }
+
 private:
+    /// Handle frame begin event. Place glyphs rasterized during the previous frame.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace BeginFrame;
+        frameNumber_ = eventData[P_FRAMENUMBER].GetUInt();
+        for (FontFaceFreeType* face : mutableFaces_)
+            face->ProcessGlyphRequests(frameNumber_);
+    }
+
+    /// Handle frame end event. Start rasterizing glyphs requested during the frame.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData)
+    {
+        for (FontFaceFreeType* face : mutableFaces_)
+            face->ProcessGlyphRequests(frameNumber_);
+    }
+
     /// FreeType library.
     FT_Library library_{};
+    /// Faces with mutable glyphs.
+    ea::vector<FontFaceFreeType*> mutableFaces_;
+    /// Current frame number.
+    unsigned frameNumber_{};
 };
 
+/// Fill glyph metrics from a loaded glyph slot. Texture size is valid only if the glyph was rendered.
+static void SetGlyphMetrics(FontGlyph& fontGlyph, FT_GlyphSlot slot, int oversampling, float ascender, bool subpixel)
+{
+    // Note: position within texture will be filled later
+    fontGlyph.texWidth_ = slot->bitmap.width + oversampling - 1;
+    fontGlyph.texHeight_ = slot->bitmap.rows;
+    fontGlyph.width_ = slot->bitmap.width + oversampling - 1;
+    fontGlyph.height_ = slot->bitmap.rows;
+    fontGlyph.offsetX_ = slot->bitmap_left - (oversampling - 1) / 2.0f;
+    fontGlyph.offsetY_ = floorf(ascender + 0.5f) - slot->bitmap_top;
+
+    if (subpixel && slot->linearHoriAdvance)
+    {
+        // linearHoriAdvance is stored in 16.16 fixed point, not the usual 26.6
+        fontGlyph.advanceX_ = slot->linearHoriAdvance / 65536.0;
+    }
+    else
+    {
+        // Round to nearest pixel (only necessary when hinting is disabled)
+        fontGlyph.advanceX_ = floorf(FixedToFloat(slot->metrics.horiAdvance) + 0.5f);
+    }
+
+    fontGlyph.width_ /= oversampling;
+    fontGlyph.offsetX_ /= oversampling;
+    fontGlyph.advanceX_ /= oversampling;
+}
+
 FontFaceFreeType::FontFaceFreeType(Font* font) :
     FontFace(font),
     loadMode_(FT_LOAD_DEFAULT)
@@ -85,6 +161,17 @@ FontFaceFreeType::FontFaceFreeType(Font* font) :
 
 FontFaceFreeType::~FontFaceFreeType()
 {
+    WaitForRasterization();
+
+    if (hasMutableGlyph_ && freeType_)
+        freeType_->RemoveMutableFace(this);
+
+    if (rasterFace_)
+    {
+        FT_Done_Face((FT_Face)rasterFace_);
+        rasterFace_ = nullptr;
+    }
+
     if (face_)
     {
         FT_Done_Face((FT_Face)face_);
@@ -179,7 +266,6 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
 
     int textureWidth = maxTextureSize;
     int textureHeight = maxTextureSize;
-    hasMutableGlyph_ = false;
 
     SharedPtr<Image> image(font_->GetContext()->CreateObject<Image>());
     image->SetSize(textureWidth, textureHeight, 1);
@@ -187,17 +273,18 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
     memset(imageData, 0, (size_t)image->GetWidth() * image->GetHeight());
     allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
 
+    // With mutable glyphs, all glyphs are loaded on demand. Otherwise load as many glyphs as fit into one texture
+    // and switch to mutable glyphs if the rest does not fit
+    hasMutableGlyph_ = ui->GetUseMutableGlyphs();
+
     ea::unordered_map<FT_UInt, FT_ULong> charCodes;
     FT_UInt glyphIndex;
     FT_ULong charCode = FT_Get_First_Char(face, &glyphIndex);
 
     while (glyphIndex != 0)
     {
-        if (!LoadCharGlyph(charCode, image))
-        {
+        if (!hasMutableGlyph_ && !LoadCharGlyph(charCode, image))
             hasMutableGlyph_ = true;
-            break;
-        }
 
         // TODO: FT_Get_Next_Char can return same glyphIndex for different charCode
         charCodes[glyphIndex] = charCode;
@@ -287,6 +374,29 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
         FT_Done_Face(face);
         face_ = nullptr;
     }
+    else
+    {
+        // The first texture becomes the first page of mutable glyphs
+        GlyphPage& page = pages_.emplace_back();
+        page.allocator_ = allocator_;
+        page.image_ = image;
+        maxPages_ = MAX_MUTABLE_GLYPH_PAGES;
+        freeType->AddMutableFace(this);
+
+        // Rasterize in the background with a separate face, as FreeType faces may not be shared between threads
+        auto* queue = font_->GetSubsystem<WorkQueue>();
+        if (queue)
+        {
+            FT_Face rasterFace;
+            if (!FT_New_Memory_Face(library, fontData, fontDataSize, 0, &rasterFace))
+            {
+                if (!FT_Set_Char_Size(rasterFace, 0, pointSize * 64, oversampling_ * FONT_DPI, FONT_DPI))
+                    rasterFace_ = rasterFace;
+                else
+                    FT_Done_Face(rasterFace);
+            }
+        }
+    }
 
     return true;
 }
@@ -298,10 +408,17 @@ const FontGlyph* FontFaceFreeType::GetGlyph(unsigned c)
     {
         FontGlyph& glyph = i->second;
         glyph.used_ = true;
+        if (glyph.page_ < pages_.size())
+            pages_[glyph.page_].lastUsedFrame_ = frameNumber_;
+        else if (hasMutableGlyph_ && glyph.page_ == M_MAX_UNSIGNED && requestedGlyphs_.insert(c).second)
+        {
+            // Glyph was evicted, rasterize it again
+            queuedGlyphs_.push_back(c);
+        }
         return &glyph;
     }
 
-    if (LoadCharGlyph(c))
+    if (rasterFace_ ? LoadCharMetrics(c) : LoadCharGlyph(c))
     {
         auto i = glyphMapping_.find(c);
         if (i != glyphMapping_.end())
@@ -315,8 +432,11 @@ const FontGlyph* FontFaceFreeType::GetGlyph(unsigned c)
     return nullptr;
 }
 
-bool FontFaceFreeType::SetupNextTexture(int textureWidth, int textureHeight)
+bool FontFaceFreeType::AddGlyphPage()
 {
+    const int textureWidth = pages_[0].image_->GetWidth();
+    const int textureHeight = pages_[0].image_->GetHeight();
+
     SharedPtr<Image> image(font_->GetContext()->CreateObject<Image>());
     image->SetSize(textureWidth, textureHeight, 1);
     unsigned char* imageData = image->GetData();
@@ -327,14 +447,216 @@ bool FontFaceFreeType::SetupNextTexture(int textureWidth, int textureHeight)
         return false;
 
     textures_.push_back(texture);
-    allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
-
     font_->SetMemoryUse(font_->GetMemoryUse() + textureWidth * textureHeight);
 
+    GlyphPage& page = pages_.emplace_back();
+    page.allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
+    page.image_ = image;
+    page.lastUsedFrame_ = frameNumber_;
+
     return true;
 }
 
-void FontFaceFreeType::BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize)
+void FontFaceFreeType::EvictGlyphPage(unsigned index)
+{
+    for (auto& item : glyphMapping_)
+    {
+        FontGlyph& glyph = item.second;
+        if (glyph.page_ == index && glyph.texWidth_ > 0 && glyph.texHeight_ > 0)
+            glyph.page_ = M_MAX_UNSIGNED;
+    }
+
+    GlyphPage& page = pages_[index];
+    Image* image = page.image_;
+    page.allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, image->GetWidth(), image->GetHeight());
+    memset(image->GetData(), 0, (size_t)image->GetWidth() * image->GetHeight());
+    page.dirtyMinY_ = 0;
+    page.dirtyMaxY_ = image->GetHeight();
+    page.lastUsedFrame_ = frameNumber_;
+
+    ++numEvictedPages_;
+    ++glyphsVersion_;
+}
+
+void FontFaceFreeType::PlaceGlyph(RasterizedGlyph& rasterized)
+{
+    FontGlyph& fontGlyph = rasterized.glyph_;
+    requestedGlyphs_.erase(rasterized.charCode_);
+
+    if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0)
+    {
+        const int width = fontGlyph.texWidth_ + 1;
+        const int height = fontGlyph.texHeight_ + 1;
+
+        // Try the newest pages first, as the older ones are more likely to be full
+        int x = 0, y = 0;
+        unsigned pageIndex = M_MAX_UNSIGNED;
+        for (unsigned i = pages_.size(); i-- > 0;)
+        {
+            if (pages_[i].allocator_.Allocate(width, height, x, y))
+            {
+                pageIndex = i;
+                break;
+            }
+        }
+
+        if (pageIndex == M_MAX_UNSIGNED)
+        {
+            // Evict the least recently used page, unless it was needed by the last frame. In that case go over the budget
+            unsigned evictIndex = M_MAX_UNSIGNED;
+            if (pages_.size() >= maxPages_)
+            {
+                for (unsigned i = 0; i < pages_.size(); ++i)
+                {
+                    const unsigned lastUsedFrame = pages_[i].lastUsedFrame_;
+                    if (lastUsedFrame + 1 < frameNumber_ &&
+                        (evictIndex == M_MAX_UNSIGNED || lastUsedFrame < pages_[evictIndex].lastUsedFrame_))
+                        evictIndex = i;
+                }
+            }
+
+            if (evictIndex != M_MAX_UNSIGNED)
+            {
+                EvictGlyphPage(evictIndex);
+                pageIndex = evictIndex;
+            }
+            else if (AddGlyphPage())
+                pageIndex = pages_.size() - 1;
+            else
+            {
+                const int w = pages_[0].image_->GetWidth();
+                const int h = pages_[0].image_->GetHeight();
+                URHO3D_LOGWARNINGF("FontFaceFreeType::PlaceGlyph: failed to allocate new %dx%d texture", w, h);
+            }
+
+            if (pageIndex != M_MAX_UNSIGNED && !pages_[pageIndex].allocator_.Allocate(width, height, x, y))
+            {
+                URHO3D_LOGWARNINGF("FontFaceFreeType::PlaceGlyph: failed to position char code %u in blank page",
+                    rasterized.charCode_);
+                pageIndex = M_MAX_UNSIGNED;
+            }
+        }
+
+        if (pageIndex != M_MAX_UNSIGNED)
+        {
+            GlyphPage& page = pages_[pageIndex];
+            Image* image = page.image_;
+            const unsigned pitch = (unsigned)image->GetWidth();
+            unsigned char* dest = image->GetData() + y * pitch + x;
+            for (int row = 0; row < fontGlyph.texHeight_; ++row)
+                memcpy(dest + row * pitch, &rasterized.bitmap_[row * fontGlyph.texWidth_], (size_t)fontGlyph.texWidth_);
+
+            page.dirtyMinY_ = Min(page.dirtyMinY_, y);
+            page.dirtyMaxY_ = Max(page.dirtyMaxY_, y + fontGlyph.texHeight_);
+            page.lastUsedFrame_ = frameNumber_;
+
+            fontGlyph.x_ = (short)x;
+            fontGlyph.y_ = (short)y;
+            fontGlyph.page_ = pageIndex;
+        }
+        else
+        {
+            // Do not retry a glyph that can never be placed
+            fontGlyph.texWidth_ = 0;
+            fontGlyph.texHeight_ = 0;
+            fontGlyph.x_ = 0;
+            fontGlyph.y_ = 0;
+            fontGlyph.page_ = 0;
+        }
+    }
+    else
+    {
+        fontGlyph.x_ = 0;
+        fontGlyph.y_ = 0;
+        fontGlyph.page_ = 0;
+    }
+
+    FontGlyph& storedGlyph = glyphMapping_[rasterized.charCode_];
+    const bool used = storedGlyph.used_;
+    storedGlyph = fontGlyph;
+    storedGlyph.used_ = used;
+
+    ++glyphsVersion_;
+}
+
+void FontFaceFreeType::ProcessGlyphRequests(unsigned frameNumber)
+{
+    frameNumber_ = frameNumber;
+
+    if (rasterItem_ && rasterizationDone_.load(std::memory_order_acquire))
+    {
+        URHO3D_PROFILE("PlaceFontGlyphs");
+
+        for (RasterizedGlyph& rasterized : rasterizedGlyphs_)
+            PlaceGlyph(rasterized);
+        numRasterizedGlyphs_ += rasterizedGlyphs_.size();
+
+        rasterizedGlyphs_.clear();
+        rasterizingGlyphs_.clear();
+        rasterItem_.Reset();
+    }
+
+    UploadGlyphPages();
+
+    if (!rasterItem_ && !queuedGlyphs_.empty())
+    {
+        auto* queue = font_->GetSubsystem<WorkQueue>();
+        if (!queue)
+            return;
+
+        rasterizingGlyphs_.swap(queuedGlyphs_);
+        rasterizedGlyphs_.resize(rasterizingGlyphs_.size());
+        rasterizationDone_.store(false, std::memory_order_relaxed);
+        rasterItem_ = queue->AddWorkItem([this]()
+        {
+            for (unsigned i = 0; i < rasterizingGlyphs_.size(); ++i)
+            {
+                RasterizedGlyph& rasterized = rasterizedGlyphs_[i];
+                rasterized.charCode_ = rasterizingGlyphs_[i];
+                RasterizeGlyph(rasterFace_, rasterized.charCode_, rasterized.glyph_, rasterized.bitmap_);
+            }
+            rasterizationDone_.store(true, std::memory_order_release);
+        });
+    }
+}
+
+void FontFaceFreeType::UploadGlyphPages()
+{
+    // Upload the modified rows of each page at once instead of one upload per glyph
+    for (unsigned i = 0; i < pages_.size(); ++i)
+    {
+        GlyphPage& page = pages_[i];
+        if (page.dirtyMinY_ >= page.dirtyMaxY_)
+            continue;
+
+        const int width = page.image_->GetWidth();
+        const int height = page.dirtyMaxY_ - page.dirtyMinY_;
+        textures_[i]->SetData(0, 0, page.dirtyMinY_, width, height, page.image_->GetData() + page.dirtyMinY_ * width);
+        numUploadedBytes_ += (unsigned long long)width * height;
+
+        page.dirtyMinY_ = M_MAX_INT;
+        page.dirtyMaxY_ = 0;
+    }
+}
+
+void FontFaceFreeType::WaitForRasterization()
+{
+    if (!rasterItem_)
+        return;
+
+    // The work item may only be waited on if it is already running, otherwise it could be that no thread picks it up.
+    // While the rasterization is not done the work queue does not recycle the item, so removing it is safe
+    auto* queue = font_ ? font_->GetSubsystem<WorkQueue>() : nullptr;
+    if (!rasterizationDone_.load(std::memory_order_acquire) && queue && !queue->RemoveWorkItem(rasterItem_))
+    {
+        while (!rasterizationDone_.load(std::memory_order_acquire))
+            Time::Sleep(0);
+    }
+
+    rasterItem_.Reset();
+}
+
+void FontFaceFreeType::BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize) const
 {
     const int filterSize = oversampling_;
 
@@ -394,6 +716,55 @@ void FontFaceFreeType::BoxFilter(unsigned char* dest, size_t destSize, const uns
 }
 
 bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
+{
+    if (!face_)
+        return false;
+
+    RasterizedGlyph rasterized;
+    rasterized.charCode_ = charCode;
+    RasterizeGlyph(face_, charCode, rasterized.glyph_, rasterized.bitmap_);
+
+    // Without a fixed image, place the glyph into the mutable glyph pages
+    if (!image)
+    {
+        PlaceGlyph(rasterized);
+        UploadGlyphPages();
+        ++numRasterizedGlyphs_;
+        return true;
+    }
+
+    FontGlyph& fontGlyph = rasterized.glyph_;
+    if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0)
+    {
+        int x = 0, y = 0;
+        if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
+        {
+            // We're rendering into a fixed image and we ran out of room.
+            return false;
+        }
+
+        fontGlyph.x_ = (short)x;
+        fontGlyph.y_ = (short)y;
+        fontGlyph.page_ = 0;
+
+        const unsigned pitch = (unsigned)image->GetWidth();
+        unsigned char* dest = image->GetData() + fontGlyph.y_ * pitch + fontGlyph.x_;
+        for (int row = 0; row < fontGlyph.texHeight_; ++row)
+            memcpy(dest + row * pitch, &rasterized.bitmap_[row * fontGlyph.texWidth_], (size_t)fontGlyph.texWidth_);
+    }
+    else
+    {
+        fontGlyph.x_ = 0;
+        fontGlyph.y_ = 0;
+        fontGlyph.page_ = 0;
+    }
+
+    glyphMapping_[charCode] = fontGlyph;
+
+    return true;
+}
+
+bool FontFaceFreeType::LoadCharMetrics(unsigned charCode)
 {
     if (!face_)
         return false;
@@ -402,127 +773,87 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
     FT_GlyphSlot slot = face->glyph;
 
     FontGlyph fontGlyph;
-    FT_Error error = FT_Load_Char(face, charCode, loadMode_ | FT_LOAD_RENDER);
+    FT_Error error = FT_Load_Char(face, charCode, loadMode_);
     if (error)
     {
         const char* family = face->family_name ? face->family_name : "NULL";
         URHO3D_LOGERRORF("FT_Load_Char failed (family: %s, char code: %u)", family, charCode);
-        fontGlyph.texWidth_ = 0;
-        fontGlyph.texHeight_ = 0;
-        fontGlyph.width_ = 0;
-        fontGlyph.height_ = 0;
-        fontGlyph.offsetX_ = 0;
-        fontGlyph.offsetY_ = 0;
-        fontGlyph.advanceX_ = 0;
         fontGlyph.page_ = 0;
     }
     else
     {
-        // Note: position within texture will be filled later
-        fontGlyph.texWidth_ = slot->bitmap.width + oversampling_ - 1;
-        fontGlyph.texHeight_ = slot->bitmap.rows;
-        fontGlyph.width_ = slot->bitmap.width + oversampling_ - 1;
-        fontGlyph.height_ = slot->bitmap.rows;
-        fontGlyph.offsetX_ = slot->bitmap_left - (oversampling_ - 1) / 2.0f;
-        fontGlyph.offsetY_ = floorf(ascender_ + 0.5f) - slot->bitmap_top;
+        SetGlyphMetrics(fontGlyph, slot, oversampling_, ascender_, subpixel_);
 
-        if (subpixel_ && slot->linearHoriAdvance)
+        // The glyph stays non-resident until rasterized in the background, unless there is nothing to draw
+        const bool empty = slot->format == FT_GLYPH_FORMAT_OUTLINE ? slot->outline.n_points == 0 :
+            (slot->bitmap.width == 0 || slot->bitmap.rows == 0);
+        if (empty)
         {
-            // linearHoriAdvance is stored in 16.16 fixed point, not the usual 26.6
-            fontGlyph.advanceX_ = slot->linearHoriAdvance / 65536.0;
+            fontGlyph.texWidth_ = 0;
+            fontGlyph.texHeight_ = 0;
+            fontGlyph.page_ = 0;
         }
         else
         {
-            // Round to nearest pixel (only necessary when hinting is disabled)
-            fontGlyph.advanceX_ = floorf(FixedToFloat(slot->metrics.horiAdvance) + 0.5f);
+            fontGlyph.page_ = M_MAX_UNSIGNED;
+            requestedGlyphs_.insert(charCode);
+            queuedGlyphs_.push_back(charCode);
         }
-
-        fontGlyph.width_ /= oversampling_;
-        fontGlyph.offsetX_ /= oversampling_;
-        fontGlyph.advanceX_ /= oversampling_;
     }
 
-    int x = 0, y = 0;
-    if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0)
-    {
-        if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
-        {
-            if (image)
-            {
-                // We're rendering into a fixed image and we ran out of room.
-                return false;
-            }
+    glyphMapping_[charCode] = fontGlyph;
 
-            int w = allocator_.GetWidth();
-            int h = allocator_.GetHeight();
-            if (!SetupNextTexture(w, h))
-            {
-                URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: failed to allocate new %dx%d texture", w, h);
-                return false;
-            }
+    return true;
+}
 
-            if (!allocator_.Allocate(fontGlyph.texWidth_ + 1, fontGlyph.texHeight_ + 1, x, y))
-            {
-                URHO3D_LOGWARNINGF("FontFaceFreeType::LoadCharGlyph: failed to position char code %u in blank page", charCode);
-                return false;
-            }
-        }
+bool FontFaceFreeType::RasterizeGlyph(void* face, unsigned charCode, FontGlyph& fontGlyph, ea::vector<unsigned char>& bitmap) const
+{
+    auto ftFace = (FT_Face)face;
+    FT_GlyphSlot slot = ftFace->glyph;
 
-        fontGlyph.x_ = (short)x;
-        fontGlyph.y_ = (short)y;
+    FT_Error error = FT_Load_Char(ftFace, charCode, loadMode_ | FT_LOAD_RENDER);
+    if (error)
+    {
+        const char* family = ftFace->family_name ? ftFace->family_name : "NULL";
+        URHO3D_LOGERRORF("FT_Load_Char failed (family: %s, char code: %u)", family, charCode);
+        fontGlyph = FontGlyph();
+        fontGlyph.page_ = 0;
+        bitmap.clear();
+        return false;
+    }
 
-        unsigned char* dest = nullptr;
-        unsigned pitch = 0;
-        if (image)
-        {
-            fontGlyph.page_ = 0;
-            dest = image->GetData() + fontGlyph.y_ * image->GetWidth() + fontGlyph.x_;
-            pitch = (unsigned)image->GetWidth();
-        }
-        else
-        {
-            fontGlyph.page_ = textures_.size() - 1;
-            dest = new unsigned char[fontGlyph.texWidth_ * fontGlyph.texHeight_];
-            pitch = (unsigned)fontGlyph.texWidth_;
-        }
+    SetGlyphMetrics(fontGlyph, slot, oversampling_, ascender_, subpixel_);
 
-        if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
-        {
-            for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
-            {
-                unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                unsigned char* rowDest = dest + (oversampling_ - 1)/2 + y * pitch;
+    bitmap.clear();
+    if (fontGlyph.texWidth_ <= 0 || fontGlyph.texHeight_ <= 0)
+        return true;
 
-                // Don't do any oversampling, just unpack the bits directly.
-                for (unsigned x = 0; x < (unsigned)slot->bitmap.width; ++x)
-                    rowDest[x] = (unsigned char)((src[x >> 3u] & (0x80u >> (x & 7u))) ? 255 : 0);
-            }
-        }
-        else
-        {
-            for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
-            {
-                unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                unsigned char* rowDest = dest + y * pitch;
-                BoxFilter(rowDest, fontGlyph.texWidth_, src, slot->bitmap.width);
-            }
-        }
+    const unsigned pitch = (unsigned)fontGlyph.texWidth_;
+    bitmap.resize(pitch * fontGlyph.texHeight_, 0);
+    unsigned char* dest = bitmap.data();
 
-        if (!image)
+    if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+    {
+        for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
         {
-            textures_.back()->SetData(0, fontGlyph.x_, fontGlyph.y_, fontGlyph.texWidth_, fontGlyph.texHeight_, dest);
-            delete[] dest;
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = dest + (oversampling_ - 1)/2 + y * pitch;
+
+            // Don't do any oversampling, just unpack the bits directly.
+            for (unsigned x = 0; x < (unsigned)slot->bitmap.width; ++x)
+                rowDest[x] = (unsigned char)((src[x >> 3u] & (0x80u >> (x & 7u))) ? 255 : 0);
         }
     }
     else
     {
-        fontGlyph.x_ = 0;
-        fontGlyph.y_ = 0;
-        fontGlyph.page_ = 0;
+        for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
+        {
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = dest + y * pitch;
+            BoxFilter(rowDest, fontGlyph.texWidth_, src, slot->bitmap.width);
+        }
     }
 
-    glyphMapping_[charCode] = fontGlyph;
-
     return true;
 }
 
@@ -24,15 +24,23 @@
 
 #include "../UI/FontFace.h"
 
+#include <EASTL/unordered_set.h>
+
+#include <atomic>
+
 namespace Urho3D
 {
 
 class FreeTypeLibrary;
+class Image;
 class Texture2D;
+struct WorkItem;
 
 /// Free type font face description.
 class URHO3D_API FontFaceFreeType : public FontFace
 {
+    friend class FreeTypeLibrary;
+
 public:
     /// Construct.
     explicit FontFaceFreeType(Font* font);
@@ -47,18 +55,69 @@ public:
     /// Return if font face uses mutable glyphs.
     bool HasMutableGlyphs() const override { return hasMutableGlyph_; }
 
+    /// Return number of glyphs waiting to be rasterized or placed into a texture.
+    unsigned GetNumPendingGlyphs() const { return requestedGlyphs_.size(); }
+    /// Return number of glyphs rasterized on demand since the face was loaded.
+    unsigned GetNumRasterizedGlyphs() const { return numRasterizedGlyphs_; }
+    /// Return number of texture pages evicted to make room for new glyphs.
+    unsigned GetNumEvictedPages() const { return numEvictedPages_; }
+    /// Return number of texture bytes uploaded for glyphs rasterized on demand.
+    unsigned long long GetNumUploadedBytes() const { return numUploadedBytes_; }
+
 private:
-    /// Setup next texture.
-    bool SetupNextTexture(int textureWidth, int textureHeight);
+    /// Texture page of a face with mutable glyphs.
+    struct GlyphPage
+    {
+        /// Glyph area allocator.
+        AreaAllocator allocator_;
+        /// CPU copy of the texture.
+        SharedPtr<Image> image_;
+        /// First texture row modified since the last upload.
+        int dirtyMinY_{M_MAX_INT};
+        /// Last texture row modified since the last upload, exclusive.
+        int dirtyMaxY_{};
+        /// Frame number when a glyph on this page was last used.
+        unsigned lastUsedFrame_{};
+    };
+
+    /// Glyph rasterized in the background, waiting to be placed into a texture.
+    struct RasterizedGlyph
+    {
+        /// Character code.
+        unsigned charCode_{};
+        /// Glyph metrics.
+        FontGlyph glyph_;
+        /// Tightly packed glyph bitmap.
+        ea::vector<unsigned char> bitmap_;
+    };
+
     /// Load char glyph.
     bool LoadCharGlyph(unsigned charCode, Image* image = nullptr);
+    /// Load glyph metrics only and queue the glyph for rasterization. Return false if the glyph could not be loaded.
+    bool LoadCharMetrics(unsigned charCode);
+    /// Rasterize glyph into a tightly packed bitmap. Only reads immutable face state, so it is safe to call from a worker thread with a face that is not used elsewhere.
+    bool RasterizeGlyph(void* face, unsigned charCode, FontGlyph& glyph, ea::vector<unsigned char>& bitmap) const;
+    /// Place rasterized glyph into a texture page, evicting the least recently used page if needed.
+    void PlaceGlyph(RasterizedGlyph& rasterized);
+    /// Add an empty texture page.
+    bool AddGlyphPage();
+    /// Evict all glyphs of a texture page and clear it.
+    void EvictGlyphPage(unsigned index);
+    /// Place finished glyphs, upload modified texture rows and start rasterizing queued glyphs. Called by the FreeType library on frame begin and end.
+    void ProcessGlyphRequests(unsigned frameNumber);
+    /// Upload modified texture rows of the mutable glyph pages.
+    void UploadGlyphPages();
+    /// Wait for the background rasterization to finish.
+    void WaitForRasterization();
     /// Smooth one row of a horizontally oversampled glyph image.
-    void BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize);
+    void BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize) const;
 
     /// FreeType library.
     SharedPtr<FreeTypeLibrary> freeType_;
     /// FreeType face. Non-null after creation only in dynamic mode.
     void* face_{};
+    /// FreeType face used only by the background rasterization. Non-null after creation only in dynamic mode.
+    void* rasterFace_{};
     /// Load mode.
     int loadMode_{};
     /// Use subpixel glyph positioning?
@@ -71,6 +130,30 @@ private:
     bool hasMutableGlyph_{};
     /// Glyph area allocator.
     AreaAllocator allocator_;
+    /// Texture pages in dynamic mode, parallel to the textures.
+    ea::vector<GlyphPage> pages_;
+    /// Maximum number of texture pages before the least recently used one is evicted.
+    unsigned maxPages_{};
+    /// Current frame number.
+    unsigned frameNumber_{};
+    /// Glyphs requested but not yet placed into a texture.
+    ea::unordered_set<unsigned> requestedGlyphs_;
+    /// Glyphs requested but not yet sent to rasterization.
+    ea::vector<unsigned> queuedGlyphs_;
+    /// Glyphs sent to the background rasterization.
+    ea::vector<unsigned> rasterizingGlyphs_;
+    /// Results of the background rasterization.
+    ea::vector<RasterizedGlyph> rasterizedGlyphs_;
+    /// Background rasterization work item.
+    SharedPtr<WorkItem> rasterItem_;
+    /// Set by the background rasterization when it is done. The work item itself is returned to the pool and reset by the work queue.
+    std::atomic<bool> rasterizationDone_{};
+    /// Number of glyphs rasterized on demand.
+    unsigned numRasterizedGlyphs_{};
+    /// Number of evicted texture pages.
+    unsigned numEvictedPages_{};
+    /// Number of uploaded texture bytes.
+    unsigned long long numUploadedBytes_{};
 };
 
 }
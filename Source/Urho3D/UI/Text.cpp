@@ -53,12 +53,14 @@ extern const char* UI_CATEGORY;
 
 Text::Text(Context* context) :
     UISelectable(context),
+    fontFaceGlyphsVersion_(0),
     fontSize_(DEFAULT_FONT_SIZE),
     textAlignment_(HA_LEFT),
     rowSpacing_(1.0f),
     wordWrap_(false),
     autoLocalizable_(false),
     charLocationsDirty_(true),
+    charLocationsDirtyRow_(0),
     selectionStart_(0),
     selectionLength_(0),
     textEffect_(TE_NONE),
@@ -67,7 +69,11 @@ Text::Text(Context* context) :
     roundStroke_(false),
     effectColor_(Color::BLACK),
     effectDepthBias_(0.0f),
-    rowHeight_(0)
+    rowHeight_(0),
+    layoutRowSpacing_(0.0f),
+    layoutWordwrap_(false),
+    layoutWidth_(0),
+    layoutDirtyChar_(0)
 {
     // By default Text does not derive opacity from parent elements
     useDerivedOpacity_ = false;
@@ -114,6 +120,10 @@ void Text::ApplyAttributes()
     fontSize_ = Max(fontSize_, 1);
     strokeThickness_ = Abs(strokeThickness_);
     ValidateSelection();
+
+    // Attributes are written directly, so do not reuse any of the previous layout
+    layoutDirtyChar_ = 0;
+    charLocationsDirtyRow_ = 0;
     UpdateText();
 }
 
@@ -127,14 +137,11 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
     }
 
     // If face has changed or char locations are not valid anymore, update before rendering
-    if (charLocationsDirty_ || !fontFace_ || face != fontFace_)
+    if (charLocationsDirty_ || !fontFace_ || face != fontFace_ || AreGlyphsOutdated())
         UpdateCharLocations();
-    // If face uses mutable glyphs mechanism, reacquire glyphs before rendering to make sure they are in the texture
-    else if (face->HasMutableGlyphs())
-    {
-        for (unsigned i = 0; i < printText_.size(); ++i)
-            face->GetGlyph(printText_[i]);
-    }
+    // Reacquire mutable glyphs before rendering to make sure they are in the texture. Also needed after an update, as
+    // glyphs of the rows that were kept are not acquired by it
+    ReacquireGlyphs();
 
     // Hovering and/or whole selection batch
     UISelectable::GetBatches(batches, vertexData, currentScissor);
@@ -177,6 +184,7 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
     // Text batch
     TextEffect textEffect = font_->IsSDFFont() ? TE_NONE : textEffect_;
     const ea::vector<SharedPtr<Texture2D> >& textures = face->GetTextures();
+    ea::vector<Vector2> effectOffsets;
     for (unsigned n = 0; n < textures.size() && n < pageGlyphLocations_.size(); ++n)
     {
         // One batch per texture/page
@@ -196,6 +204,7 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
             break;
 
         case TE_STROKE:
+            effectOffsets.clear();
             if (roundStroke_)
             {
                 // Samples should be even or glyph may be redrawn in wrong x y pos making stroke corners rough
@@ -209,7 +218,7 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
                 {
                     float x = Cos(angle * i) * floatThickness;
                     float y = Sin(angle * i) * floatThickness;
-                    ConstructBatch(pageBatch, pageGlyphLocation, x, y, &effectColor_, effectDepthBias_);
+                    effectOffsets.push_back(Vector2(x, y));
                 }
             }
             else
@@ -225,10 +234,11 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
                             y > -thickness && y < thickness)
                             continue;
 
-                        ConstructBatch(pageBatch, pageGlyphLocation, x, y, &effectColor_, effectDepthBias_);
+                        effectOffsets.push_back(Vector2((float)x, (float)y));
                     }
                 }
             }
+            ConstructEffectBatch(pageBatch, pageGlyphLocation, effectOffsets);
             ConstructBatch(pageBatch, pageGlyphLocation, 0, 0);
             break;
         }
@@ -237,8 +247,19 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
     }
 }
 
+bool Text::CanCacheBatches() const
+{
+    // Mutable glyphs must be reacquired each frame to keep them in the texture
+    FontFace* face = font_ ? font_->GetFace(fontSize_) : nullptr;
+    return face && face == fontFace_ && !charLocationsDirty_ && !face->HasMutableGlyphs();
+}
+
 void Text::OnResize(const IntVector2& newSize, const IntVector2& delta)
 {
+    // Row start positions depend on the width unless rows are left-aligned
+    if (textAlignment_ == HA_CENTER || textAlignment_ == HA_RIGHT)
+        charLocationsDirtyRow_ = 0;
+
     if (wordWrap_)
         UpdateText(true);
     else
@@ -248,6 +269,7 @@ void Text::OnResize(const IntVector2& newSize, const IntVector2& delta)
 void Text::OnIndentSet()
 {
     charLocationsDirty_ = true;
+    charLocationsDirtyRow_ = 0;
 }
 
 bool Text::SetFont(const ea::string& fontName, float size)
@@ -285,9 +307,31 @@ bool Text::SetFontSize(float size)
 
 void Text::DecodeToUnicode()
 {
-    unicodeText_.clear();
-    for (unsigned i = 0; i < text_.length();)
-        unicodeText_.push_back(NextUTF8Char(text_, i));
+    unsigned firstChanged = M_MAX_UNSIGNED;
+    unsigned numChars = 0;
+    for (unsigned i = 0; i < text_.length(); ++numChars)
+    {
+        unsigned c = NextUTF8Char(text_, i);
+        if (numChars < unicodeText_.size())
+        {
+            if (unicodeText_[numChars] == c)
+                continue;
+            unicodeText_[numChars] = c;
+        }
+        else
+            unicodeText_.push_back(c);
+
+        if (firstChanged == M_MAX_UNSIGNED)
+            firstChanged = numChars;
+    }
+
+    if (numChars < unicodeText_.size())
+    {
+        unicodeText_.resize(numChars);
+        firstChanged = Min(firstChanged, numChars);
+    }
+
+    layoutDirtyChar_ = Min(layoutDirtyChar_, firstChanged);
 }
 
 void Text::SetText(const ea::string& text)
@@ -314,6 +358,7 @@ void Text::SetTextAlignment(HorizontalAlignment align)
     {
         textAlignment_ = align;
         charLocationsDirty_ = true;
+        charLocationsDirtyRow_ = 0;
     }
 }
 
@@ -373,42 +418,50 @@ void Text::SetSelection(unsigned start, unsigned length)
     selectionStart_ = start;
     selectionLength_ = length;
     ValidateSelection();
+    MarkBatchesDirty();
 }
 
 void Text::ClearSelection()
 {
     selectionStart_ = 0;
     selectionLength_ = 0;
+    MarkBatchesDirty();
 }
 
 void Text::SetTextEffect(TextEffect textEffect)
 {
     textEffect_ = textEffect;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectShadowOffset(const IntVector2& offset)
 {
     shadowOffset_ = offset;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectStrokeThickness(int thickness)
 {
     strokeThickness_ = Abs(thickness);
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectRoundStroke(bool roundStroke)
 {
     roundStroke_ = roundStroke;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectColor(const Color& effectColor)
 {
     effectColor_ = effectColor;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectDepthBias(float bias)
 {
     effectDepthBias_ = bias;
+    MarkBatchesDirty();
 }
 
 float Text::GetRowWidth(unsigned index) const
@@ -440,6 +493,20 @@ Vector2 Text::GetCharSize(unsigned index)
     return charLocations_[index].size_;
 }
 
+bool Text::AreGlyphsOutdated() const
+{
+    return fontFace_ && fontFace_->GetGlyphsVersion() != fontFaceGlyphsVersion_;
+}
+
+void Text::ReacquireGlyphs()
+{
+    if (!fontFace_ || !fontFace_->HasMutableGlyphs())
+        return;
+
+    for (unsigned i = 0; i < printText_.size(); ++i)
+        fontFace_->GetGlyph(printText_[i]);
+}
+
 void Text::SetFontAttr(const ResourceRef& value)
 {
     auto* cache = GetSubsystem<ResourceCache>();
@@ -486,8 +553,7 @@ bool Text::FilterImplicitAttributes(XMLElement& dest) const
 
 void Text::UpdateText(bool onResize)
 {
-    rowWidths_.clear();
-    printText_.clear();
+    bool layoutChanged = false;
 
     if (font_)
     {
@@ -495,151 +561,198 @@ void Text::UpdateText(bool onResize)
         if (!face)
             return;
 
+        // Rows can be reused only when they were laid out with the same face, spacing and wrap width
+        if (face != layoutFace_ || rowSpacing_ != layoutRowSpacing_ || wordWrap_ != layoutWordwrap_ ||
+            (wordWrap_ && GetWidth() != layoutWidth_))
+            layoutDirtyChar_ = 0;
+
         rowHeight_ = face->GetRowHeight();
 
-        int width = 0;
-        int height = 0;
-        int rowWidth = 0;
         auto rowHeight = RoundToInt(rowSpacing_ * rowHeight_);
 
-        // First see if the text must be split up
-        if (!wordWrap_)
-        {
-            printText_ = unicodeText_;
-            printToText_.resize(printText_.size());
-            for (unsigned i = 0; i < printText_.size(); ++i)
-                printToText_[i] = i;
-        }
-        else
+        if (layoutDirtyChar_ != M_MAX_UNSIGNED)
         {
-            int maxWidth = GetWidth();
-            unsigned nextBreak = 0;
-            unsigned lineStart = 0;
-            printToText_.clear();
+            layoutChanged = true;
 
-            for (unsigned i = 0; i < unicodeText_.size(); ++i)
+            // Rows before the last explicit line break preceding the first modified character are not affected
+            unsigned textStart = 0;
+            unsigned printStart = 0;
+            if (layoutDirtyChar_ > 0)
             {
-                unsigned j;
-                unsigned c = unicodeText_[i];
+                textStart = Min(layoutDirtyChar_, unicodeText_.size());
+                while (textStart > 0 && unicodeText_[textStart - 1] != '\n')
+                    --textStart;
 
-                if (c != '\n')
+                if (textStart > 0)
+                {
+                    printStart = printText_.size();
+                    while (printStart > 0 && (printText_[printStart - 1] != '\n' || printToText_[printStart - 1] != textStart - 1))
+                        --printStart;
+                    if (!printStart)
+                        textStart = 0;
+                }
+            }
+
+            unsigned rowStart = 0;
+            for (unsigned i = 0; i < printStart; ++i)
+            {
+                if (printText_[i] == '\n')
+                    ++rowStart;
+            }
+
+            printText_.resize(printStart);
+            printToText_.resize(printStart);
+            rowWidths_.resize(rowStart);
+
+            int rowWidth = 0;
+
+            // First see if the text must be split up
+            if (!wordWrap_)
+            {
+                for (unsigned i = textStart; i < unicodeText_.size(); ++i)
                 {
-                    bool ok = true;
+                    printText_.push_back(unicodeText_[i]);
+                    printToText_.push_back(i);
+                }
+            }
+            else
+            {
+                int maxWidth = GetWidth();
+                unsigned nextBreak = textStart ? textStart - 1 : 0;
+                unsigned lineStart = nextBreak;
 
-                    if (nextBreak <= i)
+                for (unsigned i = textStart; i < unicodeText_.size(); ++i)
+                {
+                    unsigned j;
+                    unsigned c = unicodeText_[i];
+
+                    if (c != '\n')
                     {
-                        int futureRowWidth = rowWidth;
-                        for (j = i; j < unicodeText_.size(); ++j)
+                        bool ok = true;
+
+                        if (nextBreak <= i)
                         {
-                            unsigned d = unicodeText_[j];
-                            if (d == ' ' || d == '\n')
-                            {
-                                nextBreak = j;
-                                break;
-                            }
-                            const FontGlyph* glyph = face->GetGlyph(d);
-                            if (glyph)
+                            int futureRowWidth = rowWidth;
+                            for (j = i; j < unicodeText_.size(); ++j)
                             {
-                                futureRowWidth += glyph->advanceX_;
-                                if (j < unicodeText_.size() - 1)
-                                    futureRowWidth += face->GetKerning(d, unicodeText_[j + 1]);
+                                unsigned d = unicodeText_[j];
+                                if (d == ' ' || d == '\n')
+                                {
+                                    nextBreak = j;
+                                    break;
+                                }
+                                const FontGlyph* glyph = face->GetGlyph(d);
+                                if (glyph)
+                                {
+                                    futureRowWidth += glyph->advanceX_;
+                                    if (j < unicodeText_.size() - 1)
+                                        futureRowWidth += face->GetKerning(d, unicodeText_[j + 1]);
+                                }
+                                if (d == '-' && futureRowWidth <= maxWidth)
+                                {
+                                    nextBreak = j + 1;
+                                    break;
+                                }
+                                if (futureRowWidth > maxWidth)
+                                {
+                                    ok = false;
+                                    break;
+                                }
                             }
-                            if (d == '-' && futureRowWidth <= maxWidth)
+                        }
+
+                        if (!ok)
+                        {
+                            // If did not find any breaks on the line, copy until j, or at least 1 char, to prevent infinite loop
+                            if (nextBreak == lineStart)
                             {
-                                nextBreak = j + 1;
-                                break;
+                                while (i < j)
+                                {
+                                    printText_.push_back(unicodeText_[i]);
+                                    printToText_.push_back(i);
+                                    ++i;
+                                }
                             }
-                            if (futureRowWidth > maxWidth)
+                            // Eliminate spaces that have been copied before the forced break
+                            while (printText_.size() && printText_.back() == ' ')
                             {
-                                ok = false;
-                                break;
+                                printText_.pop_back();
+                                printToText_.pop_back();
                             }
+                            printText_.push_back('\n');
+                            printToText_.push_back(Min(i, unicodeText_.size() - 1));
+                            rowWidth = 0;
+                            nextBreak = lineStart = i;
                         }
-                    }
 
-                    if (!ok)
-                    {
-                        // If did not find any breaks on the line, copy until j, or at least 1 char, to prevent infinite loop
-                        if (nextBreak == lineStart)
+                        if (i < unicodeText_.size())
                         {
-                            while (i < j)
+                            // When copying a space, position is allowed to be over row width
+                            c = unicodeText_[i];
+                            const FontGlyph* glyph = face->GetGlyph(c);
+                            if (glyph)
                             {
-                                printText_.push_back(unicodeText_[i]);
+                                rowWidth += glyph->advanceX_;
+                                if (i < unicodeText_.size() - 1)
+                                    rowWidth += face->GetKerning(c, unicodeText_[i + 1]);
+                            }
+                            if (rowWidth <= maxWidth)
+                            {
+                                printText_.push_back(c);
                                 printToText_.push_back(i);
-                                ++i;
                             }
                         }
-                        // Eliminate spaces that have been copied before the forced break
-                        while (printText_.size() && printText_.back() == ' ')
-                        {
-                            printText_.pop_back();
-                            printToText_.pop_back();
-                        }
+                    }
+                    else
+                    {
                         printText_.push_back('\n');
                         printToText_.push_back(Min(i, unicodeText_.size() - 1));
                         rowWidth = 0;
                         nextBreak = lineStart = i;
                     }
+                }
+            }
 
-                    if (i < unicodeText_.size())
+            rowWidth = 0;
+
+            for (unsigned i = printStart; i < printText_.size(); ++i)
+            {
+                unsigned c = printText_[i];
+
+                if (c != '\n')
+                {
+                    const FontGlyph* glyph = face->GetGlyph(c);
+                    if (glyph)
                     {
-                        // When copying a space, position is allowed to be over row width
-                        c = unicodeText_[i];
-                        const FontGlyph* glyph = face->GetGlyph(c);
-                        if (glyph)
-                        {
-                            rowWidth += glyph->advanceX_;
-                            if (i < unicodeText_.size() - 1)
-                                rowWidth += face->GetKerning(c, unicodeText_[i + 1]);
-                        }
-                        if (rowWidth <= maxWidth)
-                        {
-                            printText_.push_back(c);
-                            printToText_.push_back(i);
-                        }
+                        rowWidth += glyph->advanceX_;
+                        if (i < printText_.size() - 1)
+                            rowWidth += face->GetKerning(c, printText_[i + 1]);
                     }
                 }
                 else
                 {
-                    printText_.push_back('\n');
-                    printToText_.push_back(Min(i, unicodeText_.size() - 1));
+                    rowWidths_.push_back(rowWidth);
                     rowWidth = 0;
-                    nextBreak = lineStart = i;
                 }
             }
-        }
 
-        rowWidth = 0;
+            if (rowWidth)
+                rowWidths_.push_back(rowWidth);
 
-        for (unsigned i = 0; i < printText_.size(); ++i)
-        {
-            unsigned c = printText_[i];
+            layoutFace_ = face;
+            layoutRowSpacing_ = rowSpacing_;
+            layoutWordwrap_ = wordWrap_;
+            layoutWidth_ = GetWidth();
+            layoutDirtyChar_ = M_MAX_UNSIGNED;
 
-            if (c != '\n')
-            {
-                const FontGlyph* glyph = face->GetGlyph(c);
-                if (glyph)
-                {
-                    rowWidth += glyph->advanceX_;
-                    if (i < printText_.size() - 1)
-                        rowWidth += face->GetKerning(c, printText_[i + 1]);
-                }
-            }
-            else
-            {
-                width = Max(width, rowWidth);
-                height += rowHeight;
-                rowWidths_.push_back(rowWidth);
-                rowWidth = 0;
-            }
+            charLocationsDirty_ = true;
+            charLocationsDirtyRow_ = Min(charLocationsDirtyRow_, rowStart);
         }
 
-        if (rowWidth)
-        {
-            width = Max(width, rowWidth);
-            height += rowHeight;
-            rowWidths_.push_back(rowWidth);
-        }
+        int width = 0;
+        for (float rowWidth : rowWidths_)
+            width = Max(width, (int)rowWidth);
+        int height = rowWidths_.size() * rowHeight;
 
         // Set at least one row height even if text is empty
         if (!height)
@@ -657,18 +770,20 @@ void Text::UpdateText(bool onResize)
             }
         }
         SetFixedHeight(height);
-
-        charLocationsDirty_ = true;
     }
     else
     {
         // No font, nothing to render
+        rowWidths_.clear();
+        printText_.clear();
         pageGlyphLocations_.clear();
+        layoutFace_ = nullptr;
+        layoutChanged = true;
     }
 
     // If wordwrap is on, parent may need layout update to correct for overshoot in size. However, do not do this when the
     // update is a response to resize, as that could cause infinite recursion
-    if (wordWrap_ && !onResize)
+    if (wordWrap_ && !onResize && layoutChanged)
     {
         UIElement* parent = GetParent();
         if (parent && parent->GetLayoutMode() != LM_FREE)
@@ -682,25 +797,63 @@ void Text::UpdateCharLocations()
     FontFace* face = font_ ? font_->GetFace(fontSize_) : nullptr;
     if (!face)
         return;
+
+    // Locations of the rows before the first modified one stay valid while the glyphs keep their texture placement
+    unsigned startRow = charLocationsDirtyRow_;
+    if (face != fontFace_ || face->GetGlyphsVersion() != fontFaceGlyphsVersion_ || charLocations_.empty())
+        startRow = 0;
+
     fontFace_ = face;
+    fontFaceGlyphsVersion_ = face->GetGlyphsVersion();
 
     auto rowHeight = RoundToInt(rowSpacing_ * rowHeight_);
+    if (rowHeight <= 0)
+        startRow = 0;
 
-    // Store position & size of each character, and locations per texture page
-    unsigned numChars = unicodeText_.size();
-    charLocations_.resize(numChars + 1);
-    pageGlyphLocations_.resize(face->GetTextures().size());
-    for (unsigned i = 0; i < pageGlyphLocations_.size(); ++i)
-        pageGlyphLocations_[i].clear();
+    unsigned printStart = 0;
+    if (startRow > 0)
+    {
+        unsigned rowIndex = 0;
+        while (printStart < printText_.size() && rowIndex < startRow)
+        {
+            if (printText_[printStart++] == '\n')
+                ++rowIndex;
+        }
+        if (rowIndex < startRow)
+            startRow = printStart = 0;
+    }
 
     IntVector2 offset = font_->GetTotalGlyphOffset(fontSize_);
 
-    unsigned rowIndex = 0;
+    unsigned rowIndex = startRow;
     unsigned lastFilled = 0;
-    float x = Round(GetRowStartPosition(rowIndex) + offset.x_);
+    float x;
     float y = Round(offset.y_);
+    if (!startRow)
+        x = Round(GetRowStartPosition(rowIndex) + offset.x_);
+    else
+    {
+        // Continue from the state after the line break that ends the last kept row
+        x = GetRowStartPosition(rowIndex);
+        y += startRow * rowHeight;
+        lastFilled = printToText_[printStart - 1] + 1;
+    }
 
-    for (unsigned i = 0; i < printText_.size(); ++i)
+    // Store position & size of each character, and locations per texture page
+    unsigned numChars = unicodeText_.size();
+    charLocations_.resize(numChars + 1);
+    pageGlyphLocations_.resize(face->GetTextures().size());
+    for (unsigned i = 0; i < pageGlyphLocations_.size(); ++i)
+    {
+        // Glyph locations are stored row by row, so remove the ones of the updated rows from the end
+        ea::vector<GlyphLocation>& pageGlyphLocation = pageGlyphLocations_[i];
+        if (!startRow)
+            pageGlyphLocation.clear();
+        while (!pageGlyphLocation.empty() && pageGlyphLocation.back().y_ >= y)
+            pageGlyphLocation.pop_back();
+    }
+
+    for (unsigned i = printStart; i < printText_.size(); ++i)
     {
         CharLocation loc;
         loc.position_ = Vector2(x, y);
@@ -740,6 +893,8 @@ void Text::UpdateCharLocations()
     charLocations_[numChars].size_ = Vector2::ZERO;
 
     charLocationsDirty_ = false;
+    charLocationsDirtyRow_ = M_MAX_UNSIGNED;
+    MarkBatchesDirty();
 }
 
 void Text::ValidateSelection()
@@ -812,4 +967,35 @@ void Text::ConstructBatch(UIBatch& pageBatch, const ea::vector<GlyphLocation>& p
     }
 }
 
+void Text::ConstructEffectBatch(UIBatch& pageBatch, const ea::vector<GlyphLocation>& pageGlyphLocation,
+    const ea::vector<Vector2>& offsets)
+{
+    if (offsets.empty())
+        return;
+
+    ea::vector<float>& vertexData = *pageBatch.vertexData_;
+    unsigned startDataSize = vertexData.size();
+    ConstructBatch(pageBatch, pageGlyphLocation, offsets[0].x_, offsets[0].y_, &effectColor_, effectDepthBias_);
+    unsigned quadsDataSize = vertexData.size() - startDataSize;
+    if (!quadsDataSize)
+        return;
+
+    // Copy the quads of the first offset instead of constructing them again
+    vertexData.resize(startDataSize + offsets.size() * quadsDataSize);
+    for (unsigned i = 1; i < offsets.size(); ++i)
+    {
+        Vector2 delta = offsets[i] - offsets[0];
+        float* src = &vertexData[startDataSize];
+        float* dest = &vertexData[startDataSize + i * quadsDataSize];
+        for (unsigned j = 0; j < quadsDataSize; j += UI_VERTEX_SIZE)
+        {
+            for (unsigned k = 0; k < UI_VERTEX_SIZE; ++k)
+                dest[j + k] = src[j + k];
+            dest[j] += delta.x_;
+            dest[j + 1] += delta.y_;
+        }
+    }
+    pageBatch.vertexEnd_ = vertexData.size();
+}
+
 }
@@ -215,6 +215,10 @@ public:
     /// Return size of character by index.
     /// @property{get_charSizes}
     Vector2 GetCharSize(unsigned index);
+    /// Return whether the font face has placed or evicted glyphs since the character locations were updated.
+    bool AreGlyphsOutdated() const;
+    /// Reacquire the printed glyphs if the font face uses mutable glyphs, so that they are in the texture and their texture pages count as recently used.
+    void ReacquireGlyphs();
 
     /// Set text effect Z bias. Zero by default, adjusted only in 3D mode.
     void SetEffectDepthBias(float bias);
@@ -234,9 +238,11 @@ public:
 protected:
     /// Filter implicit attributes in serialization process.
     bool FilterImplicitAttributes(XMLElement& dest) const override;
-    /// Update text when text, font or spacing changed.
+    /// Return whether the rendering batches may be cached between frames.
+    bool CanCacheBatches() const override;
+    /// Update text when text, font or spacing changed. Rows before the first modified one are kept when the face, row spacing and wordwrap width did not change.
     void UpdateText(bool onResize = false);
-    /// Update cached character locations after text update, or when text alignment or indent has changed.
+    /// Update cached character locations after text update, or when text alignment or indent has changed. Only the rows from the first modified one are updated when possible.
     void UpdateCharLocations();
     /// Validate text selection to be within the text.
     void ValidateSelection();
@@ -246,11 +252,15 @@ protected:
     void ConstructBatch
         (UIBatch& pageBatch, const ea::vector<GlyphLocation>& pageGlyphLocation, float dx = 0, float dy = 0, Color* color = nullptr,
             float depthBias = 0.0f);
+    /// Construct effect batch. Glyph quads are generated once and repeated at each offset.
+    void ConstructEffectBatch(UIBatch& pageBatch, const ea::vector<GlyphLocation>& pageGlyphLocation, const ea::vector<Vector2>& offsets);
 
     /// Font.
     SharedPtr<Font> font_;
     /// Current face.
     WeakPtr<FontFace> fontFace_;
+    /// Glyph texture placement version of the current face when the character locations were updated.
+    unsigned fontFaceGlyphsVersion_;
     /// Font size.
     float fontSize_;
     /// UTF-8 encoded text.
@@ -263,6 +273,8 @@ protected:
     bool wordWrap_;
     /// Char positions dirty flag.
     bool charLocationsDirty_;
+    /// First row whose char positions must be updated.
+    unsigned charLocationsDirtyRow_;
     /// Selection start.
     unsigned selectionStart_;
     /// Selection length.
@@ -281,6 +293,16 @@ protected:
     float effectDepthBias_;
     /// Row height.
     float rowHeight_;
+    /// Face used for the current rows.
+    WeakPtr<FontFace> layoutFace_;
+    /// Row spacing used for the current rows.
+    float layoutRowSpacing_;
+    /// Wordwrap mode used for the current rows.
+    bool layoutWordwrap_;
+    /// Element width used for the current rows in wordwrap mode.
+    int layoutWidth_;
+    /// First character that was modified since the rows were updated.
+    unsigned layoutDirtyChar_;
     /// Text as Unicode characters.
     ea::vector<unsigned> unicodeText_;
     /// Text modified into printed form.
@@ -299,7 +321,7 @@ protected:
     ea::string stringId_;
     /// Handle change Language.
     void HandleChangeLanguage(StringHash eventType, VariantMap& eventData);
-    /// UTF8 to Unicode.
+    /// UTF8 to Unicode. Track the first modified character for incremental row update.
     void DecodeToUnicode();
 };
 
@@ -33,6 +33,7 @@
 #include "../Resource/ResourceCache.h"
 #include "../Scene/Node.h"
 #include "../UI/Font.h"
+#include "../UI/FontFace.h"
 #include "../UI/Text.h"
 #include "../UI/Text3D.h"
 
@@ -134,10 +135,23 @@ void Text3D::UpdateBatches(const FrameInfo& frame)
             break;
         }
     }
+
+    // Mutable glyphs were placed into or evicted from the font textures
+    if (text_.AreGlyphsOutdated())
+        fontDataLost_ = true;
 }
 
 void Text3D::UpdateGeometry(const FrameInfo& frame)
 {
+    // Reacquire mutable glyphs every frame the text is rendered, like Text does, so that their texture pages are not
+    // evicted as least recently used. Done here, as glyphs may be rendered into the font textures in the main thread only
+    if (HasMutableGlyphs())
+    {
+        text_.ReacquireGlyphs();
+        if (text_.AreGlyphsOutdated())
+            fontDataLost_ = true;
+    }
+
     if (fontDataLost_)
     {
         // Re-evaluation of the text triggers the font face to reload itself
@@ -173,7 +187,8 @@ void Text3D::UpdateGeometry(const FrameInfo& frame)
 
 UpdateGeometryType Text3D::GetUpdateGeometryType()
 {
-    if (geometryDirty_ || fontDataLost_ || vertexBuffer_->IsDataLost() || faceCameraMode_ != FC_NONE || fixedScreenSize_)
+    if (geometryDirty_ || fontDataLost_ || vertexBuffer_->IsDataLost() || faceCameraMode_ != FC_NONE || fixedScreenSize_ ||
+        HasMutableGlyphs())
         return UPDATE_MAIN_THREAD;
     else
         return UPDATE_NONE;
@@ -225,6 +240,10 @@ void Text3D::SetText(const ea::string& text)
 {
     text_.SetText(text);
 
+    // Nothing to do if the text layout did not change, e.g. when the same string is set again
+    if (!text_.charLocationsDirty_)
+        return;
+
     // Changing text requires materials to be re-evaluated, in case the font is multi-page
     MarkTextDirty();
     UpdateTextBatches();
@@ -648,6 +667,11 @@ void Text3D::UpdateTextBatches()
     geometryDirty_ = true;
 }
 
+bool Text3D::HasMutableGlyphs() const
+{
+    return text_.fontFace_ && text_.fontFace_->HasMutableGlyphs();
+}
+
 void Text3D::UpdateTextMaterials(bool forceUpdate)
 {
     Font* font = GetFont();
@@ -236,6 +236,8 @@ protected:
     void UpdateTextMaterials(bool forceUpdate = false);
     /// Recalculate camera facing and fixed screen size.
     void CalculateFixedScreenSize(const FrameInfo& frame);
+    /// Return whether the current font face uses mutable glyphs.
+    bool HasMutableGlyphs() const;
 
     /// Internally used text element.
     Text text_;
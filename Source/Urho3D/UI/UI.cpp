@@ -431,6 +431,7 @@ void UI::RenderUpdate()
     // Get rendering batches from the non-modal UI elements
     batches_.clear();
     vertexData_.clear();
+    batchElements_.clear();
     const IntVector2& rootSize = rootElement_->GetSize();
     const IntVector2& rootPos = rootElement_->GetPosition();
     // Note: the scissors operate on unscaled coordinates. Scissor scaling is only performed during render
@@ -450,6 +451,7 @@ void UI::RenderUpdate()
         currentScissor = IntRect(0, 0, rootSize.x_, rootSize.y_);
         cursor_->GetBatches(batches_, vertexData_, currentScissor);
         GetBatches(batches_, vertexData_, cursor_, currentScissor);
+        vertexDataDirty_ = true;
     }
 
     // UIElement does not have anything to show. Insert dummy batch that will clear the texture.
@@ -459,6 +461,7 @@ void UI::RenderUpdate()
         batch.SetColor(Color::BLACK);
         batch.AddQuad(currentScissor.left_, currentScissor.top_, currentScissor.right_, currentScissor.bottom_, 0, 0);
         batches_.push_back(batch);
+        vertexDataDirty_ = true;
     }
 }
 
@@ -471,7 +474,13 @@ void UI::Render()
     if (cursor_ && osCursorVisible)
         cursor_->ApplyOSCursorShape();
 
-    SetVertexData(vertexBuffer_, vertexData_);
+    // Skip the upload if the vertex data was assembled from the cached batches of the same elements as last time
+    if (vertexDataDirty_ || batchElements_ != uploadedBatchElements_ || vertexBuffer_->IsDataLost())
+    {
+        SetVertexData(vertexBuffer_, vertexData_);
+        uploadedBatchElements_ = batchElements_;
+        vertexDataDirty_ = false;
+    }
     SetVertexData(debugVertexBuffer_, debugVertexData_);
 
     // Render non-modal batches
@@ -1090,7 +1099,7 @@ void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData,
             while (j != children.end() && (*j)->GetPriority() == currentPriority)
             {
                 if ((*j)->IsWithinScissor(currentScissor) && (*j) != cursor_)
-                    (*j)->GetBatches(batches, vertexData, currentScissor);
+                    GetElementBatches(batches, vertexData, *j, currentScissor);
                 ++j;
             }
             // Now recurse into the children
@@ -1110,7 +1119,7 @@ void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData,
             if ((*i) != cursor_)
             {
                 if ((*i)->IsWithinScissor(currentScissor))
-                    (*i)->GetBatches(batches, vertexData, currentScissor);
+                    GetElementBatches(batches, vertexData, *i, currentScissor);
                 if ((*i)->IsVisible())
                     GetBatches(batches, vertexData, *i, currentScissor);
             }
@@ -1119,6 +1128,13 @@ void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData,
     }
 }
 
+void UI::GetElementBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, const IntRect& currentScissor)
+{
+    if (!element->GetBatchesCached(batches, vertexData, currentScissor))
+        vertexDataDirty_ = true;
+    batchElements_.push_back(element);
+}
+
 void UI::GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly)
 {
     if (!current)
@@ -121,7 +121,7 @@ public:
     /// Set whether to show the on-screen keyboard (if supported) when a %LineEdit is focused. Default true on mobile devices.
     /// @property
     void SetUseScreenKeyboard(bool enable);
-    /// Set whether to use mutable (eraseable) glyphs to ensure a font face never expands to more than one texture. Default false.
+    /// Set whether to use mutable (eraseable) glyphs: FreeType glyphs are rasterized on demand in the background and the least recently used font texture is erased when a face runs out of room. Default false.
     /// @property
     void SetUseMutableGlyphs(bool enable);
     /// Set whether to force font autohinting instead of using FreeType's TTF bytecode interpreter.
@@ -304,6 +304,8 @@ private:
     void Render(VertexBuffer* buffer, const ea::vector<UIBatch>& batches, unsigned batchStart, unsigned batchEnd);
     /// Generate batches from an UI element recursively. Skip the cursor element.
     void GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, IntRect currentScissor);
+    /// Generate batches from an UI element, reusing its cached batches if possible, and track changes of the vertex data.
+    void GetElementBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, const IntRect& currentScissor);
     /// Return UI element at screen position recursively.
     void GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly);
     /// Return the first element in hierarchy that can alter focus.
@@ -396,6 +398,12 @@ private:
     ea::vector<UIBatch> batches_;
     /// UI rendering vertex data.
     ea::vector<float> vertexData_;
+    /// UI elements that generated the rendering batches, in order.
+    ea::vector<UIElement*> batchElements_;
+    /// UI elements that generated the vertex data last uploaded to the vertex buffer, in order.
+    ea::vector<UIElement*> uploadedBatchElements_;
+    /// UI rendering vertex data generated anew since the last upload flag.
+    bool vertexDataDirty_{true};
     /// UI rendering batches for debug draw.
     ea::vector<UIBatch> debugDrawBatches_;
     /// UI rendering vertex data for debug draw.
@@ -371,6 +371,58 @@ void UIElement::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vert
     hovering_ = false;
 }
 
+bool UIElement::GetBatchesCached(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor)
+{
+    if (!CanCacheBatches())
+    {
+        batchesDirty_ = true;
+        GetBatches(batches, vertexData, currentScissor);
+        return false;
+    }
+
+    const IntVector2& screenPosition = GetScreenPosition();
+    const float opacity = GetDerivedOpacity();
+    const unsigned stateFlags = (hovering_ ? 1u : 0u) | (selected_ ? 2u : 0u) | (enabled_ ? 4u : 0u) | (HasFocus() ? 8u : 0u);
+
+    const bool reused = !batchesDirty_ && cachedScissor_ == currentScissor && cachedScreenPosition_ == screenPosition &&
+        cachedSize_ == size_ && cachedOpacity_ == opacity && cachedStateFlags_ == stateFlags;
+    if (!reused)
+    {
+        cachedBatches_.clear();
+        cachedVertexData_.clear();
+        GetBatches(cachedBatches_, cachedVertexData_, currentScissor);
+
+        // GetBatches() may have changed position or size of the element, e.g. when Text updates its content
+        cachedScissor_ = currentScissor;
+        cachedScreenPosition_ = GetScreenPosition();
+        cachedSize_ = size_;
+        cachedOpacity_ = GetDerivedOpacity();
+        cachedStateFlags_ = stateFlags;
+        batchesDirty_ = false;
+    }
+    else
+    {
+        // Reset hovering for next frame, as GetBatches() would do
+        hovering_ = false;
+    }
+
+    if (cachedVertexData_.empty())
+        return reused;
+
+    const unsigned vertexOffset = vertexData.size();
+    vertexData.insert(vertexData.end(), cachedVertexData_.begin(), cachedVertexData_.end());
+    for (const UIBatch& cachedBatch : cachedBatches_)
+    {
+        UIBatch batch = cachedBatch;
+        batch.vertexData_ = &vertexData;
+        batch.vertexStart_ += vertexOffset;
+        batch.vertexEnd_ += vertexOffset;
+        UIBatch::AddOrMerge(batch, batches);
+    }
+
+    return reused;
+}
+
 void UIElement::GetDebugDrawBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor)
 {
     UIBatch batch(this, BLEND_ALPHA, currentScissor, nullptr, &vertexData);
@@ -850,6 +902,7 @@ void UIElement::SetColor(const Color& color)
         cornerColor = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
+    batchesDirty_ = true;
 }
 
 void UIElement::SetColor(Corner corner, const Color& color)
@@ -857,6 +910,7 @@ void UIElement::SetColor(Corner corner, const Color& color)
     colors_[corner] = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
+    batchesDirty_ = true;
 
     for (unsigned i = 0; i < MAX_UIELEMENT_CORNERS; ++i)
     {
@@ -1968,11 +2022,18 @@ void UIElement::MarkDirty()
     positionDirty_ = true;
     opacityDirty_ = true;
     derivedColorDirty_ = true;
+    batchesDirty_ = true;
 
     for (auto i = children_.begin(); i != children_.end(); ++i)
         (*i)->MarkDirty();
 }
 
+void UIElement::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
+{
+    Animatable::OnSetAttribute(attr, src);
+    batchesDirty_ = true;
+}
+
 bool UIElement::RemoveChildXML(XMLElement& parent, const ea::string& name) const
 {
     static XPathQuery matchXPathQuery("./attribute[@name=$attributeName]", "attributeName:String");
@@ -141,6 +141,8 @@ public:
     virtual UIElement* LoadChildXML(const XMLElement& childElem, XMLFile* styleFile);
     /// Save as XML data. Return true if successful.
     bool SaveXML(XMLElement& dest) const override;
+    /// Handle attribute write access.
+    void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override;
 
     /// Perform UI element update.
     virtual void Update(float timeStep);
@@ -151,6 +153,10 @@ public:
     virtual const IntVector2& GetScreenPosition() const;
     /// Return UI rendering batches.
     virtual void GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor);
+    /// Return UI rendering batches, reusing the batches of a previous frame when the render state has not changed. Return true if the cached batches were reused. Used internally by UI.
+    bool GetBatchesCached(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor);
+    /// Mark the cached UI rendering batches as needing a rebuild.
+    void MarkBatchesDirty() { batchesDirty_ = true; }
     /// Return UI rendering batches for debug draw.
     virtual void GetDebugDrawBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor);
     /// React to mouse hover.
@@ -770,6 +776,8 @@ protected:
     Animatable* FindAttributeAnimationTarget(const ea::string& name, ea::string& outName) override;
     /// Mark screen position as needing an update.
     void MarkDirty();
+    /// Return whether the rendering batches depend only on tracked render state and may be cached between frames.
+    virtual bool CanCacheBatches() const { return false; }
     /// Remove child XML element by matching attribute name.
     bool RemoveChildXML(XMLElement& parent, const ea::string& name) const;
     /// Remove child XML element by matching attribute name and value.
@@ -928,6 +936,22 @@ private:
     static XPathQuery styleXPathQuery_;
     /// Tag list.
     StringVector tags_;
+    /// Cached rendering batches.
+    ea::vector<UIBatch> cachedBatches_;
+    /// Vertex data of the cached rendering batches.
+    ea::vector<float> cachedVertexData_;
+    /// Scissor rectangle the batches were cached with.
+    IntRect cachedScissor_;
+    /// Screen position the batches were cached with.
+    IntVector2 cachedScreenPosition_;
+    /// Size the batches were cached with.
+    IntVector2 cachedSize_;
+    /// Derived opacity the batches were cached with.
+    float cachedOpacity_{};
+    /// Hover, selection, enabled and focus state the batches were cached with.
+    unsigned cachedStateFlags_{};
+    /// Cached rendering batches dirty flag.
+    bool batchesDirty_{true};
 };
 
 template <class T> T* UIElement::CreateChild(const ea::string& name, unsigned index)
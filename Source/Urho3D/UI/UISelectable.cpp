@@ -59,11 +59,13 @@ void UISelectable::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& v
 void UISelectable::SetSelectionColor(const Color& color)
 {
     selectionColor_ = color;
+    MarkBatchesDirty();
 }
 
 void UISelectable::SetHoverColor(const Color& color)
 {
     hoverColor_ = color;
+    MarkBatchesDirty();
 }
 
 }
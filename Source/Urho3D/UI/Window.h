@@ -148,6 +148,8 @@ public:
     bool GetModalAutoDismiss() const { return modalAutoDismiss_; }
 
 protected:
+    /// Return whether the rendering batches may be cached between frames. Modal shade depends on the root element.
+    bool CanCacheBatches() const override { return !modal_ && BorderImage::CanCacheBatches(); }
     /// Identify drag mode (move/resize).
     WindowDragMode GetDragMode(const IntVector2& position) const;
     /// Set cursor shape based on drag mode.
@@ -30,6 +30,8 @@
 #include "../Urho2D/Drawable2D.h"
 #include "../Urho2D/Renderer2D.h"
 
+#include <atomic>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -37,6 +39,9 @@ namespace Urho3D
 
 const float PIXEL_SIZE = 0.01f;
 
+/// Source batches version counter shared by all drawables, so that versions are never reused by another drawable.
+static std::atomic<unsigned> sourceBatchesVersionCounter{};
+
 SourceBatch2D::SourceBatch2D() :
     distance_(0.0f),
     drawOrder_(0)
@@ -47,7 +52,8 @@ Drawable2D::Drawable2D(Context* context) :
     Drawable(context, DRAWABLE_GEOMETRY2D),
     layer_(0),
     orderInLayer_(0),
-    sourceBatchesDirty_(true)
+    sourceBatchesDirty_(true),
+    sourceBatchesVersion_(0)
 {
 }
 
@@ -99,7 +105,10 @@ void Drawable2D::SetOrderInLayer(int orderInLayer)
 const ea::vector<SourceBatch2D>& Drawable2D::GetSourceBatches()
 {
     if (sourceBatchesDirty_)
+    {
         UpdateSourceBatches();
+        sourceBatchesVersion_ = ++sourceBatchesVersionCounter;
+    }
 
     return sourceBatches_;
 }
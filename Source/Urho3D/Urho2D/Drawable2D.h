@@ -127,6 +127,8 @@ public:
 
     /// Return all source batches (called by Renderer2D).
     const ea::vector<SourceBatch2D>& GetSourceBatches();
+    /// Return source batches version, which changes whenever the source batches are updated.
+    unsigned GetSourceBatchesVersion() const { return sourceBatchesVersion_; }
 
 protected:
     /// Handle scene being assigned.
@@ -149,6 +151,8 @@ protected:
     ea::vector<SourceBatch2D> sourceBatches_;
     /// Source batches dirty flag.
     bool sourceBatchesDirty_;
+    /// Source batches version.
+    unsigned sourceBatchesVersion_;
     /// Renderer2D.
     WeakPtr<Renderer2D> renderer_;
 };
@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
@@ -89,6 +91,8 @@ void PhysicsWorld2D::RegisterObject(Context* context)
         AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Position Iterations", GetPositionIterations, SetPositionIterations, int, DEFAULT_POSITION_ITERATIONS,
         AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Parallel Islands", GetParallelIslands, SetParallelIslands, bool, false, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Contact Events", IsContactEventsEnabled, SetContactEventsEnabled, bool, true, AM_FILE);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -133,6 +137,9 @@ void PhysicsWorld2D::EndContact(b2Contact* contact)
 
 void PhysicsWorld2D::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
 {
+    if (!contactEventsEnabled_)
+        return;
+
     b2Fixture* fixtureA = contact->GetFixtureA();
     b2Fixture* fixtureB = contact->GetFixtureB();
     if (!fixtureA || !fixtureB)
@@ -276,6 +283,22 @@ void PhysicsWorld2D::DrawTransform(const b2Transform& xf)
     debugRenderer_->AddLine(Vector3(p1.x, p1.y, 0.0f), Vector3(p2.x, p2.y, 0.0f), Color::GREEN, debugDepthTest_);
 }
 
+void PhysicsWorld2D::ExecuteTasks(TaskFunction task, void* context, int32 count)
+{
+    // Run serially outside the main thread or when the work queue is busy
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !queue->GetNumThreads() || queue->IsCompleting() || !Thread::IsMainThread())
+    {
+        for (int32 i = 0; i < count; ++i)
+            task(context, i);
+        return;
+    }
+
+    for (int32 i = 0; i < count; ++i)
+        queue->AddWorkItem([task, context, i]() { task(context, i); }, M_MAX_UNSIGNED);
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 void PhysicsWorld2D::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdatePhysics2D");
@@ -287,6 +310,10 @@ void PhysicsWorld2D::Update(float timeStep)
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPRESTEP, eventData);
 
+    // Contacts of the previous step stay readable until now
+    beginContactInfos_.clear();
+    endContactInfos_.clear();
+
     physicsStepping_ = true;
     world_->Step(timeStep, velocityIterations_, positionIterations_);
     physicsStepping_ = false;
@@ -325,8 +352,11 @@ void PhysicsWorld2D::Update(float timeStep)
         }
     }
 
-    SendBeginContactEvents();
-    SendEndContactEvents();
+    if (contactEventsEnabled_)
+    {
+        SendBeginContactEvents();
+        SendEndContactEvents();
+    }
 
     using namespace PhysicsPostStep;
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
@@ -427,6 +457,20 @@ void PhysicsWorld2D::SetPositionIterations(int positionIterations)
     positionIterations_ = positionIterations;
 }
 
+void PhysicsWorld2D::SetParallelIslands(bool enable)
+{
+    if (enable == parallelIslands_)
+        return;
+
+    parallelIslands_ = enable;
+    world_->SetTaskExecutor(parallelIslands_ ? this : nullptr);
+}
+
+void PhysicsWorld2D::SetContactEventsEnabled(bool enable)
+{
+    contactEventsEnabled_ = enable;
+}
+
 void PhysicsWorld2D::AddRigidBody(RigidBody2D* rigidBody)
 {
     if (!rigidBody)
@@ -767,8 +811,6 @@ void PhysicsWorld2D::SendBeginContactEvents()
             contactInfo.nodeB_->SendEvent(E_NODEBEGINCONTACT2D, nodeEventData);
         }
     }
-
-    beginContactInfos_.clear();
 }
 
 void PhysicsWorld2D::SendEndContactEvents()
@@ -818,8 +860,6 @@ void PhysicsWorld2D::SendEndContactEvents()
             contactInfo.nodeB_->SendEvent(E_NODEENDCONTACT2D, nodeEventData);
         }
     }
-
-    endContactInfos_.clear();
 }
 
 PhysicsWorld2D::ContactInfo::ContactInfo() = default;
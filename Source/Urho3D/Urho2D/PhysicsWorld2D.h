@@ -67,11 +67,43 @@ struct DelayedWorldTransform2D
 };
 
 /// 2D physics simulation world component. Should be added only to the root scene node.
-class URHO3D_API PhysicsWorld2D : public Component, public b2ContactListener, public b2Draw
+class URHO3D_API PhysicsWorld2D : public Component, public b2ContactListener, public b2Draw, public b2TaskExecutor
 {
     URHO3D_OBJECT(PhysicsWorld2D, Component);
 
 public:
+    /// Contact info.
+    struct ContactInfo
+    {
+        /// Construct.
+        ContactInfo();
+        /// Construct.
+        explicit ContactInfo(b2Contact* contact);
+        /// Write contact info to buffer.
+        const ea::vector<unsigned char>& Serialize(VectorBuffer& buffer) const;
+
+        /// Rigid body A.
+        SharedPtr<RigidBody2D> bodyA_;
+        /// Rigid body B.
+        SharedPtr<RigidBody2D> bodyB_;
+        /// Node A.
+        SharedPtr<Node> nodeA_;
+        /// Node B.
+        SharedPtr<Node> nodeB_;
+        /// Shape A.
+        SharedPtr<CollisionShape2D> shapeA_;
+        /// Shape B.
+        SharedPtr<CollisionShape2D> shapeB_;
+        /// Number of contact points.
+        int numPoints_{};
+        /// Contact normal in world space.
+        Vector2 worldNormal_;
+        /// Contact positions in world space.
+        Vector2 worldPositions_[b2_maxManifoldPoints];
+        /// Contact overlap values.
+        float separations_[b2_maxManifoldPoints]{};
+    };
+
     /// Construct.
     explicit PhysicsWorld2D(Context* context);
     /// Destruct.
@@ -106,6 +138,10 @@ public:
     /// Draw a point.
     void DrawPoint(const b2Vec2& p, float32 size, const b2Color& color) override;
 
+    // Implement b2TaskExecutor
+    /// Run island solver tasks on the work queue.
+    void ExecuteTasks(TaskFunction task, void* context, int32 count) override;
+
     /// Step the simulation forward.
     void Update(float timeStep);
     /// Add debug geometry to the debug renderer.
@@ -152,6 +188,13 @@ public:
     /// Set position iterations.
     /// @property
     void SetPositionIterations(int positionIterations);
+    /// Set whether independent groups of islands are solved in parallel on the work queue. Disabled by default.
+    /// @property
+    void SetParallelIslands(bool enable);
+    /// Set whether per-contact begin, end and update events are sent. Enabled by default.
+    /// When disabled, read the contacts of the last step from GetBeginContacts() and GetEndContacts(), for example on E_PHYSICSPOSTSTEP.
+    /// @property
+    void SetContactEventsEnabled(bool enable);
     /// Add rigid body.
     void AddRigidBody(RigidBody2D* rigidBody);
     /// Remove rigid body.
@@ -223,6 +266,16 @@ public:
     /// Return position iterations.
     /// @property
     int GetPositionIterations() const { return positionIterations_; }
+    /// Return whether independent groups of islands are solved in parallel.
+    /// @property
+    bool GetParallelIslands() const { return parallelIslands_; }
+    /// Return whether per-contact events are sent.
+    /// @property
+    bool IsContactEventsEnabled() const { return contactEventsEnabled_; }
+    /// Return contacts that began during the last step. Valid until the next step.
+    const ea::vector<ContactInfo>& GetBeginContacts() const { return beginContactInfos_; }
+    /// Return contacts that ended during the last step. Valid until the next step.
+    const ea::vector<ContactInfo>& GetEndContacts() const { return endContactInfos_; }
 
     /// Return the Box2D physics world.
     b2World* GetWorld() { return world_.get(); }
@@ -262,6 +315,10 @@ protected:
 
     /// Automatic simulation update enabled flag.
     bool updateEnabled_{true};
+    /// Parallel island solving flag.
+    bool parallelIslands_{};
+    /// Per-contact events enabled flag.
+    bool contactEventsEnabled_{true};
     /// Whether is currently stepping the world. Used internally.
     bool physicsStepping_{};
     /// Applying transforms.
@@ -271,40 +328,9 @@ protected:
     /// Delayed (parented) world transform assignments.
     ea::unordered_map<RigidBody2D*, DelayedWorldTransform2D> delayedWorldTransforms_;
 
-    /// Contact info.
-    struct ContactInfo
-    {
-        /// Construct.
-        ContactInfo();
-        /// Construct.
-        explicit ContactInfo(b2Contact* contact);
-        /// Write contact info to buffer.
-        const ea::vector<unsigned char>& Serialize(VectorBuffer& buffer) const;
-
-        /// Rigid body A.
-        SharedPtr<RigidBody2D> bodyA_;
-        /// Rigid body B.
-        SharedPtr<RigidBody2D> bodyB_;
-        /// Node A.
-        SharedPtr<Node> nodeA_;
-        /// Node B.
-        SharedPtr<Node> nodeB_;
-        /// Shape A.
-        SharedPtr<CollisionShape2D> shapeA_;
-        /// Shape B.
-        SharedPtr<CollisionShape2D> shapeB_;
-        /// Number of contact points.
-        int numPoints_{};
-        /// Contact normal in world space.
-        Vector2 worldNormal_;
-        /// Contact positions in world space.
-        Vector2 worldPositions_[b2_maxManifoldPoints];
-        /// Contact overlap values.
-        float separations_[b2_maxManifoldPoints]{};
-    };
-    /// Begin contact infos.
+    /// Begin contact infos of the last step.
     ea::vector<ContactInfo> beginContactInfos_;
-    /// End contact infos.
+    /// End contact infos of the last step.
     ea::vector<ContactInfo> endContactInfos_;
     /// Temporary buffer with contact data.
     VectorBuffer contacts_;
@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Geometry.h"
@@ -49,11 +50,14 @@ namespace Urho3D
 {
 
 static const unsigned MASK_VERTEX2D = MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1;
+/// Minimum number of vertices to split the vertex buffer fill between worker threads.
+static const unsigned MIN_THREADED_COPY_VERTICES = 16384;
 
 ViewBatchInfo2D::ViewBatchInfo2D() :
     vertexBufferUpdateFrameNumber_(0),
     indexCount_(0),
     vertexCount_(0),
+    vertexBufferDirty_(true),
     batchUpdatedFrameNumber_(0),
     batchCount_(0)
 {
@@ -193,24 +197,24 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
     {
         unsigned vertexCount = viewBatchInfo.vertexCount_;
         VertexBuffer* vertexBuffer = viewBatchInfo.vertexBuffer_;
-        if (vertexBuffer->GetVertexCount() < vertexCount)
-            vertexBuffer->SetSize(vertexCount, MASK_VERTEX2D, true);
+        if (vertexBuffer->GetVertexCount() < vertexCount || vertexBuffer->IsDataLost())
+        {
+            if (vertexBuffer->GetVertexCount() < vertexCount)
+                vertexBuffer->SetSize(vertexCount, MASK_VERTEX2D, true);
+            viewBatchInfo.vertexBufferDirty_ = true;
+        }
 
-        if (vertexCount)
+        // The vertex buffer keeps its contents, so fill it only when the sorted source batches or their vertices changed
+        if (vertexCount && viewBatchInfo.vertexBufferDirty_)
         {
             auto* dest = reinterpret_cast<Vertex2D*>(vertexBuffer->Lock(0, vertexCount, true));
             if (dest)
             {
-                const ea::vector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
-                for (unsigned b = 0; b < sourceBatches.size(); ++b)
-                {
-                    const ea::vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
-                    for (unsigned i = 0; i < vertices.size(); ++i)
-                        dest[i] = vertices[i];
-                    dest += vertices.size();
-                }
+                CopySourceBatchVertices(viewBatchInfo.sourceBatches_, dest, vertexCount);
 
                 vertexBuffer->Unlock();
+                vertexBuffer->ClearDataLost();
+                viewBatchInfo.vertexBufferDirty_ = false;
             }
             else
                 URHO3D_LOGERROR("Failed to lock vertex buffer");
@@ -220,6 +224,49 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
     }
 }
 
+void Renderer2D::CopySourceBatchVertices(const ea::vector<const SourceBatch2D*>& sourceBatches, Vertex2D* dest,
+    unsigned vertexCount)
+{
+    const auto copyBatches = [&sourceBatches](unsigned begin, unsigned end, Vertex2D* dest)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const ea::vector<Vertex2D>& vertices = sourceBatches[i]->vertices_;
+            memcpy(dest, vertices.data(), vertices.size() * sizeof(Vertex2D));
+            dest += vertices.size();
+        }
+    };
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    const bool threaded = queue && queue->GetNumThreads() && !queue->IsCompleting() && Thread::IsMainThread()
+        && vertexCount >= MIN_THREADED_COPY_VERTICES;
+    if (!threaded)
+    {
+        copyBatches(0, sourceBatches.size(), dest);
+        return;
+    }
+
+    // Split between worker threads + main thread by vertex count, without splitting source batches
+    const unsigned numItems = queue->GetNumThreads() + 1;
+    const unsigned verticesPerItem = (vertexCount + numItems - 1) / numItems;
+    unsigned begin = 0;
+    unsigned numVertices = 0;
+    for (unsigned i = 0; i < sourceBatches.size(); ++i)
+    {
+        numVertices += sourceBatches[i]->vertices_.size();
+        if (numVertices >= verticesPerItem || i + 1 == sourceBatches.size())
+        {
+            const unsigned end = i + 1;
+            queue->AddWorkItem([&copyBatches, begin, end, dest]() { copyBatches(begin, end, dest); }, M_MAX_UNSIGNED);
+
+            begin = end;
+            dest += numVertices;
+            numVertices = 0;
+        }
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 UpdateGeometryType Renderer2D::GetUpdateGeometryType()
 {
     return UPDATE_MAIN_THREAD;
@@ -405,18 +452,18 @@ void Renderer2D::GetDrawables(ea::vector<Drawable2D*>& drawables, Node* node)
         GetDrawables(drawables, i->Get());
 }
 
-static inline bool CompareSourceBatch2Ds(const SourceBatch2D* lhs, const SourceBatch2D* rhs)
+static inline bool CompareSourceBatch2DSortKeys(const SourceBatch2DSortKey& lhs, const SourceBatch2DSortKey& rhs)
 {
-    if (lhs->drawOrder_ != rhs->drawOrder_)
-        return lhs->drawOrder_ < rhs->drawOrder_;
+    if (lhs.drawOrder_ != rhs.drawOrder_)
+        return lhs.drawOrder_ < rhs.drawOrder_;
 
-    if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
+    if (lhs.distance_ != rhs.distance_)
+        return lhs.distance_ > rhs.distance_;
 
-    if (lhs->material_ != rhs->material_)
-        return lhs->material_->GetNameHash() < rhs->material_->GetNameHash();
+    if (lhs.materialHash_ != rhs.materialHash_)
+        return lhs.materialHash_ < rhs.materialHash_;
 
-    return lhs < rhs;
+    return lhs.index_ < rhs.index_;
 }
 
 void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* camera)
@@ -425,32 +472,121 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
     if (viewBatchInfo.batchUpdatedFrameNumber_ == frame_.frameNumber_)
         return;
 
-    ea::vector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
-    sourceBatches.clear();
+    // Collect source batches and drawable versions in place, comparing against the previous update
+    ea::vector<const SourceBatch2D*>& collectedBatches = viewBatchInfo.collectedSourceBatches_;
+    ea::vector<ea::pair<const Drawable2D*, unsigned> >& drawableVersions = viewBatchInfo.drawableVersions_;
+    bool collectedChanged = false;
+    bool verticesChanged = false;
+    unsigned numCollected = 0;
+    unsigned numDrawables = 0;
+
     for (unsigned d = 0; d < drawables_.size(); ++d)
     {
         if (!drawables_[d]->IsInView(camera))
             continue;
 
         const ea::vector<SourceBatch2D>& batches = drawables_[d]->GetSourceBatches();
+
+        const ea::pair<const Drawable2D*, unsigned> version(drawables_[d], drawables_[d]->GetSourceBatchesVersion());
+        if (numDrawables == drawableVersions.size())
+        {
+            drawableVersions.push_back(version);
+            verticesChanged = true;
+        }
+        else if (drawableVersions[numDrawables] != version)
+        {
+            drawableVersions[numDrawables] = version;
+            verticesChanged = true;
+        }
+        ++numDrawables;
+
         for (unsigned b = 0; b < batches.size(); ++b)
         {
-            if (batches[b].material_ && !batches[b].vertices_.empty())
-                sourceBatches.push_back(&batches[b]);
+            if (!batches[b].material_ || batches[b].vertices_.empty())
+                continue;
+
+            if (numCollected == collectedBatches.size())
+            {
+                collectedBatches.push_back(&batches[b]);
+                collectedChanged = true;
+            }
+            else if (collectedBatches[numCollected] != &batches[b])
+            {
+                collectedBatches[numCollected] = &batches[b];
+                collectedChanged = true;
+            }
+            ++numCollected;
         }
     }
 
-    for (unsigned i = 0; i < sourceBatches.size(); ++i)
+    if (numDrawables != drawableVersions.size())
+    {
+        drawableVersions.resize(numDrawables);
+        verticesChanged = true;
+    }
+    if (numCollected != collectedBatches.size())
+    {
+        collectedBatches.resize(numCollected);
+        collectedChanged = true;
+    }
+
+    for (unsigned i = 0; i < collectedBatches.size(); ++i)
+    {
+        const SourceBatch2D* sourceBatch = collectedBatches[i];
+        Vector3 worldPos = sourceBatch->owner_->GetNode()->GetWorldPosition();
+        sourceBatch->distance_ = camera->GetDistance(worldPos);
+    }
+
+    // Start from the previous order if the same source batches were collected, so that unchanged scenes need no sort
+    if (collectedChanged || viewBatchInfo.sortOrder_.size() != collectedBatches.size())
+    {
+        viewBatchInfo.sortOrder_.resize(collectedBatches.size());
+        for (unsigned i = 0; i < collectedBatches.size(); ++i)
+            viewBatchInfo.sortOrder_[i] = i;
+    }
+
+    // Batches of one drawable have the same draw order and distance. Sort them by the material of the first one, so that
+    // they stay together in their own order, which may matter when they overlap
+    materialHashes_.resize(collectedBatches.size());
+    for (unsigned i = 0; i < collectedBatches.size(); ++i)
+    {
+        if (i > 0 && collectedBatches[i]->owner_ == collectedBatches[i - 1]->owner_)
+            materialHashes_[i] = materialHashes_[i - 1];
+        else
+            materialHashes_[i] = collectedBatches[i]->material_->GetNameHash().Value();
+    }
+
+    sortKeys_.resize(collectedBatches.size());
+    for (unsigned i = 0; i < collectedBatches.size(); ++i)
+    {
+        const unsigned index = viewBatchInfo.sortOrder_[i];
+        const SourceBatch2D* sourceBatch = collectedBatches[index];
+        SourceBatch2DSortKey& key = sortKeys_[i];
+        key.drawOrder_ = sourceBatch->drawOrder_;
+        key.distance_ = sourceBatch->distance_;
+        key.materialHash_ = materialHashes_[index];
+        key.index_ = index;
+    }
+
+    if (!ea::is_sorted(sortKeys_.begin(), sortKeys_.end(), CompareSourceBatch2DSortKeys))
+        ea::quick_sort(sortKeys_.begin(), sortKeys_.end(), CompareSourceBatch2DSortKeys);
+
+    ea::vector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
+    bool sortedChanged = sourceBatches.size() != sortKeys_.size();
+    sourceBatches.resize(sortKeys_.size());
+    for (unsigned i = 0; i < sortKeys_.size(); ++i)
     {
-        const SourceBatch2D* sourceBatch = sourceBatches[i];
-        // if (sourceBatch->owner_)
+        const SourceBatch2D* sourceBatch = collectedBatches[sortKeys_[i].index_];
+        if (sourceBatches[i] != sourceBatch)
         {
-            Vector3 worldPos = sourceBatch->owner_->GetNode()->GetWorldPosition();
-            sourceBatch->distance_ = camera->GetDistance(worldPos);
+            sourceBatches[i] = sourceBatch;
+            sortedChanged = true;
         }
+        viewBatchInfo.sortOrder_[i] = sortKeys_[i].index_;
     }
 
-    ea::quick_sort(sourceBatches.begin(), sourceBatches.end(), CompareSourceBatch2Ds);
+    if (verticesChanged || sortedChanged)
+        viewBatchInfo.vertexBufferDirty_ = true;
 
     viewBatchInfo.batchCount_ = 0;
     Material* currMaterial = nullptr;
@@ -36,6 +36,21 @@ class Technique;
 class VertexBuffer;
 struct FrameInfo;
 struct SourceBatch2D;
+struct Vertex2D;
+
+/// Sort key of a 2D source batch.
+/// @nobind
+struct SourceBatch2DSortKey
+{
+    /// Draw order.
+    int drawOrder_;
+    /// Distance to camera.
+    float distance_;
+    /// Material name hash of the first source batch of the drawable, so that the batches of a drawable stay in their order.
+    unsigned materialHash_;
+    /// Index of the source batch in collection order.
+    unsigned index_;
+};
 
 /// 2D view batch info.
 /// @nobind
@@ -56,6 +71,14 @@ struct ViewBatchInfo2D
     unsigned batchUpdatedFrameNumber_;
     /// Source batches.
     ea::vector<const SourceBatch2D*> sourceBatches_;
+    /// Source batches in the order they were collected from the drawables. Used to detect changes between updates.
+    ea::vector<const SourceBatch2D*> collectedSourceBatches_;
+    /// Collection indices of the sorted source batches. Used as the initial order for the next sort.
+    ea::vector<unsigned> sortOrder_;
+    /// Visible drawables and their source batch versions. Used to detect vertex changes between updates.
+    ea::vector<ea::pair<const Drawable2D*, unsigned> > drawableVersions_;
+    /// Whether the vertex buffer contents are out of date.
+    bool vertexBufferDirty_;
     /// Batch count.
     unsigned batchCount_;
     /// Distances.
@@ -111,6 +134,8 @@ private:
     void GetDrawables(ea::vector<Drawable2D*>& drawables, Node* node);
     /// Update view batch info.
     void UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* camera);
+    /// Copy vertices of the sorted source batches to a locked vertex buffer. Uses worker threads for large counts.
+    void CopySourceBatchVertices(const ea::vector<const SourceBatch2D*>& sourceBatches, Vertex2D* dest, unsigned vertexCount);
     /// Add view batch.
     void AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material,
         unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance);
@@ -133,6 +158,10 @@ private:
     ea::unordered_map<Texture2D*, ea::unordered_map<int, SharedPtr<Material> > > cachedMaterials_;
     /// Cached techniques per blend mode.
     ea::unordered_map<int, SharedPtr<Technique> > cachedTechniques_;
+    /// Source batch sort keys for the current view.
+    ea::vector<SourceBatch2DSortKey> sortKeys_;
+    /// Sort material hashes of the collected source batches for the current view.
+    ea::vector<unsigned> materialHashes_;
 };
 
 }
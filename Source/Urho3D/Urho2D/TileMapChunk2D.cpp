@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Material.h"
+#include "../Scene/Node.h"
+#include "../Urho2D/Renderer2D.h"
+#include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
+#include "../Urho2D/TileMapLayer2D.h"
+#include "../Urho2D/TmxFile2D.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+TileMapChunk2D::TileMapChunk2D(Context* context) :
+    Drawable2D(context)
+{
+}
+
+TileMapChunk2D::~TileMapChunk2D() = default;
+
+void TileMapChunk2D::RegisterObject(Context* context)
+{
+    context->RegisterFactory<TileMapChunk2D>();
+}
+
+void TileMapChunk2D::Initialize(TileMapLayer2D* layer, const IntRect& tileRect)
+{
+    layer_ = layer;
+    tileRect_ = tileRect;
+
+    MarkTilesDirty();
+}
+
+void TileMapChunk2D::MarkTilesDirty()
+{
+    sourceBatchesDirty_ = true;
+    worldBoundingBoxDirty_ = true;
+}
+
+void TileMapChunk2D::OnSceneSet(Scene* scene)
+{
+    Drawable2D::OnSceneSet(scene);
+
+    // Materials come from the renderer, so rebuild once it is known
+    sourceBatchesDirty_ = true;
+}
+
+void TileMapChunk2D::OnWorldBoundingBoxUpdate()
+{
+    boundingBox_.Clear();
+    worldBoundingBox_.Clear();
+
+    const ea::vector<SourceBatch2D>& sourceBatches = GetSourceBatches();
+    for (const SourceBatch2D& sourceBatch : sourceBatches)
+    {
+        for (const Vertex2D& vertex : sourceBatch.vertices_)
+            worldBoundingBox_.Merge(vertex.position_);
+    }
+
+    if (worldBoundingBox_.Defined())
+        boundingBox_ = worldBoundingBox_.Transformed(node_->GetWorldTransform().Inverse());
+}
+
+void TileMapChunk2D::OnDrawOrderChanged()
+{
+    for (SourceBatch2D& sourceBatch : sourceBatches_)
+        sourceBatch.drawOrder_ = GetDrawOrder();
+}
+
+void TileMapChunk2D::UpdateSourceBatches()
+{
+    if (!sourceBatchesDirty_)
+        return;
+
+    for (SourceBatch2D& sourceBatch : sourceBatches_)
+        sourceBatch.vertices_.clear();
+
+    unsigned numBatches = 0;
+    TileMap2D* tileMap = layer_ ? layer_->GetTileMap() : nullptr;
+    TmxFile2D* tmxFile = tileMap ? tileMap->GetTmxFile() : nullptr;
+    if (tmxFile)
+    {
+        const TileMapInfo2D& info = tileMap->GetInfo();
+        const Matrix3x4& worldTransform = node_->GetWorldTransform();
+        const unsigned color = Color::WHITE.ToUInt();
+
+        for (int y = tileRect_.top_; y < tileRect_.bottom_; ++y)
+        {
+            for (int x = tileRect_.left_; x < tileRect_.right_; ++x)
+            {
+                const unsigned gid = layer_->GetTileGid(x, y);
+                if (!gid)
+                    continue;
+
+                Sprite2D* sprite = tmxFile->GetTileSprite(gid & ~FLIP_ALL);
+                if (!sprite)
+                    continue;
+
+                const bool flipX = (gid & FLIP_HORIZONTAL) != 0;
+                const bool flipY = (gid & FLIP_VERTICAL) != 0;
+                const bool swapXY = (gid & FLIP_DIAGONAL) != 0;
+
+                Rect drawRect;
+                Rect textureRect;
+                if (!sprite->GetDrawRectangle(drawRect, flipX, flipY) || !sprite->GetTextureRectangle(textureRect, flipX, flipY))
+                    continue;
+
+                // Tiles are drawn in row order, so start a new batch whenever the material changes. Tiles of a layer
+                // usually share one tileset, so this is normally a single batch
+                Material* material = renderer_ ? renderer_->GetMaterial(sprite->GetTexture(), BLEND_ALPHA) : nullptr;
+                if (!numBatches || sourceBatches_[numBatches - 1].material_ != material)
+                {
+                    if (numBatches == sourceBatches_.size())
+                    {
+                        SourceBatch2D& sourceBatch = sourceBatches_.push_back();
+                        sourceBatch.owner_ = this;
+                        sourceBatch.drawOrder_ = GetDrawOrder();
+                    }
+                    sourceBatches_[numBatches++].material_ = material;
+                }
+
+                // Same vertex layout as StaticSprite2D, offset by the tile position
+                const Vector2 position = info.TileIndexToPosition(x, y);
+                drawRect.min_ += position;
+                drawRect.max_ += position;
+
+                Vertex2D vertex0;
+                Vertex2D vertex1;
+                Vertex2D vertex2;
+                Vertex2D vertex3;
+
+                vertex0.position_ = worldTransform * Vector3(drawRect.min_.x_, drawRect.min_.y_, 0.0f);
+                vertex1.position_ = worldTransform * Vector3(drawRect.min_.x_, drawRect.max_.y_, 0.0f);
+                vertex2.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.max_.y_, 0.0f);
+                vertex3.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.min_.y_, 0.0f);
+
+                vertex0.uv_ = textureRect.min_;
+                (swapXY ? vertex3.uv_ : vertex1.uv_) = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+                vertex2.uv_ = textureRect.max_;
+                (swapXY ? vertex1.uv_ : vertex3.uv_) = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+
+                vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = color;
+
+                ea::vector<Vertex2D>& vertices = sourceBatches_[numBatches - 1].vertices_;
+                vertices.push_back(vertex0);
+                vertices.push_back(vertex1);
+                vertices.push_back(vertex2);
+                vertices.push_back(vertex3);
+            }
+        }
+    }
+
+    // Drop the batches that are no longer used
+    sourceBatches_.erase(sourceBatches_.begin() + numBatches, sourceBatches_.end());
+
+    sourceBatchesDirty_ = false;
+}
+
+}
@@ -28,6 +28,7 @@
 #include "../Scene/Node.h"
 #include "../Urho2D/StaticSprite2D.h"
 #include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
 #include "../Urho2D/TileMapLayer2D.h"
 #include "../Urho2D/TmxFile2D.h"
 
@@ -36,6 +37,9 @@
 namespace Urho3D
 {
 
+/// Width and height of a tile chunk in tiles.
+static const int TILE_CHUNK_SIZE = 16;
+
 TileMapLayer2D::TileMapLayer2D(Context* context) :
     Component(context)
 {
@@ -181,6 +185,16 @@ void TileMapLayer2D::Initialize(TileMap2D* tileMap, const TmxLayer2D* tmxLayer)
         }
 
         nodes_.clear();
+
+        for (unsigned i = 0; i < chunks_.size(); ++i)
+        {
+            if (chunks_[i])
+                chunks_[i]->Remove();
+        }
+
+        chunks_.clear();
+        tileGids_.clear();
+        numChunksX_ = 0;
     }
 
     tileLayer_ = nullptr;
@@ -230,6 +244,12 @@ void TileMapLayer2D::SetDrawOrder(int drawOrder)
         if (staticSprite)
             staticSprite->SetLayer(drawOrder_);
     }
+
+    for (unsigned i = 0; i < chunks_.size(); ++i)
+    {
+        if (chunks_[i])
+            chunks_[i]->SetLayer(drawOrder_);
+    }
 }
 
 void TileMapLayer2D::SetVisible(bool visible)
@@ -244,6 +264,12 @@ void TileMapLayer2D::SetVisible(bool visible)
         if (nodes_[i])
             nodes_[i]->SetEnabled(visible_);
     }
+
+    for (unsigned i = 0; i < chunks_.size(); ++i)
+    {
+        if (chunks_[i])
+            chunks_[i]->SetEnabled(visible_);
+    }
 }
 
 TileMap2D* TileMapLayer2D::GetTileMap() const
@@ -289,15 +315,33 @@ Tile2D* TileMapLayer2D::GetTile(int x, int y) const
     return tileLayer_->GetTile(x, y);
 }
 
-Node* TileMapLayer2D::GetTileNode(int x, int y) const
+void TileMapLayer2D::SetTileGid(int x, int y, unsigned gid)
 {
     if (!tileLayer_)
-        return nullptr;
+        return;
 
     if (x < 0 || x >= tileLayer_->GetWidth() || y < 0 || y >= tileLayer_->GetHeight())
-        return nullptr;
+        return;
+
+    unsigned& tileGid = tileGids_[y * tileLayer_->GetWidth() + x];
+    if (gid == tileGid)
+        return;
+
+    tileGid = gid;
+
+    // Only the chunk containing the tile needs to rebuild its vertices
+    GetOrCreateChunk(x / TILE_CHUNK_SIZE, y / TILE_CHUNK_SIZE)->MarkTilesDirty();
+}
+
+unsigned TileMapLayer2D::GetTileGid(int x, int y) const
+{
+    if (!tileLayer_)
+        return 0;
+
+    if (x < 0 || x >= tileLayer_->GetWidth() || y < 0 || y >= tileLayer_->GetHeight())
+        return 0;
 
-    return nodes_[y * tileLayer_->GetWidth() + x];
+    return tileGids_[y * tileLayer_->GetWidth() + x];
 }
 
 unsigned TileMapLayer2D::GetNumObjects() const
@@ -341,31 +385,66 @@ void TileMapLayer2D::SetTileLayer(const TmxTileLayer2D* tileLayer)
 
     int width = tileLayer->GetWidth();
     int height = tileLayer->GetHeight();
-    nodes_.resize((unsigned) (width * height));
+    tileGids_.resize((unsigned) (width * height));
 
-    const TileMapInfo2D& info = tileMap_->GetInfo();
     for (int y = 0; y < height; ++y)
     {
         for (int x = 0; x < width; ++x)
         {
             const Tile2D* tile = tileLayer->GetTile(x, y);
             if (!tile)
+            {
+                tileGids_[y * width + x] = 0;
                 continue;
+            }
 
-            SharedPtr<Node> tileNode(GetNode()->CreateTemporaryChild("Tile"));
-            tileNode->SetPosition(Vector3(info.TileIndexToPosition(x, y)));
+            unsigned gid = tile->GetGid();
+            if (tile->GetFlipX())
+                gid |= FLIP_HORIZONTAL;
+            if (tile->GetFlipY())
+                gid |= FLIP_VERTICAL;
+            if (tile->GetSwapXY())
+                gid |= FLIP_DIAGONAL;
+            tileGids_[y * width + x] = gid;
+        }
+    }
 
-            auto* staticSprite = tileNode->CreateComponent<StaticSprite2D>();
-            staticSprite->SetSprite(tile->GetSprite());
-            staticSprite->SetFlip(tile->GetFlipX(), tile->GetFlipY(), tile->GetSwapXY());
-            staticSprite->SetLayer(drawOrder_);
-            staticSprite->SetOrderInLayer(y * width + x);
+    // Tiles are drawn by chunks instead of a node and sprite per tile. Chunks without tiles are created on demand
+    numChunksX_ = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    int numChunksY = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    chunks_.resize((unsigned) (numChunksX_ * numChunksY));
 
-            nodes_[y * width + x] = tileNode;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            if (tileGids_[y * width + x])
+                GetOrCreateChunk(x / TILE_CHUNK_SIZE, y / TILE_CHUNK_SIZE);
         }
     }
 }
 
+TileMapChunk2D* TileMapLayer2D::GetOrCreateChunk(int chunkX, int chunkY)
+{
+    SharedPtr<TileMapChunk2D>& chunk = chunks_[chunkY * numChunksX_ + chunkX];
+    if (!chunk)
+    {
+        const IntVector2 min(chunkX * TILE_CHUNK_SIZE, chunkY * TILE_CHUNK_SIZE);
+        const IntVector2 max(Min(min.x_ + TILE_CHUNK_SIZE, tileLayer_->GetWidth()),
+            Min(min.y_ + TILE_CHUNK_SIZE, tileLayer_->GetHeight()));
+
+        chunk = GetNode()->CreateComponent<TileMapChunk2D>(LOCAL);
+        chunk->SetTemporary(true);
+        chunk->Initialize(this, IntRect(min, max));
+        chunk->SetLayer(drawOrder_);
+        // Keep the tile map row order between chunks
+        chunk->SetOrderInLayer(chunkY * numChunksX_ + chunkX);
+        chunk->SetEnabled(visible_);
+    }
+
+    return chunk;
+}
+
 void TileMapLayer2D::SetObjectGroup(const TmxObjectGroup2D* objectGroup)
 {
     objectGroup_ = objectGroup;
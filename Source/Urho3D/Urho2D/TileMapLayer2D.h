@@ -35,6 +35,7 @@ namespace Urho3D
 class DebugRenderer;
 class Node;
 class TileMap2D;
+class TileMapChunk2D;
 class TmxImageLayer2D;
 class TmxLayer2D;
 class TmxObjectGroup2D;
@@ -93,10 +94,12 @@ public:
     /// Return height (for tile layer only).
     /// @property
     int GetHeight() const;
-    /// Return tile node (for tile layer only).
-    Node* GetTileNode(int x, int y) const;
-    /// Return tile (for tile layer only).
+    /// Return tile as loaded from the tmx file (for tile layer only).
     Tile2D* GetTile(int x, int y) const;
+    /// Set tile gid including flip flags, 0 clears the tile (for tile layer only).
+    void SetTileGid(int x, int y, unsigned gid);
+    /// Return tile gid including flip flags, 0 if there is no tile (for tile layer only).
+    unsigned GetTileGid(int x, int y) const;
 
     /// Return number of tile map objects (for object group only).
     /// @property
@@ -117,6 +120,8 @@ private:
     void SetObjectGroup(const TmxObjectGroup2D* objectGroup);
     /// Set image layer.
     void SetImageLayer(const TmxImageLayer2D* imageLayer);
+    /// Return tile chunk by chunk index, create if it does not exist yet.
+    TileMapChunk2D* GetOrCreateChunk(int chunkX, int chunkY);
 
     /// Tile map.
     WeakPtr<TileMap2D> tileMap_;
@@ -132,8 +137,14 @@ private:
     int drawOrder_{};
     /// Visible.
     bool visible_{true};
-    /// Tile node or image nodes.
+    /// Object nodes or image node.
     ea::vector<SharedPtr<Node> > nodes_;
+    /// Tile gids including flip flags, row by row (for tile layer only).
+    ea::vector<unsigned> tileGids_;
+    /// Tile chunks, row by row. Null for chunks without tiles.
+    ea::vector<SharedPtr<TileMapChunk2D> > chunks_;
+    /// Number of tile chunks horizontally.
+    int numChunksX_{};
 };
 
 }
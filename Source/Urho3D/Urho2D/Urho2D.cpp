@@ -50,6 +50,7 @@
 #include "../Urho2D/Sprite2D.h"
 #include "../Urho2D/SpriteSheet2D.h"
 #include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
 #include "../Urho2D/TileMapLayer2D.h"
 #include "../Urho2D/TmxFile2D.h"
 #include "../Urho2D/Urho2D.h"
@@ -73,6 +74,7 @@ void RegisterUrho2DLibrary(Context* context)
     StaticSprite2D::RegisterObject(context);
 
     StretchableSprite2D::RegisterObject(context);
+    TileMapChunk2D::RegisterObject(context);
 
     AnimationSet2D::RegisterObject(context);
     AnimatedSprite2D::RegisterObject(context);